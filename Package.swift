@@ -36,6 +36,9 @@ let package = Package(
                 .headerSearchPath("./Internal/Events"),
                 .headerSearchPath("./Internal/Entities"),
                 .headerSearchPath("./Internal"),
+            ],
+            linkerSettings: [
+                .linkedLibrary("z"),
             ]),
         .testTarget(
             name: "Snowplow-iOSTests",
@@ -26,6 +26,8 @@
 #import "SPSession.h"
 #import "SPMockEventStore.h"
 #import "SPDataPersistence.h"
+#import "SPGlobalContextsConfiguration.h"
+#import "SPTrackerConstants.h"
 
 
 @interface TestTrackerConfiguration : XCTestCase
@@ -402,4 +404,146 @@
     NSString *trackedEventId = (NSString *)[[payload getAsDictionary] objectForKey:@"eid"];
     XCTAssertTrue([[eventId UUIDString] isEqualToString:trackedEventId]);
 }
+
+- (void)testAsynchronousTrackingKeepsEventOrderAndIds {
+    // Setup tracker
+    SPTrackerConfiguration *trackerConfiguration = [SPTrackerConfiguration new];
+    trackerConfiguration.asynchronousTracking = YES;
+    SPMockEventStore *eventStore = [SPMockEventStore new];
+    SPNetworkConfiguration *networkConfiguration = [[SPNetworkConfiguration alloc] initWithEndpoint:@"fake-url" method:SPHttpMethodPost];
+    SPEmitterConfiguration *emitterConfiguration = [[SPEmitterConfiguration alloc] init];
+    emitterConfiguration.eventStore = eventStore;
+    emitterConfiguration.threadPoolSize = 10;
+    // Record the order in which the events are processed
+    NSMutableArray<NSString *> *processedActions = [NSMutableArray new];
+    SPGlobalContext *orderRecorder = [[SPGlobalContext alloc] initWithGenerator:^NSArray<SPSelfDescribingJson *> *(id<SPInspectableEvent> event) {
+        @synchronized (processedActions) {
+            [processedActions addObject:(NSString *)event.payload[kSPStuctAction]];
+        }
+        return nil;
+    }];
+    SPGlobalContextsConfiguration *gcConfiguration = [[SPGlobalContextsConfiguration alloc] init];
+    [gcConfiguration addWithTag:@"order" contextGenerator:orderRecorder];
+    id<SPTrackerController> trackerController = [SPSnowplow createTrackerWithNamespace:@"namespace" network:networkConfiguration configurations:@[trackerConfiguration, emitterConfiguration, gcConfiguration]];
+
+    // Track events: the ids are returned before the events are processed
+    NSMutableDictionary<NSString *, NSString *> *eventIds = [NSMutableDictionary new];
+    NSMutableArray<NSString *> *trackedActions = [NSMutableArray new];
+    for (int i = 0; i < 20; i++) {
+        NSString *action = [NSString stringWithFormat:@"action-%d", i];
+        NSUUID *eventId = [trackerController track:[[SPStructured alloc] initWithCategory:@"category" action:action]];
+        XCTAssertNotNil(eventId);
+        eventIds[eventId.UUIDString] = action;
+        [trackedActions addObject:action];
+    }
+    for (int i=0; eventStore.count < 20 && i < 10; i++) {
+        [NSThread sleepForTimeInterval:1];
+    }
+    NSArray<SPEmitterEvent *> *events = [eventStore emittableEventsWithQueryLimit:100];
+    [eventStore removeAllEvents];
+    XCTAssertEqual(20, events.count);
+
+    // Check the events are processed in order and carry the returned ids
+    @synchronized (processedActions) {
+        XCTAssertEqualObjects(trackedActions, processedActions);
+    }
+    for (SPEmitterEvent *event in events) {
+        NSDictionary *payload = [event.payload getAsDictionary];
+        XCTAssertEqualObjects(eventIds[(NSString *)payload[kSPEid]], payload[kSPStuctAction]);
+    }
+}
+
+- (void)testAsynchronousTrackingIsNotAffectedByChangesToTrackedEvent {
+    // Setup tracker
+    SPTrackerConfiguration *trackerConfiguration = [SPTrackerConfiguration new];
+    trackerConfiguration.asynchronousTracking = YES;
+    trackerConfiguration.base64Encoding = NO;
+    SPMockEventStore *eventStore = [SPMockEventStore new];
+    SPNetworkConfiguration *networkConfiguration = [[SPNetworkConfiguration alloc] initWithEndpoint:@"fake-url" method:SPHttpMethodPost];
+    SPEmitterConfiguration *emitterConfiguration = [[SPEmitterConfiguration alloc] init];
+    emitterConfiguration.eventStore = eventStore;
+    emitterConfiguration.threadPoolSize = 10;
+    // Hold the tracking queue while the first event is processed
+    dispatch_semaphore_t resume = dispatch_semaphore_create(0);
+    SPGlobalContext *blocker = [[SPGlobalContext alloc] initWithGenerator:^NSArray<SPSelfDescribingJson *> *(id<SPInspectableEvent> event) {
+        if ([event.payload[kSPStuctAction] isEqual:@"blocker"]) {
+            dispatch_semaphore_wait(resume, dispatch_time(DISPATCH_TIME_NOW, 10 * NSEC_PER_SEC));
+        }
+        return nil;
+    }];
+    SPGlobalContextsConfiguration *gcConfiguration = [[SPGlobalContextsConfiguration alloc] init];
+    [gcConfiguration addWithTag:@"blocker" contextGenerator:blocker];
+    id<SPTrackerController> trackerController = [SPSnowplow createTrackerWithNamespace:@"namespace" network:networkConfiguration configurations:@[trackerConfiguration, emitterConfiguration, gcConfiguration]];
+
+    // Modify the event while it waits on the queue
+    [trackerController track:[[SPStructured alloc] initWithCategory:@"category" action:@"blocker"]];
+    SPStructured *event = [[SPStructured alloc] initWithCategory:@"category" action:@"action"];
+    event.label = @"tracked";
+    [trackerController track:event];
+    event.label = @"modified";
+    [event.contexts addObject:[[SPSelfDescribingJson alloc] initWithSchema:@"iglu:com.acme/entity/jsonschema/1-0-0" andDictionary:@{@"key": @"value"}]];
+    dispatch_semaphore_signal(resume);
+
+    for (int i=0; eventStore.count < 2 && i < 10; i++) {
+        [NSThread sleepForTimeInterval:1];
+    }
+    NSArray<SPEmitterEvent *> *events = [eventStore emittableEventsWithQueryLimit:10];
+    [eventStore removeAllEvents];
+    XCTAssertEqual(2, events.count);
+    NSDictionary *payload = [events.lastObject.payload getAsDictionary];
+    XCTAssertEqualObjects(@"action", payload[kSPStuctAction]);
+    XCTAssertEqualObjects(@"tracked", payload[kSPStuctLabel]);
+    XCTAssertFalse([(NSString *)payload[kSPContext] containsString:@"com.acme"]);
+}
+
+- (void)testTrackEventsReturnsTrackedEventIds {
+    // Setup tracker
+    SPTrackerConfiguration *trackerConfiguration = [SPTrackerConfiguration new];
+    SPMockEventStore *eventStore = [SPMockEventStore new];
+    SPNetworkConfiguration *networkConfiguration = [[SPNetworkConfiguration alloc] initWithEndpoint:@"fake-url" method:SPHttpMethodPost];
+    SPEmitterConfiguration *emitterConfiguration = [[SPEmitterConfiguration alloc] init];
+    emitterConfiguration.eventStore = eventStore;
+    emitterConfiguration.threadPoolSize = 10;
+    id<SPTrackerController> trackerController = [SPSnowplow createTrackerWithNamespace:@"namespace" network:networkConfiguration configurations:@[trackerConfiguration, emitterConfiguration]];
+
+    // Track a batch of events
+    NSMutableArray<SPEvent *> *batch = [NSMutableArray new];
+    for (int i = 0; i < 10; i++) {
+        [batch addObject:[[SPStructured alloc] initWithCategory:@"category" action:[NSString stringWithFormat:@"action-%d", i]]];
+    }
+    NSArray<NSUUID *> *eventIds = [trackerController trackEvents:batch];
+    XCTAssertEqual(10, eventIds.count);
+    for (int i=0; eventStore.count < 10 && i < 10; i++) {
+        [NSThread sleepForTimeInterval:1];
+    }
+    NSArray<SPEmitterEvent *> *events = [eventStore emittableEventsWithQueryLimit:100];
+    [eventStore removeAllEvents];
+    XCTAssertEqual(10, events.count);
+
+    // Check each event carries the id returned for it
+    NSMutableDictionary<NSString *, NSString *> *actionsById = [NSMutableDictionary new];
+    for (NSUInteger i = 0; i < eventIds.count; i++) {
+        actionsById[eventIds[i].UUIDString] = [(SPStructured *)batch[i] action];
+    }
+    for (SPEmitterEvent *event in events) {
+        NSDictionary *payload = [event.payload getAsDictionary];
+        XCTAssertEqualObjects(actionsById[(NSString *)payload[kSPEid]], payload[kSPStuctAction]);
+    }
+
+    // No event is tracked when the tracker is paused
+    [trackerController pause];
+    XCTAssertEqual(0, [trackerController trackEvents:batch].count);
+}
+
+- (void)testTrackingQueueDropsNewestEventsByDefault {
+    SPTrackerConfiguration *trackerConfiguration = [SPTrackerConfiguration new];
+    XCTAssertEqual(SPTrackingQueueOverflowPolicyDropNewest, trackerConfiguration.trackingQueueOverflowPolicy);
+
+    SPNetworkConfiguration *networkConfiguration = [[SPNetworkConfiguration alloc] initWithEndpoint:@"fake-url" method:SPHttpMethodPost];
+    id<SPTrackerController> trackerController = [SPSnowplow createTrackerWithNamespace:@"namespace" network:networkConfiguration configurations:@[trackerConfiguration]];
+    XCTAssertEqual(SPTrackingQueueOverflowPolicyDropNewest, trackerController.trackingQueueOverflowPolicy);
+
+    trackerConfiguration = [[SPTrackerConfiguration alloc] initWithDictionary:@{@"trackingQueueOverflowPolicy": @"unknown"}];
+    XCTAssertEqual(SPTrackingQueueOverflowPolicyDropNewest, trackerConfiguration.trackingQueueOverflowPolicy);
+}
 @end
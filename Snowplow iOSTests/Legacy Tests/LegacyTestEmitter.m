@@ -25,6 +25,7 @@
 #import "SPEmitter.h"
 #import "SPLogger.h"
 #import "SPMockEventStore.h"
+#import "SPMemoryEventStore.h"
 #import "SPMockNetworkConnection.h"
 
 
@@ -50,6 +51,42 @@
 
 @end
 
+/// Rejects with a 400 the requests containing an event with "poison" as value.
+@interface SPPoisonNetworkConnection : SPMockNetworkConnection
+@end
+
+@implementation SPPoisonNetworkConnection
+
+- (NSArray<SPRequestResult *> *)sendRequests:(NSArray<SPRequest *> *)requests {
+    NSData *poison = [@"poison" dataUsingEncoding:NSUTF8StringEncoding];
+    NSMutableArray<SPRequestResult *> *results = [NSMutableArray new];
+    for (SPRequest *request in requests) {
+        BOOL isPoisoned = [request.jsonData rangeOfData:poison options:0 range:NSMakeRange(0, request.jsonData.length)].location != NSNotFound;
+        [results addObject:[[SPRequestResult alloc] initWithStatusCode:(isPoisoned ? 400 : 200) oversize:NO storeIds:request.emitterEventIds]];
+    }
+    @synchronized (self) {
+        [self.previousRequests addObject:requests];
+        [self.previousResults addObject:results];
+    }
+    return results;
+}
+
+@end
+
+/// Counts its events but can't read them, like a store with corrupt records.
+@interface SPUnreadableEventStore : SPMockEventStore
+@property (atomic) NSUInteger readCount;
+@end
+
+@implementation SPUnreadableEventStore
+
+- (NSArray<SPEmitterEvent *> *)emittableEventsWithQueryLimit:(NSUInteger)queryLimit {
+    self.readCount++;
+    return @[];
+}
+
+@end
+
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wdeprecated-declarations"
 
@@ -321,6 +358,36 @@ NSString *const TEST_SERVER_EMITTER = @"www.notarealurl.com";
     [emitter flush];
 }
 
+- (void)testBisectionIsolatesTheFailingEvent {
+    SPPoisonNetworkConnection *networkConnection = [[SPPoisonNetworkConnection alloc] initWithRequestOption:SPHttpMethodPost statusCode:200];
+    SPMemoryEventStore *eventStore = [SPMemoryEventStore new];
+    SPEmitter *emitter = [self emitterWithNetworkConnection:networkConnection build:^(id<SPEmitterBuilder> builder) {
+        [builder setBufferOption:SPBufferOptionDefaultGroup];
+        [builder setEventStore:eventStore];
+        [builder setBisectFailedBatches:YES];
+    }];
+    NSArray<SPPayload *> *payloads = [self generatePayloads:8];
+    [payloads[5] addValueToPayload:@"poison" forKey:@"a"];
+    for (SPPayload *payload in payloads) {
+        [eventStore addEvent:payload];
+    }
+    [emitter flush];
+    for (int i = 0; i < 10 && ([networkConnection sendingCount] < 1 || [emitter getSendingStatus]); i++) {
+        [NSThread sleepForTimeInterval:1];
+    }
+
+    // 8 events -> 4 + 4 -> 2 + 2 -> 1 + 1: only the halves with the poisoned event are split again.
+    NSUInteger requestCount = 0;
+    for (NSArray<SPRequest *> *requests in networkConnection.previousRequests) {
+        requestCount += requests.count;
+    }
+    XCTAssertEqual(7, requestCount);
+    XCTAssertEqual(0, [emitter getDbCount]);
+    NSArray<SPEmitterEvent *> *deadLetterEvents = [eventStore deadLetterEventsWithQueryLimit:10];
+    XCTAssertEqual(1, deadLetterEvents.count);
+    XCTAssertEqualObjects(@"poison", [[deadLetterEvents.firstObject.payload getAsDictionary] objectForKey:@"a"]);
+}
+
 // MARK: - Emitter builder
 
 - (SPEmitter *)emitterWithNetworkConnection:(id<SPNetworkConnection>)networkConnection bufferOption:(SPBufferOption)bufferOption {
@@ -387,6 +454,108 @@ NSString *const TEST_SERVER_EMITTER = @"www.notarealurl.com";
     [emitter flush];
 }
 
+- (void)testBacksOffAfterAllRequestsFail {
+    SPMockNetworkConnection *networkConnection = [[SPMockNetworkConnection alloc] initWithRequestOption:SPHttpMethodGet statusCode:500];
+    SPEmitter *emitter = [self emitterWithNetworkConnection:networkConnection bufferOption:SPBufferOptionSingle];
+    
+    [emitter addPayloadToBuffer:[self generatePayloads:1].firstObject];
+    
+    for (int i = 0; i < 10 && ([networkConnection sendingCount] < 1 || [emitter getSendingStatus]); i++) {
+        [NSThread sleepForTimeInterval:1];
+    }
+    
+    XCTAssertFalse([emitter getSendingStatus]);
+    XCTAssertTrue([emitter isBackingOff]);
+    XCTAssertEqual(1, [emitter retryAttempts]);
+    XCTAssertNotNil([emitter nextRetryDate]);
+    
+    // New events are stored but not sent while backing off
+    [emitter addPayloadToBuffer:[self generatePayloads:1].firstObject];
+    [NSThread sleepForTimeInterval:1];
+    XCTAssertEqual(1, [networkConnection sendingCount]);
+    XCTAssertEqual(2, [emitter getDbCount]);
+    
+    // The scheduled retry sends the events once the collector recovers
+    networkConnection.statusCode = 200;
+    for (int i = 0; i < 10 && [emitter getDbCount] > 0; i++) {
+        [NSThread sleepForTimeInterval:1];
+    }
+    
+    XCTAssertEqual(0, [emitter getDbCount]);
+    XCTAssertFalse([emitter isBackingOff]);
+    XCTAssertEqual(0, [emitter retryAttempts]);
+    XCTAssertNil([emitter nextRetryDate]);
+}
+
+- (void)testBatchesEventsUntilEventCountIsReached {
+    SPMockNetworkConnection *networkConnection = [[SPMockNetworkConnection alloc] initWithRequestOption:SPHttpMethodPost statusCode:200];
+    SPEmitter *emitter = [self emitterWithNetworkConnection:networkConnection build:^(id<SPEmitterBuilder> builder) {
+        [builder setBufferOption:SPBufferOptionDefaultGroup];
+        [builder setBatchingDelay:60];
+        [builder setBatchingEventCount:3];
+    }];
+    
+    NSArray<SPPayload *> *payloads = [self generatePayloads:3];
+    [emitter addPayloadToBuffer:payloads[0]];
+    [emitter addPayloadToBuffer:payloads[1]];
+    [NSThread sleepForTimeInterval:1];
+    XCTAssertEqual(0, [networkConnection sendingCount]);
+    XCTAssertEqual(2, [emitter getDbCount]);
+    
+    [emitter addPayloadToBuffer:payloads[2]];
+    for (int i = 0; i < 10 && ([networkConnection sendingCount] < 1 || [emitter getSendingStatus]); i++) {
+        [NSThread sleepForTimeInterval:1];
+    }
+    
+    XCTAssertEqual(1, networkConnection.previousRequests.count);
+    XCTAssertEqual(3, networkConnection.previousRequests.firstObject.firstObject.emitterEventIds.count);
+    XCTAssertEqual(0, [emitter getDbCount]);
+}
+
+- (void)testBatchingSendsAfterDelayOrForImmediateEvents {
+    SPMockNetworkConnection *networkConnection = [[SPMockNetworkConnection alloc] initWithRequestOption:SPHttpMethodPost statusCode:200];
+    SPEmitter *emitter = [self emitterWithNetworkConnection:networkConnection build:^(id<SPEmitterBuilder> builder) {
+        [builder setBufferOption:SPBufferOptionDefaultGroup];
+        [builder setBatchingDelay:2];
+        [builder setBatchingEventCount:100];
+        [builder setImmediateFlushEvents:@[@"pv"]];
+    }];
+    XCTAssertTrue([emitter isImmediateFlushEventWithSchema:nil eventName:@"pv"]);
+    XCTAssertFalse([emitter isImmediateFlushEventWithSchema:nil eventName:@"se"]);
+    
+    // Sent when the batching delay expires
+    [emitter addPayloadToBuffer:[self generatePayloads:1].firstObject];
+    XCTAssertEqual(0, [networkConnection sendingCount]);
+    for (int i = 0; i < 10 && ([networkConnection sendingCount] < 1 || [emitter getSendingStatus]); i++) {
+        [NSThread sleepForTimeInterval:1];
+    }
+    XCTAssertEqual(1, [networkConnection sendingCount]);
+    XCTAssertEqual(0, [emitter getDbCount]);
+    
+    // Sent straight away when flagged
+    [emitter addPayloadToBuffer:[self generatePayloads:1].firstObject flushImmediately:YES];
+    [NSThread sleepForTimeInterval:1];
+    XCTAssertEqual(2, [networkConnection sendingCount]);
+    XCTAssertEqual(0, [emitter getDbCount]);
+}
+
+- (void)testStopsEmittingWhenStoredEventsCantBeRead {
+    SPMockNetworkConnection *networkConnection = [[SPMockNetworkConnection alloc] initWithRequestOption:SPHttpMethodPost statusCode:200];
+    SPUnreadableEventStore *eventStore = [SPUnreadableEventStore new];
+    SPEmitter *emitter = [self emitterWithNetworkConnection:networkConnection build:^(id<SPEmitterBuilder> builder) {
+        [builder setEventStore:eventStore];
+    }];
+    
+    [emitter addPayloadToBuffer:[self generatePayloads:1].firstObject];
+    [NSThread sleepForTimeInterval:1];
+    
+    // The round ends instead of reading the store again and again
+    XCTAssertEqual(1, [emitter getDbCount]);
+    XCTAssertEqual(0, [networkConnection sendingCount]);
+    XCTAssertLessThan(eventStore.readCount, 5);
+    XCTAssertFalse([emitter getSendingStatus]);
+}
+
 // MARK: - Service methods
 
 - (NSArray<SPPayload *> *)generatePayloads:(int)count {
@@ -0,0 +1,64 @@
+//
+//  TestCompactPayloadCodec.m
+//  Snowplow
+//
+//  Copyright (c) 2013-2022 Snowplow Analytics Ltd. All rights reserved.
+//
+//  This program is licensed to you under the Apache License Version 2.0,
+//  and you may not use this file except in compliance with the Apache License
+//  Version 2.0. You may obtain a copy of the Apache License Version 2.0 at
+//  http://www.apache.org/licenses/LICENSE-2.0.
+//
+//  Unless required by applicable law or agreed to in writing,
+//  software distributed under the Apache License Version 2.0 is distributed on
+//  an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+//  express or implied. See the Apache License Version 2.0 for the specific
+//  language governing permissions and limitations there under.
+//
+//  License: Apache License Version 2.0
+//
+
+#import <XCTest/XCTest.h>
+#import "SPCompactPayloadCodec.h"
+#import "SPPayload.h"
+
+@interface TestCompactPayloadCodec : XCTestCase
+@end
+
+@implementation TestCompactPayloadCodec
+
+- (void)testRoundTripKeepsKeysAndValueTypes {
+    NSDictionary *dictionary = @{@"e": @"pv", @"eid": @"c2c3a3e4-7d29-4b31-9a26-5c1e2b1a3f01", @"url": @"https://snowplow.io/ü",
+                                 @"custom_key": @"value", @"int": @(-42), @"big": @(1650000000000), @"double": @(0.25),
+                                 @"bool": @YES, @"empty": @""};
+    NSData *data = [SPCompactPayloadCodec dataWithPayload:[[SPPayload alloc] initWithNSDictionary:dictionary] compress:NO];
+    XCTAssertTrue([SPCompactPayloadCodec isCompactData:data]);
+    XCTAssertEqualObjects(dictionary, [[SPCompactPayloadCodec payloadWithData:data] getAsDictionary]);
+}
+
+- (void)testCompressionShrinksRepetitiveRecords {
+    NSString *context = [@"" stringByPaddingToLength:2000 withString:@"{\"schema\":\"iglu:com.snowplowanalytics.mobile/screen/jsonschema/1-0-0\"}," startingAtIndex:0];
+    SPPayload *payload = [[SPPayload alloc] initWithNSDictionary:@{@"e": @"ue", @"co": context}];
+    NSData *data = [SPCompactPayloadCodec dataWithPayload:payload compress:NO];
+    NSData *compressedData = [SPCompactPayloadCodec dataWithPayload:payload compress:YES];
+    XCTAssertLessThan(compressedData.length, data.length / 4);
+    XCTAssertLessThan(data.length, [payload jsonData].length);
+    XCTAssertEqualObjects([payload getAsDictionary], [[SPCompactPayloadCodec payloadWithData:compressedData] getAsDictionary]);
+}
+
+- (void)testUnsupportedOrCorruptedRecordsAreRejected {
+    SPPayload *payload = [[SPPayload alloc] initWithNSDictionary:@{@"e": @"pv", @"nested": @{@"a": @"b"}}];
+    XCTAssertNil([SPCompactPayloadCodec dataWithPayload:payload compress:YES]);
+
+    NSString *longValue = [@"" stringByPaddingToLength:500 withString:@"abcdef" startingAtIndex:0];
+    NSData *data = [SPCompactPayloadCodec dataWithPayload:[[SPPayload alloc] initWithNSDictionary:@{@"e": longValue}] compress:YES];
+    XCTAssertNil([SPCompactPayloadCodec payloadWithData:[data subdataWithRange:NSMakeRange(0, data.length - 3)]]);
+
+    // Records from a newer format version are skipped.
+    NSMutableData *newerData = data.mutableCopy;
+    ((uint8_t *)newerData.mutableBytes)[1] = 0xFF;
+    XCTAssertNil([SPCompactPayloadCodec payloadWithData:newerData]);
+    XCTAssertFalse([SPCompactPayloadCodec isCompactData:[payload jsonData]]);
+}
+
+@end
@@ -0,0 +1,227 @@
+//
+//  TestContextFragmentCache.m
+//  Snowplow-iOSTests
+//
+//  Copyright (c) 2013-2022 Snowplow Analytics Ltd. All rights reserved.
+//
+//  This program is licensed to you under the Apache License Version 2.0,
+//  and you may not use this file except in compliance with the Apache License
+//  Version 2.0. You may obtain a copy of the Apache License Version 2.0 at
+//  http://www.apache.org/licenses/LICENSE-2.0.
+//
+//  Unless required by applicable law or agreed to in writing,
+//  software distributed under the Apache License Version 2.0 is distributed on
+//  an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+//  express or implied. See the Apache License Version 2.0 for the specific
+//  language governing permissions and limitations there under.
+//
+//  License: Apache License Version 2.0
+//
+
+#import <XCTest/XCTest.h>
+#import "SPContextFragmentCache.h"
+#import "SPSelfDescribingJson.h"
+#import "SPSubject.h"
+#import "SPTrackerConstants.h"
+#import "SPSnowplow.h"
+#import "SPNetworkConfiguration.h"
+#import "SPTrackerConfiguration.h"
+#import "SPEmitterConfiguration.h"
+#import "SPMockEventStore.h"
+#import "SPMockDeviceInfoMonitor.h"
+#import "SPPlatformContext.h"
+#import "SPServiceProvider.h"
+#import "SPTracker.h"
+
+/// Reports different memory and storage values on every refresh, as a real device does.
+@interface SPChangingDeviceInfoMonitor : SPMockDeviceInfoMonitor
+@end
+
+@implementation SPChangingDeviceInfoMonitor
+
+- (NSNumber *) appAvailableMemory {
+    [super appAvailableMemory];
+    return @(1000 + [self accessCount:@"appAvailableMemory"]);
+}
+
+- (NSNumber *) availableStorage {
+    [super availableStorage];
+    return @(9000 + [self accessCount:@"availableStorage"]);
+}
+
+@end
+
+/// Counts how many times the platform dictionary is fetched to build the context fragment.
+@interface SPCountingPlatformContext : SPPlatformContext
+@property (nonatomic) int fetchCount;
+@end
+
+@implementation SPCountingPlatformContext
+
+- (SPPayload *) fetchPlatformDictWithUserAnonymisation:(BOOL)userAnonymisation {
+    self.fetchCount++;
+    return [super fetchPlatformDictWithUserAnonymisation:userAnonymisation];
+}
+
+@end
+
+@interface TestContextFragmentCache : XCTestCase
+@end
+
+@implementation TestContextFragmentCache
+
+- (void)testFragmentIsBuiltOncePerVersion {
+    SPContextFragmentCache *cache = [SPContextFragmentCache new];
+    __block int builds = 0;
+    SPSelfDescribingJson *(^builder)(void) = ^SPSelfDescribingJson *{
+        builds++;
+        return [[SPSelfDescribingJson alloc] initWithSchema:@"iglu:com.acme/entity/jsonschema/1-0-0" andData:@{@"build": @(builds)}];
+    };
+
+    NSData *fragment = [cache fragmentWithKey:@"entity" version:1 builder:builder];
+    XCTAssertEqualObjects(fragment, [cache fragmentWithKey:@"entity" version:1 builder:builder]);
+    XCTAssertEqual(1, builds);
+
+    NSData *updatedFragment = [cache fragmentWithKey:@"entity" version:2 builder:builder];
+    XCTAssertEqual(2, builds);
+    XCTAssertNotEqualObjects(fragment, updatedFragment);
+
+    [cache removeAllFragments];
+    [cache fragmentWithKey:@"entity" version:2 builder:builder];
+    XCTAssertEqual(3, builds);
+}
+
+- (void)testMissingEntityIsCached {
+    SPContextFragmentCache *cache = [SPContextFragmentCache new];
+    __block int builds = 0;
+    SPSelfDescribingJson *(^builder)(void) = ^SPSelfDescribingJson *{
+        builds++;
+        return nil;
+    };
+    XCTAssertNil([cache fragmentWithKey:@"entity" version:0 builder:builder]);
+    XCTAssertNil([cache fragmentWithKey:@"entity" version:0 builder:builder]);
+    XCTAssertEqual(1, builds);
+}
+
+- (void)testFragmentBuiltDuringRemovalIsNotStored {
+    SPContextFragmentCache *cache = [SPContextFragmentCache new];
+    __block int builds = 0;
+    SPSelfDescribingJson *(^builder)(void) = ^SPSelfDescribingJson *{
+        builds++;
+        if (builds == 1) {
+            // The cache is invalidated while the fragment is being built.
+            [cache removeAllFragments];
+        }
+        return [[SPSelfDescribingJson alloc] initWithSchema:@"iglu:com.acme/entity/jsonschema/1-0-0" andData:@{@"build": @(builds)}];
+    };
+
+    XCTAssertNotNil([cache fragmentWithKey:@"entity" version:1 builder:builder]);
+    [cache fragmentWithKey:@"entity" version:1 builder:builder];
+    XCTAssertEqual(2, builds);
+    [cache fragmentWithKey:@"entity" version:1 builder:builder];
+    XCTAssertEqual(2, builds);
+}
+
+- (void)testContextsJsonListsFragmentsAndEntities {
+    SPContextFragmentCache *cache = [SPContextFragmentCache new];
+    NSData *fragment = [cache fragmentWithKey:@"entity" version:0 builder:^SPSelfDescribingJson *{
+        return [[SPSelfDescribingJson alloc] initWithSchema:@"iglu:com.acme/static/jsonschema/1-0-0" andData:@{@"key": @"value"}];
+    }];
+    SPSelfDescribingJson *entity = [[SPSelfDescribingJson alloc] initWithSchema:@"iglu:com.acme/dynamic/jsonschema/1-0-0" andData:@{@"key": @"value"}];
+
+    NSData *json = [SPContextFragmentCache contextsJsonWithEntries:@[entity, fragment, entity]];
+    NSDictionary *contexts = [NSJSONSerialization JSONObjectWithData:json options:0 error:nil];
+    XCTAssertEqualObjects(kSPContextSchema, contexts[kSPSchema]);
+    NSArray<NSDictionary *> *data = contexts[kSPData];
+    XCTAssertEqual(3, data.count);
+    XCTAssertEqualObjects([entity getAsDictionary], data[0]);
+    XCTAssertEqualObjects(@"iglu:com.acme/static/jsonschema/1-0-0", data[1][kSPSchema]);
+    XCTAssertEqualObjects([entity getAsDictionary], data[2]);
+
+    json = [SPContextFragmentCache contextsJsonWithEntries:@[]];
+    contexts = [NSJSONSerialization JSONObjectWithData:json options:0 error:nil];
+    XCTAssertEqual(0, [contexts[kSPData] count]);
+}
+
+- (void)testSubjectContextVersionChangesWithGeoLocation {
+    SPSubject *subject = [[SPSubject alloc] initWithPlatformContext:NO andGeoContext:YES];
+    NSUInteger version = subject.contextVersion;
+    XCTAssertEqual(version, subject.contextVersion);
+    [subject setGeoLatitude:10];
+    XCTAssertNotEqual(version, subject.contextVersion);
+    version = subject.contextVersion;
+    subject.geoLocationContext = NO;
+    XCTAssertNotEqual(version, subject.contextVersion);
+}
+
+- (void)testPlatformFragmentIsBuiltOncePerRefreshInterval {
+#if SNOWPLOW_TARGET_IOS
+    SPMockEventStore *eventStore = [SPMockEventStore new];
+    SPNetworkConfiguration *networkConfiguration = [[SPNetworkConfiguration alloc] initWithEndpoint:@"fake-url" method:SPHttpMethodPost];
+    SPTrackerConfiguration *trackerConfiguration = [[[SPTrackerConfiguration alloc] init] appId:@"appid"];
+    trackerConfiguration.platformContext = YES;
+    trackerConfiguration.asynchronousTracking = NO;
+    SPEmitterConfiguration *emitterConfiguration = [[SPEmitterConfiguration alloc] init];
+    emitterConfiguration.eventStore = eventStore;
+    SPServiceProvider *serviceProvider = [[SPServiceProvider alloc] initWithNamespace:@"platformFragment" network:networkConfiguration configurations:@[trackerConfiguration, emitterConfiguration]];
+    SPTracker *tracker = serviceProvider.tracker;
+
+    SPCountingPlatformContext *platformContext = [[SPCountingPlatformContext alloc] initWithMobileDictUpdateFrequency:0.1 networkDictUpdateFrequency:10 deviceInfoMonitor:[SPChangingDeviceInfoMonitor new]];
+    [tracker.subject setValue:platformContext forKey:@"platformContextManager"];
+    tracker.subject.platformContext = YES;
+
+    // The memory and storage values change on every refresh but the events are tracked within the refresh interval.
+    NSDate *start = [NSDate date];
+    for (int i = 0; i < 5; i++) {
+        [tracker track:[[SPStructured alloc] initWithCategory:@"category" action:@"action"]];
+    }
+    if ([[NSDate date] timeIntervalSinceDate:start] < 0.1) {
+        XCTAssertEqual(1, platformContext.fetchCount);
+    }
+
+    // The fragment is built again once the interval elapses.
+    int fetchCount = platformContext.fetchCount;
+    [NSThread sleepForTimeInterval:0.2];
+    [tracker track:[[SPStructured alloc] initWithCategory:@"category" action:@"action"]];
+    [tracker track:[[SPStructured alloc] initWithCategory:@"category" action:@"action"]];
+    XCTAssertEqual(fetchCount + 1, platformContext.fetchCount);
+#endif
+}
+
+- (void)testUserAnonymisationWhileTrackingRemovesUserIdentifiers {
+    SPMockEventStore *eventStore = [SPMockEventStore new];
+    SPNetworkConfiguration *networkConfiguration = [[SPNetworkConfiguration alloc] initWithEndpoint:@"fake-url" method:SPHttpMethodPost];
+    SPTrackerConfiguration *trackerConfiguration = [[[SPTrackerConfiguration alloc] init] appId:@"appid"];
+    trackerConfiguration.base64Encoding = NO;
+    trackerConfiguration.platformContext = YES;
+    trackerConfiguration.asynchronousTracking = NO;
+    SPEmitterConfiguration *emitterConfiguration = [[SPEmitterConfiguration alloc] init];
+    emitterConfiguration.eventStore = eventStore;
+    id<SPTrackerController> trackerController = [SPSnowplow createTrackerWithNamespace:@"fragmentCacheRace" network:networkConfiguration configurations:@[trackerConfiguration, emitterConfiguration]];
+
+    // Track from other threads while the anonymisation is turned on.
+    dispatch_group_t group = dispatch_group_create();
+    for (int i = 0; i < 4; i++) {
+        dispatch_group_async(group, dispatch_get_global_queue(QOS_CLASS_DEFAULT, 0), ^{
+            for (int j = 0; j < 50; j++) {
+                [trackerController track:[[SPStructured alloc] initWithCategory:@"category" action:@"concurrent"]];
+            }
+        });
+    }
+    trackerController.userAnonymisation = YES;
+    dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+    [eventStore removeAllEvents];
+
+    [trackerController track:[[SPStructured alloc] initWithCategory:@"category" action:@"anonymous"]];
+    for (int i = 0; i < 10 && eventStore.count < 1; i++) {
+        [NSThread sleepForTimeInterval:1];
+    }
+    NSArray<SPEmitterEvent *> *events = [eventStore emittableEventsWithQueryLimit:10];
+    XCTAssertEqual(1, events.count);
+    NSString *contexts = (NSString *)[[events.firstObject.payload getAsDictionary] objectForKey:kSPContext];
+    XCTAssertTrue([contexts containsString:@"mobile_context"]);
+    XCTAssertFalse([contexts containsString:@"\"appleIdfa\":\""]);
+    XCTAssertFalse([contexts containsString:@"\"appleIdfv\":\""]);
+}
+
+@end
@@ -0,0 +1,112 @@
+//
+//  TestEmitterMetrics.m
+//  Snowplow
+//
+//  Copyright (c) 2013-2022 Snowplow Analytics Ltd. All rights reserved.
+//
+//  This program is licensed to you under the Apache License Version 2.0,
+//  and you may not use this file except in compliance with the Apache License
+//  Version 2.0. You may obtain a copy of the Apache License Version 2.0 at
+//  http://www.apache.org/licenses/LICENSE-2.0.
+//
+//  Unless required by applicable law or agreed to in writing,
+//  software distributed under the Apache License Version 2.0 is distributed on
+//  an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+//  express or implied. See the Apache License Version 2.0 for the specific
+//  language governing permissions and limitations there under.
+//
+//  License: Apache License Version 2.0
+//
+
+#import <XCTest/XCTest.h>
+#import "SPEmitterMetricsRecorder.h"
+#import "SPEmitter.h"
+#import "SPMockNetworkConnection.h"
+#import "SPMockEventStore.h"
+
+@interface TestEmitterMetrics : XCTestCase
+
+@end
+
+@implementation TestEmitterMetrics
+
+- (void)testRecorderComputesPercentilesAndCounters {
+    SPEmitterMetricsRecorder *recorder = [SPEmitterMetricsRecorder new];
+    NSMutableArray<SPRequestResult *> *results = [NSMutableArray new];
+    for (int i = 1; i <= 100; i++) {
+        SPRequestResult *result = [[SPRequestResult alloc] initWithStatusCode:(i <= 90 ? 200 : 500) oversize:NO storeIds:@[@(i), @(i + 1000)]];
+        result.duration = i / 1000.0;
+        result.byteSize = 10;
+        result.uncompressedByteSize = 30;
+        [results addObject:result];
+    }
+    [recorder recordRequestResults:results];
+    [recorder recordRetryWithStatusCode:500];
+    [recorder recordRetryWithStatusCode:500];
+    [recorder recordRetryWithStatusCode:-1];
+    [recorder recordEmitRoundDuration:0.5];
+    [recorder recordEmitRoundDuration:1.5];
+
+    SPEmitterMetrics *metrics = [recorder metricsWithQueuedEventCount:3 oldestEventAge:60];
+    XCTAssertEqual(100, metrics.requestCount);
+    XCTAssertEqual(10, metrics.failedRequestCount);
+    XCTAssertEqual(180, metrics.sentEventCount);
+    XCTAssertEqual(1000, metrics.bytesSent);
+    XCTAssertEqual(3000, metrics.uncompressedBytesSent);
+    XCTAssertEqualWithAccuracy(2.0, metrics.averageEventsPerRequest, 0.001);
+    XCTAssertEqual(2, metrics.maxEventsPerRequest);
+    XCTAssertEqualWithAccuracy(0.050, metrics.requestLatencyP50, 0.0001);
+    XCTAssertEqualWithAccuracy(0.090, metrics.requestLatencyP90, 0.0001);
+    XCTAssertEqualWithAccuracy(0.099, metrics.requestLatencyP99, 0.0001);
+    XCTAssertEqualWithAccuracy(0.5, metrics.emitRoundDurationP50, 0.0001);
+    XCTAssertEqualWithAccuracy(1.5, metrics.emitRoundDurationMax, 0.0001);
+    XCTAssertEqualObjects(@2, metrics.retriesByStatusCode[@500]);
+    XCTAssertEqualObjects(@1, metrics.retriesByStatusCode[@0]);
+    XCTAssertEqual(3, metrics.queuedEventCount);
+    XCTAssertEqualWithAccuracy(60, metrics.oldestEventAge, 0.0001);
+
+    [recorder reset];
+    metrics = [recorder metricsWithQueuedEventCount:0 oldestEventAge:0];
+    XCTAssertEqual(0, metrics.requestCount);
+    XCTAssertEqual(0, metrics.requestLatencyP99);
+    XCTAssertEqual(0, metrics.retriesByStatusCode.count);
+}
+
+- (void)testRecorderKeepsBoundedSamples {
+    SPEmitterMetricsRecorder *recorder = [SPEmitterMetricsRecorder new];
+    for (int i = 0; i < 10000; i++) {
+        [recorder recordEmitRoundDuration:i];
+    }
+    XCTAssertLessThan(recorder.emitRoundDurations.count, 10000);
+    // The most recent samples are kept
+    XCTAssertEqualWithAccuracy(9999, [recorder metricsWithQueuedEventCount:0 oldestEventAge:0].emitRoundDurationMax, 0.0001);
+}
+
+- (void)testEmitterReportsRetriesAndQueuedEvents {
+    SPMockNetworkConnection *networkConnection = [[SPMockNetworkConnection alloc] initWithRequestOption:SPHttpMethodPost statusCode:500];
+    SPEmitter *emitter = [SPEmitter build:^(id<SPEmitterBuilder> builder) {
+        [builder setNetworkConnection:networkConnection];
+        [builder setBufferOption:SPBufferOptionSingle];
+        [builder setEventStore:[SPMockEventStore new]];
+    }];
+    SPPayload *payload = [SPPayload new];
+    [payload addValueToPayload:@"value" forKey:@"key"];
+    [emitter addPayloadToBuffer:payload];
+
+    for (int i = 0; i < 10 && ([networkConnection sendingCount] < 1 || [emitter getSendingStatus]); i++) {
+        [NSThread sleepForTimeInterval:1];
+    }
+
+    SPEmitterMetrics *metrics = [emitter metrics];
+    XCTAssertEqual(1, metrics.requestCount);
+    XCTAssertEqual(1, metrics.failedRequestCount);
+    XCTAssertEqualObjects(@1, metrics.retriesByStatusCode[@500]);
+    XCTAssertEqual(1, metrics.queuedEventCount);
+    XCTAssertGreaterThanOrEqual(metrics.oldestEventAge, 0);
+    XCTAssertGreaterThan(metrics.emitRoundDurationMax, 0);
+
+    [emitter resetMetrics];
+    XCTAssertEqual(0, [emitter metrics].requestCount);
+}
+
+@end
@@ -43,6 +43,7 @@
     emitterConfiguration.eventStore = eventStore;
     emitterConfiguration.threadPoolSize = 10;
     id<SPTrackerController> trackerController = [SPSnowplow createTrackerWithNamespace:@"namespace" network:networkConfiguration configurations:@[trackerConfiguration, emitterConfiguration]];
+    XCTAssertGreaterThan(trackerController.initializationDuration, 0);
 
     // Track event
     [trackerController track:event];
@@ -0,0 +1,92 @@
+//
+//  TestHybridEventStore.m
+//  Snowplow
+//
+//  Copyright (c) 2013-2022 Snowplow Analytics Ltd. All rights reserved.
+//
+//  This program is licensed to you under the Apache License Version 2.0,
+//  and you may not use this file except in compliance with the Apache License
+//  Version 2.0. You may obtain a copy of the Apache License Version 2.0 at
+//  http://www.apache.org/licenses/LICENSE-2.0.
+//
+//  Unless required by applicable law or agreed to in writing,
+//  software distributed under the Apache License Version 2.0 is distributed on
+//  an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+//  express or implied. See the Apache License Version 2.0 for the specific
+//  language governing permissions and limitations there under.
+//
+//  License: Apache License Version 2.0
+//
+
+#import <XCTest/XCTest.h>
+#import "SPHybridEventStore.h"
+#import "SPSQLiteEventStore.h"
+#import "SPPayload.h"
+
+@interface TestHybridEventStore : XCTestCase
+@end
+
+@implementation TestHybridEventStore
+
+- (void)setUp {
+    [[[SPSQLiteEventStore alloc] initWithNamespace:@"aNamespace"] removeAllEvents];
+}
+
+- (void)testBufferedEventsCanBeSentBeforeBeingWritten {
+    SPHybridEventStore *eventStore = [[SPHybridEventStore alloc] initWithNamespace:@"aNamespace" durabilityWindow:60 flushBatchSize:1000];
+    for (int i = 0; i < 3; i++) {
+        [eventStore addEvent:[[SPPayload alloc] initWithNSDictionary:@{@"i": @(i).stringValue}]];
+    }
+    XCTAssertEqual(3, [eventStore count]);
+    XCTAssertEqual(0, [[[SPSQLiteEventStore alloc] initWithNamespace:@"aNamespace"] count]);
+
+    NSArray<SPEmitterEvent *> *events = [eventStore emittableEventsWithQueryLimit:2];
+    XCTAssertEqual(2, events.count);
+    XCTAssertEqualObjects(@"0", [[events[0].payload getAsDictionary] objectForKey:@"i"]);
+    XCTAssertEqualObjects(@"1", [[events[1].payload getAsDictionary] objectForKey:@"i"]);
+
+    [eventStore removeEventsWithIds:@[@(events[0].storeId), @(events[1].storeId)]];
+    XCTAssertEqual(1, [eventStore count]);
+
+    [eventStore flush];
+    XCTAssertEqual(1, [eventStore count]);
+    XCTAssertEqual(1, [[[SPSQLiteEventStore alloc] initWithNamespace:@"aNamespace"] count]);
+}
+
+- (void)testEventsSentDuringTheWriteAreRemovedFromTheDatabase {
+    SPHybridEventStore *eventStore = [[SPHybridEventStore alloc] initWithNamespace:@"aNamespace" durabilityWindow:60 flushBatchSize:1000];
+    for (int i = 0; i < 5; i++) {
+        [eventStore addEvent:[[SPPayload alloc] initWithNSDictionary:@{@"i": @(i).stringValue}]];
+    }
+    NSArray<SPEmitterEvent *> *events = [eventStore emittableEventsWithQueryLimit:5];
+    [eventStore flush];
+    XCTAssertEqual(5, [eventStore count]);
+
+    // The temporary identifiers are still valid after the events are written.
+    NSMutableArray<NSNumber *> *storeIds = [NSMutableArray new];
+    for (SPEmitterEvent *event in events) {
+        XCTAssertLessThan(event.storeId, 0);
+        [storeIds addObject:@(event.storeId)];
+    }
+    [eventStore removeEventsWithIds:storeIds];
+    XCTAssertEqual(0, [eventStore count]);
+    XCTAssertEqual(0, [[[SPSQLiteEventStore alloc] initWithNamespace:@"aNamespace"] count]);
+}
+
+- (void)testEventsAreWrittenWhenTheBatchSizeIsReached {
+    SPHybridEventStore *eventStore = [[SPHybridEventStore alloc] initWithNamespace:@"aNamespace" durabilityWindow:60 flushBatchSize:10];
+    for (int i = 0; i < 10; i++) {
+        [eventStore addEvent:[[SPPayload alloc] initWithNSDictionary:@{@"i": @(i).stringValue}]];
+    }
+    SPSQLiteEventStore *sqliteEventStore = [[SPSQLiteEventStore alloc] initWithNamespace:@"aNamespace"];
+    for (int i = 0; i < 10 && [sqliteEventStore getAllEvents].count < 10; i++) {
+        [NSThread sleepForTimeInterval:0.5];
+    }
+    XCTAssertEqual(10, [sqliteEventStore getAllEvents].count);
+    XCTAssertEqual(10, [eventStore count]);
+
+    NSArray<SPEmitterEvent *> *events = [eventStore emittableEventsWithQueryLimit:10];
+    XCTAssertGreaterThan(events.firstObject.storeId, 0);
+}
+
+@end
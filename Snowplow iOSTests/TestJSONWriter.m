@@ -0,0 +1,108 @@
+//
+//  TestJSONWriter.m
+//  Snowplow-iOSTests
+//
+//  Copyright (c) 2013-2022 Snowplow Analytics Ltd. All rights reserved.
+//
+//  This program is licensed to you under the Apache License Version 2.0,
+//  and you may not use this file except in compliance with the Apache License
+//  Version 2.0. You may obtain a copy of the Apache License Version 2.0 at
+//  http://www.apache.org/licenses/LICENSE-2.0.
+//
+//  Unless required by applicable law or agreed to in writing,
+//  software distributed under the Apache License Version 2.0 is distributed on
+//  an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+//  express or implied. See the Apache License Version 2.0 for the specific
+//  language governing permissions and limitations there under.
+//
+//  License: Apache License Version 2.0
+//
+
+#import <XCTest/XCTest.h>
+#import "SPJSONWriter.h"
+#import "SPJSONSerialization.h"
+#import "SPTrackerConstants.h"
+
+@interface TestJSONWriter : XCTestCase
+@end
+
+@implementation TestJSONWriter
+
+- (NSDictionary *)samplePayload {
+    return @{
+        kSPEvent: kSPEventStructured,
+        kSPEid: @"c5b6ec5a-6e4b-4bba-9b0b-9b5f7c3d1e2a",
+        kSPTimestamp: @"1650000000000",
+        kSPStuctCategory: @"quotes \" and backslashes \\ and slashes /",
+        kSPStuctAction: @"controls \b\f\n\r\t \x01\x1f end",
+        kSPStuctLabel: @"unicode é 日本語 😀",
+        kSPStuctValue: @"",
+        @"custom key \"/": @"value",
+        kSPData: @[
+            @{kSPSchema: kSPMobileContextSchema, kSPData: @{
+                @"int": @(-42),
+                @"unsigned": @(UINT64_MAX),
+                @"long": @(LLONG_MIN),
+                @"char": [NSNumber numberWithChar:7],
+                @"double": @(3.14159),
+                @"integralDouble": @(2.0),
+                @"smallDouble": @(1e-7),
+                @"bigDouble": @(1e21),
+                @"float": @(0.1f),
+                @"true": @YES,
+                @"false": @NO,
+                @"null": [NSNull null],
+                @"array": @[@1, @"two", @[], @{}],
+            }},
+        ],
+    };
+}
+
+- (void)testOutputMatchesNSJSONSerialization {
+    NSDictionary *payload = [self samplePayload];
+    NSData *expected = [NSJSONSerialization dataWithJSONObject:payload options:0 error:nil];
+    XCTAssertEqualObjects(expected, [SPJSONWriter dataWithDictionary:payload]);
+    XCTAssertEqualObjects(@"{}", [[NSString alloc] initWithData:[SPJSONWriter dataWithDictionary:@{}] encoding:NSUTF8StringEncoding]);
+}
+
+- (void)testBufferIsReused {
+    SPJSONWriter *writer = [SPJSONWriter new];
+    NSDictionary *large = @{@"key": [@"" stringByPaddingToLength:100000 withString:@"\n" startingAtIndex:0]};
+    NSDictionary *small = @{kSPEvent: kSPEventPageView};
+    XCTAssertEqualObjects([NSJSONSerialization dataWithJSONObject:large options:0 error:nil], [writer dataWithDictionary:large]);
+    XCTAssertEqualObjects([NSJSONSerialization dataWithJSONObject:small options:0 error:nil], [writer dataWithDictionary:small]);
+}
+
+- (void)testUnsupportedValuesFallBackToNSJSONSerialization {
+    XCTAssertNil([SPJSONWriter dataWithDictionary:@{@"date": [NSDate date]}]);
+    XCTAssertNil([SPJSONWriter dataWithDictionary:@{@"nan": @(NAN)}]);
+    XCTAssertNil([SPJSONWriter dataWithDictionary:@{@1: @"numeric key"}]);
+    XCTAssertNil([SPJSONSerialization serializeDictionary:@{@"date": [NSDate date]}]);
+
+    // An unpaired surrogate can't be converted to UTF-8 by the writer.
+    unichar surrogate = 0xD800;
+    NSDictionary *payload = @{@"key": [NSString stringWithCharacters:&surrogate length:1]};
+    XCTAssertNil([SPJSONWriter dataWithDictionary:payload]);
+    NSData *expected = [NSJSONSerialization dataWithJSONObject:payload options:0 error:nil];
+    XCTAssertEqualObjects(expected, [SPJSONSerialization serializeDictionary:payload]);
+}
+
+- (void)testPerformanceOfWriter {
+    NSDictionary *payload = [self samplePayload];
+    [self measureBlock:^{
+        for (int i = 0; i < 10000; i++) {
+            [SPJSONWriter dataWithDictionary:payload];
+        }
+    }];
+}
+
+- (void)testPerformanceOfNSJSONSerialization {
+    NSDictionary *payload = [self samplePayload];
+    [self measureBlock:^{
+        for (int i = 0; i < 10000; i++) {
+            [NSJSONSerialization dataWithJSONObject:payload options:0 error:nil];
+        }
+    }];
+}
+
+@end
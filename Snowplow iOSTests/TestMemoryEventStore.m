@@ -78,4 +78,150 @@
     XCTAssertEqual([eventStore count], 0);
 }
 
+- (void)testEvictionDropsLowestPriorityEventsFirst {
+    SPMemoryEventStore *eventStore = [[SPMemoryEventStore alloc] init];
+    [eventStore setCapacityWithMaxEventCount:10 maxByteSize:0 maxEventAge:0];
+
+    for (int i = 0; i < 11; i++) {
+        SPPayload *payload = [[SPPayload alloc] initWithNSDictionary:@{@"i": @(i).stringValue}];
+        payload.priority = (i % 2) ? 0 : 1;
+        [eventStore addEvent:payload];
+    }
+
+    XCTAssertEqual(9, [eventStore count]);
+    NSMutableArray<NSString *> *values = [NSMutableArray new];
+    for (SPEmitterEvent *event in [eventStore emittableEventsWithQueryLimit:20]) {
+        [values addObject:[[event.payload getAsDictionary] objectForKey:@"i"]];
+    }
+    NSArray *expected = @[@"0", @"2", @"4", @"5", @"6", @"7", @"8", @"9", @"10"];
+    XCTAssertEqualObjects(expected, values);
+}
+
+- (void)testLeasedEventsAreNotReturnedAgain {
+    SPMemoryEventStore *eventStore = [[SPMemoryEventStore alloc] init];
+    [eventStore removeAllEvents];
+    for (int i = 0; i < 10; i++) {
+        [eventStore addEvent:[[SPPayload alloc] initWithNSDictionary:@{@"i": @(i).stringValue}]];
+    }
+
+    NSArray<SPEmitterEvent *> *firstBatch = [eventStore leaseEmittableEventsWithQueryLimit:4 leaseDuration:60];
+    NSArray<SPEmitterEvent *> *secondBatch = [eventStore leaseEmittableEventsWithQueryLimit:4 leaseDuration:60];
+    XCTAssertEqual(4, firstBatch.count);
+    XCTAssertEqual(4, secondBatch.count);
+    XCTAssertEqualObjects(@"0", [[firstBatch.firstObject.payload getAsDictionary] objectForKey:@"i"]);
+    XCTAssertEqualObjects(@"4", [[secondBatch.firstObject.payload getAsDictionary] objectForKey:@"i"]);
+
+    // Released events are returned again, removed ones are gone.
+    [eventStore releaseEventsWithIds:@[@(firstBatch[0].storeId)]];
+    [eventStore removeEventsWithIds:@[@(firstBatch[1].storeId)]];
+    NSArray<SPEmitterEvent *> *thirdBatch = [eventStore leaseEmittableEventsWithQueryLimit:10 leaseDuration:60];
+    XCTAssertEqual(3, thirdBatch.count);
+    XCTAssertEqual(firstBatch[0].storeId, thirdBatch.firstObject.storeId);
+
+    // Expired leases are returned again.
+    [eventStore removeAllEvents];
+    [eventStore addEvent:[[SPPayload alloc] initWithNSDictionary:@{@"i": @"0"}]];
+    XCTAssertEqual(1, [eventStore leaseEmittableEventsWithQueryLimit:10 leaseDuration:0].count);
+    XCTAssertEqual(1, [eventStore leaseEmittableEventsWithQueryLimit:10 leaseDuration:0].count);
+}
+
+- (void)testRemovalOutOfOrderAndWrapAround {
+    SPMemoryEventStore *eventStore = [[SPMemoryEventStore alloc] init];
+    for (int i = 0; i < 100; i++) {
+        [eventStore addEvent:[[SPPayload alloc] initWithNSDictionary:@{@"i": @(i).stringValue}]];
+    }
+    // Remove every other event among the first 60, then the remaining ones
+    NSMutableArray<NSNumber *> *storeIds = [NSMutableArray new];
+    for (int i = 0; i < 60; i += 2) {
+        [storeIds addObject:@(i)];
+    }
+    [eventStore removeEventsWithIds:storeIds];
+    XCTAssertEqual(70, [eventStore count]);
+    XCTAssertEqualObjects(@"1", [[[eventStore emittableEventsWithQueryLimit:1].firstObject.payload getAsDictionary] objectForKey:@"i"]);
+    [storeIds removeAllObjects];
+    for (int i = 1; i < 60; i += 2) {
+        [storeIds addObject:@(i)];
+    }
+    [eventStore removeEventsWithIds:storeIds];
+    XCTAssertEqual(40, [eventStore count]);
+
+    // New events wrap around the ring and are read in insertion order
+    for (int i = 100; i < 150; i++) {
+        [eventStore addEvent:[[SPPayload alloc] initWithNSDictionary:@{@"i": @(i).stringValue}]];
+    }
+    NSArray<SPEmitterEvent *> *events = [eventStore emittableEventsWithQueryLimit:100];
+    XCTAssertEqual(90, events.count);
+    for (NSUInteger i = 0; i < events.count; i++) {
+        XCTAssertEqual(60 + (long long)i, events[i].storeId);
+    }
+}
+
+- (void)testFixedCapacityOverflowPolicies {
+    SPMemoryEventStore *dropOldestStore = [[SPMemoryEventStore alloc] initWithCapacity:5 overflowPolicy:SPMemoryEventStoreOverflowPolicyDropOldest];
+    SPMemoryEventStore *dropNewestStore = [[SPMemoryEventStore alloc] initWithCapacity:5 overflowPolicy:SPMemoryEventStoreOverflowPolicyDropNewest];
+    for (int i = 0; i < 8; i++) {
+        SPPayload *payload = [[SPPayload alloc] initWithNSDictionary:@{@"i": @(i).stringValue}];
+        [dropOldestStore addEvent:payload];
+        [dropNewestStore addEvent:payload];
+    }
+    XCTAssertEqual(5, [dropOldestStore count]);
+    XCTAssertEqual(5, [dropNewestStore count]);
+    XCTAssertEqualObjects(@"3", [[[dropOldestStore emittableEventsWithQueryLimit:10].firstObject.payload getAsDictionary] objectForKey:@"i"]);
+    XCTAssertEqualObjects(@"4", [[[dropNewestStore emittableEventsWithQueryLimit:10].lastObject.payload getAsDictionary] objectForKey:@"i"]);
+}
+
+- (void)testEventsAreDeadLetteredAfterMaxAttempts {
+    SPMemoryEventStore *eventStore = [SPMemoryEventStore new];
+    for (int i = 0; i < 3; i++) {
+        [eventStore addEvent:[[SPPayload alloc] initWithNSDictionary:@{@"i": @(i).stringValue}]];
+    }
+
+    XCTAssertEqual(0, [eventStore recordFailedAttemptForEventsWithIds:@[@0, @1] maxAttempts:2].count);
+    XCTAssertEqualObjects(@[@0], [eventStore recordFailedAttemptForEventsWithIds:@[@0, @2] maxAttempts:2]);
+    XCTAssertEqual(2, [eventStore count]);
+    XCTAssertEqual(1, [eventStore emittableEventsWithQueryLimit:10].firstObject.storeId);
+
+    NSArray<SPEmitterEvent *> *deadLetterEvents = [eventStore deadLetterEventsWithQueryLimit:10];
+    XCTAssertEqual(1, deadLetterEvents.count);
+    XCTAssertEqualObjects(@"0", [[deadLetterEvents.firstObject.payload getAsDictionary] objectForKey:@"i"]);
+    [eventStore removeAllDeadLetterEvents];
+    XCTAssertEqual(0, [eventStore deadLetterEventsWithQueryLimit:10].count);
+}
+
+- (void)testFixedCapacityRingDoesntGrowWhenOldestEventStays {
+    SPMemoryEventStore *eventStore = [[SPMemoryEventStore alloc] initWithCapacity:5 overflowPolicy:SPMemoryEventStoreOverflowPolicyDropOldest];
+    [eventStore addEvent:[[SPPayload alloc] initWithNSDictionary:@{@"i": @"head"}]];
+    // The oldest event stays in the store (e.g. leased) while the newer ones are sent and removed.
+    for (int i = 1; i <= 1000; i++) {
+        [eventStore addEvent:[[SPPayload alloc] initWithNSDictionary:@{@"i": @(i).stringValue}]];
+        XCTAssertTrue([eventStore removeEventWithId:i]);
+    }
+    XCTAssertEqual(5, [[eventStore valueForKey:@"slots"] count]);
+    XCTAssertEqual(1, [eventStore count]);
+
+    [eventStore addEvent:[[SPPayload alloc] initWithNSDictionary:@{@"i": @"last"}]];
+    NSArray<SPEmitterEvent *> *events = [eventStore emittableEventsWithQueryLimit:10];
+    XCTAssertEqual(2, events.count);
+    XCTAssertEqual(0, events[0].storeId);
+    XCTAssertEqualObjects(@"head", [[events[0].payload getAsDictionary] objectForKey:@"i"]);
+    XCTAssertEqual(1001, events[1].storeId);
+
+    XCTAssertTrue([eventStore removeEventWithId:0]);
+    XCTAssertEqual(1, [eventStore count]);
+    XCTAssertEqual(1001, [eventStore emittableEventsWithQueryLimit:10].firstObject.storeId);
+}
+
+- (void)testEventsExpireWhenMaxAgeIsSetLater {
+    SPMemoryEventStore *eventStore = [SPMemoryEventStore new];
+    for (int i = 0; i < 3; i++) {
+        [eventStore addEvent:[[SPPayload alloc] initWithNSDictionary:@{@"i": @(i).stringValue}]];
+    }
+    [NSThread sleepForTimeInterval:1];
+    [eventStore addEvent:[[SPPayload alloc] initWithNSDictionary:@{@"i": @"recent"}]];
+
+    [eventStore setCapacityWithMaxEventCount:0 maxByteSize:0 maxEventAge:0.5];
+    XCTAssertEqual(1, [eventStore count]);
+    XCTAssertEqualObjects(@"recent", [[[eventStore emittableEventsWithQueryLimit:10].firstObject.payload getAsDictionary] objectForKey:@"i"]);
+}
+
 @end
@@ -222,4 +222,79 @@ NSString *const TEST_URL_ENDPOINT = @"acme.test.url.com";
     XCTAssertEqualObjects(@1, result.storeIds[0]);
 }
 
+- (void)testAddsContentEncodingHeaderForCompressedPostRequest {
+    stubRequest(@"POST", [[NSString alloc] initWithFormat:@"^%@://%@/i?(.*?)", @"https", TEST_URL_ENDPOINT].regex)
+        .withHeader(@"Content-Encoding", @"gzip")
+        .andReturn(200);
+    
+    SPDefaultNetworkConnection *connection = [SPDefaultNetworkConnection build:^(id<SPDefaultNetworkConnectionBuilder> builder) {
+        [builder setUrlEndpoint:TEST_URL_ENDPOINT];
+        [builder setHttpMethod:SPHttpMethodPost];
+        [builder setRequestCompression:YES];
+        [builder setCompressionThreshold:0];
+    }];
+    
+    SPPayload *payload = [SPPayload new];
+    [payload addValueToPayload:@"value" forKey:@"key"];
+    SPRequest *request = [[SPRequest alloc] initWithPayload:payload emitterEventId:1];
+    NSArray<SPRequestResult *> *results = [connection sendRequests:@[request]];
+    
+    // Check successful result
+    SPRequestResult *result = [results objectAtIndex:0];
+    XCTAssertTrue(result.isSuccessful);
+    XCTAssertEqualObjects(@1, result.storeIds[0]);
+}
+
+- (void)testDoesntCompressPostRequestBelowThreshold {
+    stubRequest(@"POST", [[NSString alloc] initWithFormat:@"^%@://%@/i?(.*?)", @"https", TEST_URL_ENDPOINT].regex)
+        .withHeader(@"Content-Encoding", @"gzip")
+        .andReturn(500);
+    stubRequest(@"POST", [[NSString alloc] initWithFormat:@"^%@://%@/i?(.*?)", @"https", TEST_URL_ENDPOINT].regex)
+        .andReturn(200);
+    
+    SPDefaultNetworkConnection *connection = [SPDefaultNetworkConnection build:^(id<SPDefaultNetworkConnectionBuilder> builder) {
+        [builder setUrlEndpoint:TEST_URL_ENDPOINT];
+        [builder setHttpMethod:SPHttpMethodPost];
+        [builder setRequestCompression:YES];
+        [builder setCompressionThreshold:10000];
+    }];
+    
+    SPPayload *payload = [SPPayload new];
+    [payload addValueToPayload:@"value" forKey:@"key"];
+    SPRequest *request = [[SPRequest alloc] initWithPayload:payload emitterEventId:1];
+    NSArray<SPRequestResult *> *results = [connection sendRequests:@[request]];
+    
+    // Check successful result
+    SPRequestResult *result = [results objectAtIndex:0];
+    XCTAssertTrue(result.isSuccessful);
+    XCTAssertEqualObjects(@1, result.storeIds[0]);
+}
+
+- (void)testAsyncPostRequestsAggregateResults {
+    stubRequest(@"POST", [[NSString alloc] initWithFormat:@"^%@://%@/i?(.*?)", @"https", TEST_URL_ENDPOINT].regex).andReturn(200);
+    
+    SPDefaultNetworkConnection *connection = [SPDefaultNetworkConnection build:^(id<SPDefaultNetworkConnectionBuilder> builder) {
+        [builder setUrlEndpoint:TEST_URL_ENDPOINT];
+        [builder setHttpMethod:SPHttpMethodPost];
+        [builder setEmitThreadPoolSize:2];
+    }];
+    
+    NSMutableArray<SPRequest *> *requests = [NSMutableArray new];
+    for (int i = 1; i <= 5; i++) {
+        SPPayload *payload = [SPPayload new];
+        [payload addValueToPayload:@"value" forKey:@"key"];
+        [requests addObject:[[SPRequest alloc] initWithPayload:payload emitterEventId:i]];
+    }
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"All requests completed"];
+    [connection sendRequests:requests completion:^(NSArray<SPRequestResult *> *results) {
+        XCTAssertEqual(results.count, 5);
+        for (SPRequestResult *result in results) {
+            XCTAssertTrue(result.isSuccessful);
+        }
+        [expectation fulfill];
+    }];
+    [self waitForExpectationsWithTimeout:10 handler:nil];
+}
+
 @end
@@ -21,6 +21,7 @@
 
 #import <XCTest/XCTest.h>
 #import "SPPayload.h"
+#import "SPUtilities.h"
 
 @interface TestPayload : XCTestCase
 
@@ -304,4 +305,117 @@
                           @"Payload should be initialized to an empty dictionary");
 }
 
+- (void)testByteSizeIsUpdatedAfterMutation {
+    SPPayload *payload = [[SPPayload alloc] initWithNSDictionary:@{@"Key1": @"Value1"}];
+    XCTAssertEqual(17, payload.byteSize); // {"Key1":"Value1"}
+    
+    [payload addValueToPayload:@"Value2" forKey:@"Key2"];
+    XCTAssertEqual(33, payload.byteSize); // {"Key1":"Value1","Key2":"Value2"}
+    
+    [payload addValueToPayload:nil forKey:@"Key2"];
+    XCTAssertEqual(17, payload.byteSize);
+    
+    [payload addNumericValueToPayload:@1 forKey:@"Key3"];
+    XCTAssertEqual(26, payload.byteSize); // {"Key1":"Value1","Key3":1}
+}
+
+- (void)testInitWithJsonData {
+    NSData *data = [@"{\"Key1\":\"Value1\"}" dataUsingEncoding:NSUTF8StringEncoding];
+    SPPayload *payload = [[SPPayload alloc] initWithJsonData:data];
+    
+    XCTAssertEqualObjects(data, [payload jsonData]);
+    XCTAssertEqual(17, payload.byteSize);
+    XCTAssertEqualObjects(@{@"Key1": @"Value1"}, [payload getAsDictionary]);
+}
+
+- (void)testAppendValueToSerializedPayload {
+    NSData *data = [@"{\"Key1\":\"Value1\"}" dataUsingEncoding:NSUTF8StringEncoding];
+    SPPayload *payload = [[SPPayload alloc] initWithJsonData:data];
+    [payload appendValueToPayload:@"123" forNewKey:@"stm"];
+    
+    NSString *json = [[NSString alloc] initWithData:[payload jsonData] encoding:NSUTF8StringEncoding];
+    XCTAssertEqualObjects(@"{\"Key1\":\"Value1\",\"stm\":\"123\"}", json);
+    
+    // Appending the same key again replaces the previous value
+    [payload appendValueToPayload:@"456" forNewKey:@"stm"];
+    NSDictionary *expected = @{@"Key1": @"Value1", @"stm": @"456"};
+    XCTAssertEqualObjects(expected, [payload getAsDictionary]);
+}
+
+- (void)testStringValueOfSerializedPayload {
+    NSData *data = [@"{\"e\":\"se\", \"co\":\"{\\\"a\\\":[1,{\\\"ua\\\":2}]}\",\"nested\":{\"ua\":\"x\"},\"dtm\":\"1650000000000\",\"ua\":\"Mozilla\\/5.0 \\\"iOS\\\"\",\"n\":12}" dataUsingEncoding:NSUTF8StringEncoding];
+    SPPayload *payload = [[SPPayload alloc] initWithJsonData:data];
+    [payload appendValueToPayload:@"123" forNewKey:@"stm"];
+
+    XCTAssertEqualObjects(@"1650000000000", [payload stringValueForKey:@"dtm"]);
+    XCTAssertEqualObjects(@"Mozilla/5.0 \"iOS\"", [payload stringValueForKey:@"ua"]);
+    XCTAssertEqualObjects(@"12", [payload stringValueForKey:@"n"]);
+    XCTAssertEqualObjects(@"123", [payload stringValueForKey:@"stm"]);
+    XCTAssertNil([payload stringValueForKey:@"nested"]);
+    XCTAssertNil([payload stringValueForKey:@"a"]);
+    XCTAssertNil([payload stringValueForKey:@"missing"]);
+    // The stored JSON isn't parsed.
+    XCTAssertNil([payload valueForKey:@"_payload"]);
+
+    [payload getAsDictionary];
+    XCTAssertEqualObjects(@"Mozilla/5.0 \"iOS\"", [payload stringValueForKey:@"ua"]);
+    XCTAssertEqualObjects(@"12", [payload stringValueForKey:@"n"]);
+}
+
+- (void)testIsJsonObjectData {
+    NSArray<NSString *> *valid = @[@"{}", @" {\"a\":\"}\"} ", @"{\"a\":[1,{\"b\":\"\\\"\"}],\"c\":null}"];
+    for (NSString *json in valid) {
+        XCTAssertTrue([SPPayload isJsonObjectData:[json dataUsingEncoding:NSUTF8StringEncoding]], @"%@", json);
+    }
+    NSArray<NSString *> *invalid = @[@"", @"[]", @"{\"a\":\"b}", @"{\"a\":[1}", @"{}{}", @"{\"a\":1}}", @"{\"a\":\"b\"}x"];
+    for (NSString *json in invalid) {
+        XCTAssertFalse([SPPayload isJsonObjectData:[json dataUsingEncoding:NSUTF8StringEncoding]], @"%@", json);
+    }
+}
+
+- (void)testAddTrustedJsonToPayload {
+    NSData *data = [@"{\"Key1\":\"Value1\"}" dataUsingEncoding:NSUTF8StringEncoding];
+    SPPayload *payload = [[SPPayload alloc] init];
+    [payload addTrustedJsonToPayload:data base64Encoded:YES typeWhenEncoded:@"type_enc" typeWhenNotEncoded:@"type_notenc"];
+    XCTAssertEqualObjects(@{@"type_enc": @"eyJLZXkxIjoiVmFsdWUxIn0"}, payload.getAsDictionary);
+}
+
+// MARK: - Performance
+
+- (NSData *)sampleContextsJson {
+    NSMutableArray<NSDictionary *> *entities = [NSMutableArray new];
+    for (int i = 0; i < 10; i++) {
+        [entities addObject:@{@"schema": @"iglu:com.acme/entity/jsonschema/1-0-0",
+                              @"data": @{@"id": [NSUUID UUID].UUIDString, @"index": @(i), @"name": @"some entity name"}}];
+    }
+    return [NSJSONSerialization dataWithJSONObject:@{@"schema": @"iglu:com.snowplowanalytics.snowplow/contexts/jsonschema/1-0-1", @"data": entities} options:0 error:nil];
+}
+
+- (void)testPerformanceOfBase64UrlEncoding {
+    NSData *json = [self sampleContextsJson];
+    [self measureBlock:^{
+        for (int i = 0; i < 10000; i++) {
+            [SPUtilities base64UrlEncodedStringWithData:json];
+        }
+    }];
+}
+
+- (void)testPerformanceOfAddingValidatedJson {
+    NSData *json = [self sampleContextsJson];
+    [self measureBlock:^{
+        for (int i = 0; i < 10000; i++) {
+            [[SPPayload new] addJsonToPayload:json base64Encoded:YES typeWhenEncoded:@"cx" typeWhenNotEncoded:@"co"];
+        }
+    }];
+}
+
+- (void)testPerformanceOfAddingTrustedJson {
+    NSData *json = [self sampleContextsJson];
+    [self measureBlock:^{
+        for (int i = 0; i < 10000; i++) {
+            [[SPPayload new] addTrustedJsonToPayload:json base64Encoded:YES typeWhenEncoded:@"cx" typeWhenNotEncoded:@"co"];
+        }
+    }];
+}
+
 @end
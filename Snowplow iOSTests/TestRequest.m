@@ -25,6 +25,7 @@
 #import "SPEmitter.h"
 #import "SPSubject.h"
 #import "SPPayload.h"
+#import "SPRequest.h"
 #import "SPSelfDescribingJson.h"
 #import "SPRequestCallback.h"
 #import "SPEvent.h"
@@ -173,6 +174,16 @@
 }
 
 
+- (void)testGroupedRequestJsonDataMatchesPayload {
+    SPPayload *payload1 = [[SPPayload alloc] initWithNSDictionary:@{@"e": @"pv", @"url": @"http://a.com"}];
+    SPPayload *payload2 = [[SPPayload alloc] initWithJsonData:[@"{\"e\":\"se\"}" dataUsingEncoding:NSUTF8StringEncoding]];
+    SPRequest *request = [[SPRequest alloc] initWithPayloads:@[payload1, payload2] emitterEventIds:@[@1, @2]];
+    
+    NSDictionary *json = [NSJSONSerialization JSONObjectWithData:request.jsonData options:0 error:nil];
+    XCTAssertEqualObjects([request.payload getAsDictionary], json);
+    XCTAssertEqual(2, [(NSArray *)json[@"data"] count]);
+}
+
 - (void)testRequestSendWithGet {
     SPMockStore *mockStore = [[SPMockStore alloc] init];
     SPTracker * tracker = [self getTrackerWithRequestType:SPHttpMethodGet resultCode:200 eventStore:mockStore];
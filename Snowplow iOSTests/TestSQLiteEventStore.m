@@ -84,7 +84,8 @@
 }
 
 - (void)testSQLiteEventStoreCreateSQLiteFile {
-    [[SPSQLiteEventStore alloc] initWithNamespace:@"aNamespace"];
+    // The database is opened in background, count waits for it.
+    [[[SPSQLiteEventStore alloc] initWithNamespace:@"aNamespace"] count];
     NSString *libraryPath = [NSSearchPathForDirectoriesInDomains(NSLibraryDirectory, NSUserDomainMask, YES) objectAtIndex:0];
     NSString *snowplowDirPath = [libraryPath stringByAppendingPathComponent:@"snowplow"];
     NSString *dbPath = [snowplowDirPath stringByAppendingPathComponent:@"snowplowEvents-aNamespace.sqlite"];
@@ -92,9 +93,9 @@
 }
 
 - (void)testSQLiteEventStoreRemoveFiles {
-    [[SPSQLiteEventStore alloc] initWithNamespace:@"aNamespace1"];
-    [[SPSQLiteEventStore alloc] initWithNamespace:@"aNamespace2"];
-    [[SPSQLiteEventStore alloc] initWithNamespace:@"aNamespace3"];
+    [[[SPSQLiteEventStore alloc] initWithNamespace:@"aNamespace1"] count];
+    [[[SPSQLiteEventStore alloc] initWithNamespace:@"aNamespace2"] count];
+    [[[SPSQLiteEventStore alloc] initWithNamespace:@"aNamespace3"] count];
     NSString *libraryPath = [NSSearchPathForDirectoriesInDomains(NSLibraryDirectory, NSUserDomainMask, YES) objectAtIndex:0];
     NSString *snowplowDirPath = [libraryPath stringByAppendingPathComponent:@"snowplow"];
     [SPSQLiteEventStore removeUnsentEventsExceptForNamespaces:@[@"aNamespace2"]];
@@ -107,7 +108,7 @@
 }
 
 - (void)testSQLiteEventStoreInvalidNamespaceConversion {
-    [[SPSQLiteEventStore alloc] initWithNamespace:@"namespace*.^?1ò2@"];
+    [[[SPSQLiteEventStore alloc] initWithNamespace:@"namespace*.^?1ò2@"] count];
     NSString *libraryPath = [NSSearchPathForDirectoriesInDomains(NSLibraryDirectory, NSUserDomainMask, YES) objectAtIndex:0];
     NSString *snowplowDirPath = [libraryPath stringByAppendingPathComponent:@"snowplow"];
     NSString *dbPath = [snowplowDirPath stringByAppendingPathComponent:@"snowplowEvents-namespace-1-2-.sqlite"];
@@ -132,10 +133,10 @@
     
     // Migrate database when SQLiteEventStore is launched the first time
     eventStore = [[SPSQLiteEventStore alloc] initWithNamespace:@"aNewNamespace"];
+    XCTAssertEqual(1, [eventStore count]);
     newDbPath = [snowplowDirPath stringByAppendingPathComponent:@"snowplowEvents-aNewNamespace.sqlite"];
     XCTAssertFalse([[NSFileManager defaultManager] fileExistsAtPath:oldDbPath]);
     XCTAssertTrue([[NSFileManager defaultManager] fileExistsAtPath:newDbPath]);
-    XCTAssertEqual(1, [eventStore count]);
     for (SPEmitterEvent *event in [eventStore getAllEvents]) {
         XCTAssertEqualObjects(@"value", [[event.payload getAsDictionary] objectForKey:@"key"]);
     }
@@ -145,10 +146,176 @@
     SPSQLiteEventStore *eventStore1 = [[SPSQLiteEventStore alloc] initWithNamespace:@"aNamespace"];
     [eventStore1 addEvent:[[SPPayload alloc] initWithNSDictionary:@{@"key1": @"value1"}]];
     XCTAssertEqual(1, [eventStore1 count]);
+    // Counting doesn't commit the pending events: reading does.
+    XCTAssertEqual(1, [eventStore1 getAllEvents].count);
 
     SPSQLiteEventStore *eventStore2 = [[SPSQLiteEventStore alloc] initWithNamespace:@"aNamespace"];
     [eventStore2 addEvent:[[SPPayload alloc] initWithNSDictionary:@{@"key2": @"value2"}]];
     XCTAssertEqual(2, [eventStore2 count]);
 }
 
+- (void)testEvictionDropsLowestPriorityEventsFirst {
+    SPSQLiteEventStore *eventStore = [[SPSQLiteEventStore alloc] initWithNamespace:@"aNamespace"];
+    [eventStore removeAllEvents];
+    [eventStore setCapacityWithMaxEventCount:10 maxByteSize:0 maxEventAge:0];
+
+    for (int i = 0; i < 11; i++) {
+        SPPayload *payload = [[SPPayload alloc] initWithNSDictionary:@{@"i": @(i).stringValue}];
+        payload.priority = (i % 2) ? 0 : 1;
+        [eventStore insertEvent:payload];
+    }
+
+    // Over capacity it evicts down to the low water mark: the two oldest events with priority 0.
+    XCTAssertEqual(9, [eventStore count]);
+    NSMutableArray<NSString *> *values = [NSMutableArray new];
+    for (SPEmitterEvent *event in [eventStore getAllEvents]) {
+        [values addObject:[[event.payload getAsDictionary] objectForKey:@"i"]];
+    }
+    XCTAssertFalse([values containsObject:@"1"]);
+    XCTAssertFalse([values containsObject:@"3"]);
+    XCTAssertTrue([values containsObject:@"0"]);
+    XCTAssertTrue([values containsObject:@"5"]);
+}
+
+- (void)testEvictionByByteSize {
+    SPSQLiteEventStore *eventStore = [[SPSQLiteEventStore alloc] initWithNamespace:@"aNamespace"];
+    [eventStore removeAllEvents];
+    NSUInteger byteSize = [[SPPayload alloc] initWithNSDictionary:@{@"i": @"00"}].byteSize;
+    [eventStore setCapacityWithMaxEventCount:0 maxByteSize:byteSize * 10 maxEventAge:0];
+
+    for (int i = 0; i < 11; i++) {
+        [eventStore insertEvent:[[SPPayload alloc] initWithNSDictionary:@{@"i": [NSString stringWithFormat:@"%02d", i]}]];
+    }
+    XCTAssertEqual(9, [eventStore count]);
+    XCTAssertEqualObjects(@"02", [[[eventStore getAllEvents].firstObject.payload getAsDictionary] objectForKey:@"i"]);
+
+    // Removed events are taken into account by the capacity.
+    [eventStore removeEventsWithIds:@[@3, @4, @5]];
+    [eventStore insertEvent:[[SPPayload alloc] initWithNSDictionary:@{@"i": @"11"}]];
+    XCTAssertEqual(7, [eventStore count]);
+}
+
+- (void)testConcurrentAddEventsAreGroupCommitted {
+    SPSQLiteEventStore *eventStore = [[SPSQLiteEventStore alloc] initWithNamespace:@"aNamespace"];
+    [eventStore removeAllEvents];
+
+    dispatch_apply(200, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t i) {
+        [eventStore addEvent:[[SPPayload alloc] initWithNSDictionary:@{@"i": @(i).stringValue}]];
+    });
+
+    // Pending events are written before any read.
+    XCTAssertEqual(200, [eventStore count]);
+    NSMutableSet<NSString *> *values = [NSMutableSet new];
+    for (SPEmitterEvent *event in [eventStore getAllEvents]) {
+        [values addObject:[[event.payload getAsDictionary] objectForKey:@"i"]];
+    }
+    XCTAssertEqual(200, values.count);
+}
+
+- (void)testLeasedEventsAreNotReturnedAgain {
+    SPSQLiteEventStore *eventStore = [[SPSQLiteEventStore alloc] initWithNamespace:@"aNamespace"];
+    [eventStore removeAllEvents];
+    for (int i = 0; i < 10; i++) {
+        [eventStore insertEvent:[[SPPayload alloc] initWithNSDictionary:@{@"i": @(i).stringValue}]];
+    }
+
+    NSArray<SPEmitterEvent *> *firstBatch = [eventStore leaseEmittableEventsWithQueryLimit:4 leaseDuration:60];
+    NSArray<SPEmitterEvent *> *secondBatch = [eventStore leaseEmittableEventsWithQueryLimit:4 leaseDuration:60];
+    XCTAssertEqual(4, firstBatch.count);
+    XCTAssertEqual(4, secondBatch.count);
+    XCTAssertEqualObjects(@"0", [[firstBatch.firstObject.payload getAsDictionary] objectForKey:@"i"]);
+    XCTAssertEqualObjects(@"4", [[secondBatch.firstObject.payload getAsDictionary] objectForKey:@"i"]);
+
+    // Released events are returned again, removed ones are gone.
+    [eventStore releaseEventsWithIds:@[@(firstBatch[0].storeId)]];
+    [eventStore removeEventsWithIds:@[@(firstBatch[1].storeId)]];
+    NSArray<SPEmitterEvent *> *thirdBatch = [eventStore leaseEmittableEventsWithQueryLimit:10 leaseDuration:60];
+    XCTAssertEqual(3, thirdBatch.count);
+    XCTAssertEqual(firstBatch[0].storeId, thirdBatch.firstObject.storeId);
+
+    // Expired leases are returned again.
+    [eventStore removeAllEvents];
+    [eventStore insertEvent:[[SPPayload alloc] initWithNSDictionary:@{@"i": @"0"}]];
+    XCTAssertEqual(1, [eventStore leaseEmittableEventsWithQueryLimit:10 leaseDuration:0].count);
+    XCTAssertEqual(1, [eventStore leaseEmittableEventsWithQueryLimit:10 leaseDuration:0].count);
+}
+
+- (void)testCountIsKeptInMemoryAndReconciledWhenOpened {
+    SPSQLiteEventStore *eventStore = [[SPSQLiteEventStore alloc] initWithNamespace:@"aNamespace"];
+    [eventStore removeAllEvents];
+    for (int i = 0; i < 5; i++) {
+        [eventStore insertEvent:[[SPPayload alloc] initWithNSDictionary:@{@"i": @(i).stringValue}]];
+    }
+    [eventStore addEvent:[[SPPayload alloc] initWithNSDictionary:@{@"i": @"5"}]];
+    XCTAssertEqual(6, [eventStore count]);
+    [eventStore removeEventsWithIds:@[@1, @2, @100]];
+    XCTAssertEqual(4, [eventStore count]);
+    XCTAssertEqual(4, [eventStore getAllEvents].count);
+
+    SPSQLiteEventStore *reopenedEventStore = [[SPSQLiteEventStore alloc] initWithNamespace:@"aNamespace"];
+    XCTAssertEqual(4, [reopenedEventStore count]);
+}
+
+- (void)testEventsInDifferentEncodingsAreRead {
+    SPSQLiteEventStore *eventStore = [[SPSQLiteEventStore alloc] initWithNamespace:@"aNamespace"];
+    [eventStore removeAllEvents];
+    [eventStore insertEvent:[[SPPayload alloc] initWithNSDictionary:@{@"e": @"pv", @"i": @"0"}]];
+    eventStore.encoding = SPEventStoreEncodingCompact;
+    [eventStore insertEvent:[[SPPayload alloc] initWithNSDictionary:@{@"e": @"pv", @"i": @"1"}]];
+    eventStore.encoding = SPEventStoreEncodingCompactCompressed;
+    NSString *context = [@"" stringByPaddingToLength:500 withString:@"eyJzY2hlbWEiOiJpZ2x1OmNvbS5zbm93cGxvd2FuYWx5dGljcyJ9" startingAtIndex:0];
+    [eventStore insertEvent:[[SPPayload alloc] initWithNSDictionary:@{@"e": @"pv", @"i": @"2", @"cx": context}]];
+
+    NSArray<SPEmitterEvent *> *events = [eventStore getAllEventsLimited:10];
+    XCTAssertEqual(3, events.count);
+    for (int i = 0; i < 3; i++) {
+        XCTAssertEqualObjects(@(i).stringValue, [[events[i].payload getAsDictionary] objectForKey:@"i"]);
+    }
+    XCTAssertEqualObjects(context, [[events[2].payload getAsDictionary] objectForKey:@"cx"]);
+
+    // Switching back to JSON converts the stored events without losing them.
+    eventStore.encoding = SPEventStoreEncodingJSON;
+    [NSThread sleepForTimeInterval:0.5];
+    XCTAssertEqual(3, [eventStore count]);
+    XCTAssertEqualObjects(context, [[[eventStore getAllEvents].lastObject.payload getAsDictionary] objectForKey:@"cx"]);
+}
+
+- (void)testEventsAddedWhileTheDatabaseOpensAreStored {
+    [[[SPSQLiteEventStore alloc] initWithNamespace:@"aNamespace"] removeAllEvents];
+    SPSQLiteEventStore *eventStore = [[SPSQLiteEventStore alloc] initWithNamespace:@"aNamespace"];
+    [eventStore setCapacityWithMaxEventCount:100 maxByteSize:0 maxEventAge:0];
+    for (int i = 0; i < 5; i++) {
+        [eventStore addEvent:[[SPPayload alloc] initWithNSDictionary:@{@"i": @(i).stringValue}]];
+    }
+    XCTAssertEqual(5, [eventStore count]);
+    XCTAssertEqualObjects(@"0", [[[eventStore getAllEventsLimited:1].firstObject.payload getAsDictionary] objectForKey:@"i"]);
+}
+
+- (void)testEventsAreDeadLetteredAfterMaxAttempts {
+    SPSQLiteEventStore *eventStore = [[SPSQLiteEventStore alloc] initWithNamespace:@"aNamespace"];
+    [eventStore removeAllEvents];
+    [eventStore removeAllDeadLetterEvents];
+    for (int i = 0; i < 3; i++) {
+        [eventStore insertEvent:[[SPPayload alloc] initWithNSDictionary:@{@"i": @(i).stringValue}]];
+    }
+
+    XCTAssertEqual(0, [eventStore recordFailedAttemptForEventsWithIds:@[@1, @2] maxAttempts:0].count);
+    XCTAssertEqual(0, [eventStore recordFailedAttemptForEventsWithIds:@[@1] maxAttempts:3].count);
+    NSArray<NSNumber *> *deadLetterIds = [eventStore recordFailedAttemptForEventsWithIds:@[@1, @2, @3] maxAttempts:3];
+    XCTAssertEqualObjects(@[@1], deadLetterIds);
+    XCTAssertEqual(2, [eventStore count]);
+
+    // Attempts are persisted with the events.
+    SPSQLiteEventStore *reopenedEventStore = [[SPSQLiteEventStore alloc] initWithNamespace:@"aNamespace"];
+    XCTAssertEqualObjects(@[@2], [reopenedEventStore recordFailedAttemptForEventsWithIds:@[@2, @3] maxAttempts:3]);
+    XCTAssertEqual(1, [reopenedEventStore count]);
+
+    NSArray<SPEmitterEvent *> *deadLetterEvents = [reopenedEventStore deadLetterEventsWithQueryLimit:10];
+    XCTAssertEqual(2, deadLetterEvents.count);
+    XCTAssertEqualObjects(@"0", [[deadLetterEvents[0].payload getAsDictionary] objectForKey:@"i"]);
+    XCTAssertEqualObjects(@"1", [[deadLetterEvents[1].payload getAsDictionary] objectForKey:@"i"]);
+    XCTAssertTrue([reopenedEventStore removeAllDeadLetterEvents]);
+    XCTAssertEqual(0, [reopenedEventStore deadLetterEventsWithQueryLimit:10].count);
+}
+
 @end
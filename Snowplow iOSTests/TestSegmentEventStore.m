@@ -0,0 +1,190 @@
+//
+//  TestSegmentEventStore.m
+//  Snowplow
+//
+//  Copyright (c) 2013-2022 Snowplow Analytics Ltd. All rights reserved.
+//
+//  This program is licensed to you under the Apache License Version 2.0,
+//  and you may not use this file except in compliance with the Apache License
+//  Version 2.0. You may obtain a copy of the Apache License Version 2.0 at
+//  http://www.apache.org/licenses/LICENSE-2.0.
+//
+//  Unless required by applicable law or agreed to in writing,
+//  software distributed under the Apache License Version 2.0 is distributed on
+//  an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+//  express or implied. See the Apache License Version 2.0 for the specific
+//  language governing permissions and limitations there under.
+//
+//  License: Apache License Version 2.0
+//
+
+#import <XCTest/XCTest.h>
+#import "SPSegmentEventStore.h"
+#import "SPPayload.h"
+
+@interface TestSegmentEventStore : XCTestCase
+@end
+
+@implementation TestSegmentEventStore
+
+- (void)setUp {
+    [[[SPSegmentEventStore alloc] initWithNamespace:@"aNamespace"] removeAllEvents];
+}
+
+- (void)testInsertAndRemovePayloads {
+    SPSegmentEventStore *eventStore = [[SPSegmentEventStore alloc] initWithNamespace:@"aNamespace"];
+    for (int i = 0; i < 10; i++) {
+        [eventStore addEvent:[[SPPayload alloc] initWithNSDictionary:@{@"i": @(i).stringValue}]];
+    }
+    XCTAssertEqual(10, [eventStore count]);
+
+    NSArray<SPEmitterEvent *> *events = [eventStore emittableEventsWithQueryLimit:4];
+    XCTAssertEqual(4, events.count);
+    XCTAssertEqualObjects(@"0", [[events.firstObject.payload getAsDictionary] objectForKey:@"i"]);
+
+    // Events can be removed out of order.
+    [eventStore removeEventsWithIds:@[@(events[1].storeId), @(events[3].storeId)]];
+    XCTAssertEqual(8, [eventStore count]);
+    events = [eventStore emittableEventsWithQueryLimit:3];
+    NSArray *values = @[[[events[0].payload getAsDictionary] objectForKey:@"i"],
+                        [[events[1].payload getAsDictionary] objectForKey:@"i"],
+                        [[events[2].payload getAsDictionary] objectForKey:@"i"]];
+    XCTAssertEqualObjects((@[@"0", @"2", @"4"]), values);
+
+    [eventStore removeAllEvents];
+    XCTAssertEqual(0, [eventStore count]);
+    XCTAssertEqual(0, [eventStore emittableEventsWithQueryLimit:10].count);
+}
+
+- (void)testEventsArePersistedAcrossInstances {
+    SPSegmentEventStore *eventStore = [[SPSegmentEventStore alloc] initWithNamespace:@"aNamespace" segmentSize:1024];
+    for (int i = 0; i < 100; i++) {
+        [eventStore addEvent:[[SPPayload alloc] initWithNSDictionary:@{@"i": @(i).stringValue}]];
+    }
+    NSArray<SPEmitterEvent *> *events = [eventStore emittableEventsWithQueryLimit:50];
+    NSMutableArray<NSNumber *> *storeIds = [NSMutableArray new];
+    for (SPEmitterEvent *event in events) {
+        [storeIds addObject:@(event.storeId)];
+    }
+    [eventStore removeEventsWithIds:storeIds];
+    [eventStore removeEventWithId:events.lastObject.storeId + 2];
+    eventStore = nil;
+
+    SPSegmentEventStore *reopenedEventStore = [[SPSegmentEventStore alloc] initWithNamespace:@"aNamespace" segmentSize:1024];
+    XCTAssertEqual(49, [reopenedEventStore count]);
+    events = [reopenedEventStore emittableEventsWithQueryLimit:2];
+    XCTAssertEqualObjects(@"50", [[events[0].payload getAsDictionary] objectForKey:@"i"]);
+    XCTAssertEqualObjects(@"52", [[events[1].payload getAsDictionary] objectForKey:@"i"]);
+
+    // The segments with all the events removed are deleted.
+    NSString *libraryPath = [NSSearchPathForDirectoriesInDomains(NSLibraryDirectory, NSUserDomainMask, YES) objectAtIndex:0];
+    NSString *directoryPath = [libraryPath stringByAppendingPathComponent:@"snowplow-segments/aNamespace"];
+    NSUInteger segmentCount = 0;
+    for (NSString *file in [[NSFileManager defaultManager] contentsOfDirectoryAtPath:directoryPath error:nil]) {
+        segmentCount += [file.pathExtension isEqualToString:@"segment"] ? 1 : 0;
+    }
+    XCTAssertLessThan(segmentCount, 4);
+}
+
+- (void)testCorruptEventsAreRemoved {
+    SPSegmentEventStore *eventStore = [[SPSegmentEventStore alloc] initWithNamespace:@"aNamespace"];
+    for (int i = 0; i < 3; i++) {
+        [eventStore addEvent:[[SPPayload alloc] initWithNSDictionary:@{@"i": @(i).stringValue}]];
+    }
+    eventStore = nil;
+    // Damage the payload of the first event as an interrupted write would.
+    NSString *segmentPath = [self segmentPaths].firstObject;
+    NSMutableData *data = [NSMutableData dataWithContentsOfFile:segmentPath];
+    NSData *payload = [@"{\"i\":\"0\"}" dataUsingEncoding:NSUTF8StringEncoding];
+    NSRange range = [data rangeOfData:payload options:0 range:NSMakeRange(0, data.length)];
+    XCTAssertNotEqual(NSNotFound, range.location);
+    [data replaceBytesInRange:NSMakeRange(NSMaxRange(range) - 1, 1) withBytes:" "];
+    [data writeToFile:segmentPath atomically:NO];
+
+    eventStore = [[SPSegmentEventStore alloc] initWithNamespace:@"aNamespace"];
+    XCTAssertEqual(3, [eventStore count]);
+    NSArray<SPEmitterEvent *> *events = [eventStore emittableEventsWithQueryLimit:10];
+    XCTAssertEqual(2, events.count);
+    XCTAssertEqual(2, [eventStore count]);
+    [eventStore removeEventsWithIds:@[@(events[0].storeId), @(events[1].storeId)]];
+    XCTAssertEqual(0, [eventStore count]);
+}
+
+- (void)testDeletedSegmentsAreNotCounted {
+    SPSegmentEventStore *eventStore = [[SPSegmentEventStore alloc] initWithNamespace:@"aNamespace" segmentSize:1024];
+    for (int i = 0; i < 100; i++) {
+        [eventStore addEvent:[[SPPayload alloc] initWithNSDictionary:@{@"i": @(i).stringValue}]];
+    }
+    eventStore = nil;
+    NSArray<NSString *> *segmentPaths = [self segmentPaths];
+    XCTAssertGreaterThan(segmentPaths.count, 2);
+    [[NSFileManager defaultManager] removeItemAtPath:segmentPaths[1] error:nil];
+
+    eventStore = [[SPSegmentEventStore alloc] initWithNamespace:@"aNamespace" segmentSize:1024];
+    NSArray<SPEmitterEvent *> *events = [eventStore emittableEventsWithQueryLimit:100];
+    XCTAssertLessThan(events.count, 100);
+    XCTAssertEqual(events.count, [eventStore count]);
+    NSMutableArray<NSNumber *> *storeIds = [NSMutableArray new];
+    for (SPEmitterEvent *event in events) {
+        [storeIds addObject:@(event.storeId)];
+    }
+    [eventStore removeEventsWithIds:storeIds];
+    XCTAssertEqual(0, [eventStore count]);
+}
+
+- (void)testEvictionDropsOldestEvents {
+    SPSegmentEventStore *eventStore = [[SPSegmentEventStore alloc] initWithNamespace:@"aNamespace"];
+    [eventStore setCapacityWithMaxEventCount:10 maxByteSize:0 maxEventAge:0];
+    for (int i = 0; i < 11; i++) {
+        [eventStore addEvent:[[SPPayload alloc] initWithNSDictionary:@{@"i": @(i).stringValue}]];
+    }
+    XCTAssertEqual(9, [eventStore count]);
+    XCTAssertEqualObjects(@"2", [[[eventStore emittableEventsWithQueryLimit:1].firstObject.payload getAsDictionary] objectForKey:@"i"]);
+}
+
+- (void)testEvictionDropsLowestPriorityEventsFirst {
+    SPSegmentEventStore *eventStore = [[SPSegmentEventStore alloc] initWithNamespace:@"aNamespace"];
+    for (int i = 0; i < 10; i++) {
+        SPPayload *payload = [[SPPayload alloc] initWithNSDictionary:@{@"i": @(i).stringValue}];
+        payload.priority = i % 2 ? 1 : 0;
+        [eventStore addEvent:payload];
+    }
+    // The priorities are persisted with the events.
+    eventStore = [[SPSegmentEventStore alloc] initWithNamespace:@"aNamespace"];
+    [eventStore setCapacityWithMaxEventCount:6 maxByteSize:0 maxEventAge:0];
+
+    NSArray<SPEmitterEvent *> *events = [eventStore emittableEventsWithQueryLimit:10];
+    XCTAssertEqual(5, events.count);
+    for (SPEmitterEvent *event in events) {
+        XCTAssertEqual(1, [[[event.payload getAsDictionary] objectForKey:@"i"] integerValue] % 2);
+    }
+}
+
+- (void)testExpiredEventsAreRemoved {
+    SPSegmentEventStore *eventStore = [[SPSegmentEventStore alloc] initWithNamespace:@"aNamespace"];
+    for (int i = 0; i < 3; i++) {
+        [eventStore addEvent:[[SPPayload alloc] initWithNSDictionary:@{@"i": @(i).stringValue}]];
+    }
+    [NSThread sleepForTimeInterval:1];
+    [eventStore addEvent:[[SPPayload alloc] initWithNSDictionary:@{@"i": @"recent"}]];
+
+    [eventStore setCapacityWithMaxEventCount:0 maxByteSize:0 maxEventAge:0.5];
+    XCTAssertEqual(1, [eventStore count]);
+    XCTAssertEqualObjects(@"recent", [[[eventStore emittableEventsWithQueryLimit:10].firstObject.payload getAsDictionary] objectForKey:@"i"]);
+}
+
+// MARK: - Service methods
+
+- (NSArray<NSString *> *)segmentPaths {
+    NSString *libraryPath = [NSSearchPathForDirectoriesInDomains(NSLibraryDirectory, NSUserDomainMask, YES) objectAtIndex:0];
+    NSString *directoryPath = [libraryPath stringByAppendingPathComponent:@"snowplow-segments/aNamespace"];
+    NSMutableArray<NSString *> *paths = [NSMutableArray new];
+    for (NSString *file in [[[NSFileManager defaultManager] contentsOfDirectoryAtPath:directoryPath error:nil] sortedArrayUsingSelector:@selector(compare:)]) {
+        if ([file.pathExtension isEqualToString:@"segment"]) {
+            [paths addObject:[directoryPath stringByAppendingPathComponent:file]];
+        }
+    }
+    return paths;
+}
+
+@end
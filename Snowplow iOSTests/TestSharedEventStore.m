@@ -0,0 +1,98 @@
+//
+//  TestSharedEventStore.m
+//  Snowplow
+//
+//  Copyright (c) 2013-2022 Snowplow Analytics Ltd. All rights reserved.
+//
+//  This program is licensed to you under the Apache License Version 2.0,
+//  and you may not use this file except in compliance with the Apache License
+//  Version 2.0. You may obtain a copy of the Apache License Version 2.0 at
+//  http://www.apache.org/licenses/LICENSE-2.0.
+//
+//  Unless required by applicable law or agreed to in writing,
+//  software distributed under the Apache License Version 2.0 is distributed on
+//  an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+//  express or implied. See the Apache License Version 2.0 for the specific
+//  language governing permissions and limitations there under.
+//
+//  License: Apache License Version 2.0
+//
+
+#import <XCTest/XCTest.h>
+#import "SPSharedEventStore.h"
+#import "SPPayload.h"
+
+/// Methods of the private database shared by the stores.
+@protocol SPSharedEventDatabaseTesting
+- (void)addEventData:(NSArray<NSData *> *)dataArray priorities:(NSArray<NSNumber *> *)priorities namespace:(NSString *)namespace;
+@end
+
+@interface TestSharedEventStore : XCTestCase
+@end
+
+@implementation TestSharedEventStore
+
+- (void)setUp {
+    [[[SPSharedEventStore alloc] initWithNamespace:@"aNamespace1"] removeAllEvents];
+    [[[SPSharedEventStore alloc] initWithNamespace:@"aNamespace2"] removeAllEvents];
+}
+
+- (void)testNamespacesAreIsolated {
+    SPSharedEventStore *eventStore1 = [[SPSharedEventStore alloc] initWithNamespace:@"aNamespace1"];
+    SPSharedEventStore *eventStore2 = [[SPSharedEventStore alloc] initWithNamespace:@"aNamespace2"];
+    for (int i = 0; i < 5; i++) {
+        [eventStore1 addEvent:[[SPPayload alloc] initWithNSDictionary:@{@"ns": @"1", @"i": @(i).stringValue}]];
+        [eventStore2 addEvent:[[SPPayload alloc] initWithNSDictionary:@{@"ns": @"2", @"i": @(i).stringValue}]];
+    }
+    XCTAssertEqual(5, [eventStore1 count]);
+    XCTAssertEqual(5, [eventStore2 count]);
+
+    NSArray<SPEmitterEvent *> *events = [eventStore1 emittableEventsWithQueryLimit:10];
+    XCTAssertEqual(5, events.count);
+    NSMutableArray<NSNumber *> *storeIds = [NSMutableArray new];
+    for (SPEmitterEvent *event in events) {
+        XCTAssertEqualObjects(@"1", [[event.payload getAsDictionary] objectForKey:@"ns"]);
+        [storeIds addObject:@(event.storeId)];
+    }
+
+    // The identifiers of another namespace don't remove its events.
+    [eventStore2 removeEventsWithIds:storeIds];
+    XCTAssertEqual(5, [eventStore2 count]);
+    [eventStore1 removeEventsWithIds:storeIds];
+    XCTAssertEqual(0, [eventStore1 count]);
+
+    [eventStore2 removeAllEvents];
+    XCTAssertEqual(0, [eventStore2 count]);
+}
+
+- (void)testCapacityIsPerNamespace {
+    SPSharedEventStore *eventStore1 = [[SPSharedEventStore alloc] initWithNamespace:@"aNamespace1"];
+    SPSharedEventStore *eventStore2 = [[SPSharedEventStore alloc] initWithNamespace:@"aNamespace2"];
+    [eventStore1 setCapacityWithMaxEventCount:10 maxByteSize:0 maxEventAge:0];
+    for (int i = 0; i < 11; i++) {
+        [eventStore1 addEvent:[[SPPayload alloc] initWithNSDictionary:@{@"i": @(i).stringValue}]];
+        [eventStore2 addEvent:[[SPPayload alloc] initWithNSDictionary:@{@"i": @(i).stringValue}]];
+    }
+    // Reading commits the pending events, evicting the oldest of the capped namespace.
+    NSArray<SPEmitterEvent *> *events = [eventStore1 emittableEventsWithQueryLimit:20];
+    XCTAssertEqual(9, events.count);
+    XCTAssertEqualObjects(@"2", [[events.firstObject.payload getAsDictionary] objectForKey:@"i"]);
+    XCTAssertEqual(11, [eventStore2 emittableEventsWithQueryLimit:20].count);
+}
+
+- (void)testCorruptEventsAreRemoved {
+    SPSharedEventStore *eventStore = [[SPSharedEventStore alloc] initWithNamespace:@"aNamespace1"];
+    [eventStore addEvent:[[SPPayload alloc] initWithNSDictionary:@{@"i": @"0"}]];
+    // Rows truncated or written by an older version bypass the validation of addEvent:.
+    id<SPSharedEventDatabaseTesting> database = [eventStore valueForKey:@"database"];
+    [database addEventData:@[[@"{\"i\":\"1\"" dataUsingEncoding:NSUTF8StringEncoding]] priorities:@[@0] namespace:@"aNamespace1"];
+    XCTAssertEqual(2, [eventStore count]);
+
+    NSArray<SPEmitterEvent *> *events = [eventStore emittableEventsWithQueryLimit:10];
+    XCTAssertEqual(1, events.count);
+    XCTAssertEqual(1, [eventStore count]);
+    [eventStore removeEventWithId:events.firstObject.storeId];
+    XCTAssertEqual(0, [eventStore count]);
+}
+
+@end
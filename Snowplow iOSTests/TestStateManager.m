@@ -22,6 +22,12 @@
 #import <XCTest/XCTest.h>
 #import "SPStateManager.h"
 #import "SPTrackerEvent.h"
+#import "SPStateFuture.h"
+#import "SPForeground.h"
+#import "SPDeepLinkReceived.h"
+#import "SPDeepLinkState.h"
+#import "SPDeepLinkStateMachine.h"
+#import "SPTrackerConstants.h"
 
 // MARK: - MockState
 
@@ -92,6 +98,19 @@
 @implementation MockStateMachine2
 @end
 
+@interface CountingStateMachine : MockStateMachine
+@property (atomic) NSInteger transitionCount;
+@end
+@implementation CountingStateMachine
+- (NSArray<NSString *> *)subscribedEventSchemasForTransitions {
+    return @[kSPForegroundSchema];
+}
+- (id<SPState>)transitionFromEvent:(SPEvent *)event state:(id<SPState>)currentState {
+    self.transitionCount++;
+    return [[MockState alloc] initWithValue:((SPForeground *)event).index.integerValue];
+}
+@end
+
 // MARK: - Test
 
 @interface TestStateManager : XCTestCase
@@ -204,4 +223,48 @@
     XCTAssertEqual(0, [(MockState *)[trackerState2 stateWithIdentifier:@"identifier"] value]);
 }
 
+- (void)testStateIsComputedWhenObserved {
+    SPStateManager *stateManager = [SPStateManager new];
+    CountingStateMachine *stateMachine = [CountingStateMachine new];
+    [stateManager addOrReplaceStateMachine:stateMachine identifier:@"identifier"];
+
+    id<SPTrackerStateSnapshot> trackerState;
+    for (int i = 1; i <= 3; i++) {
+        trackerState = [stateManager trackerStateForProcessedEvent:[[SPForeground alloc] initWithIndex:@(i)]];
+    }
+    XCTAssertEqual(0, stateMachine.transitionCount);
+
+    XCTAssertEqual(3, [(MockState *)[trackerState stateWithIdentifier:@"identifier"] value]);
+    XCTAssertEqual(3, stateMachine.transitionCount);
+    [trackerState stateWithIdentifier:@"identifier"];
+    XCTAssertEqual(3, stateMachine.transitionCount);
+}
+
+- (void)testStateFutureChainIsBounded {
+    SPStateManager *stateManager = [SPStateManager new];
+    CountingStateMachine *stateMachine = [CountingStateMachine new];
+    [stateManager addOrReplaceStateMachine:stateMachine identifier:@"identifier"];
+
+    id<SPTrackerStateSnapshot> trackerState;
+    for (NSUInteger i = 1; i <= kSPStateFutureMaxChainLength + 5; i++) {
+        trackerState = [stateManager trackerStateForProcessedEvent:[[SPForeground alloc] initWithIndex:@(i)]];
+    }
+    XCTAssertEqual((NSInteger)kSPStateFutureMaxChainLength, stateMachine.transitionCount);
+
+    XCTAssertEqual((NSInteger)kSPStateFutureMaxChainLength + 5, [(MockState *)[trackerState stateWithIdentifier:@"identifier"] value]);
+    XCTAssertEqual((NSInteger)kSPStateFutureMaxChainLength + 5, stateMachine.transitionCount);
+}
+
+- (void)testEventChangedAfterTrackingDoesntAffectState {
+    SPStateManager *stateManager = [SPStateManager new];
+    [stateManager addOrReplaceStateMachine:[SPDeepLinkStateMachine new] identifier:@"identifier"];
+
+    SPDeepLinkReceived *event = [[[SPDeepLinkReceived alloc] initWithUrl:@"https://url.com"] referrer:@"https://referrer.com"];
+    id<SPTrackerStateSnapshot> trackerState = [stateManager trackerStateForProcessedEvent:event];
+    event.referrer = @"https://changed.com";
+
+    SPDeepLinkState *state = (SPDeepLinkState *)[trackerState stateWithIdentifier:@"identifier"];
+    XCTAssertEqualObjects(@"https://referrer.com", state.referrer);
+}
+
 @end
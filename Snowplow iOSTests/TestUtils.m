@@ -22,7 +22,9 @@
 #import <XCTest/XCTest.h>
 #import <AdSupport/AdSupport.h>
 #import "SPUtilities.h"
+#import "SPGzipSizeEstimator.h"
 #import "SPTrackerConstants.h"
+#import <zlib.h>
 
 @interface TestUtils : XCTestCase
 
@@ -158,4 +160,70 @@
     XCTAssertEqual(result.count, 1);
 }
 
+- (void)testGzipCompressData {
+    NSMutableString *json = [NSMutableString stringWithString:@"["];
+    for (int i = 0; i < 100; i++) {
+        [json appendFormat:@"{\"e\":\"pv\",\"url\":\"http://acme.com/%d\"},", i];
+    }
+    [json appendString:@"{}]"];
+    NSData *data = [json dataUsingEncoding:NSUTF8StringEncoding];
+    NSData *compressed = [SPUtilities gzipCompressData:data];
+    XCTAssertNotNil(compressed);
+    XCTAssertLessThan(compressed.length, data.length);
+
+    // gzip magic number
+    const uint8_t *bytes = compressed.bytes;
+    XCTAssertEqual(bytes[0], 0x1f);
+    XCTAssertEqual(bytes[1], 0x8b);
+
+    // Round trip
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    XCTAssertEqual(inflateInit2(&stream, 15 + 16), Z_OK);
+    NSMutableData *decompressed = [NSMutableData dataWithLength:data.length];
+    stream.next_in = (Bytef *)compressed.bytes;
+    stream.avail_in = (uInt)compressed.length;
+    stream.next_out = (Bytef *)decompressed.mutableBytes;
+    stream.avail_out = (uInt)decompressed.length;
+    XCTAssertEqual(inflate(&stream, Z_FINISH), Z_STREAM_END);
+    inflateEnd(&stream);
+    XCTAssertEqualObjects(decompressed, data);
+
+    XCTAssertNil([SPUtilities gzipCompressData:[NSData data]]);
+}
+
+- (void)testGzipSizeEstimator {
+    SPGzipSizeEstimator *estimator = [SPGzipSizeEstimator new];
+    NSMutableData *data = [NSMutableData new];
+    for (int i = 0; i < 100; i++) {
+        NSData *piece = [[NSString stringWithFormat:@"{\"e\":\"pv\",\"url\":\"http://acme.com/%d\"},", i] dataUsingEncoding:NSUTF8StringEncoding];
+        XCTAssertTrue([estimator appendData:piece]);
+        [data appendData:piece];
+    }
+    XCTAssertEqual(data.length, estimator.uncompressedSize);
+
+    // The flushes make the estimate larger than the data compressed in one go, so batches stay under the limit.
+    XCTAssertGreaterThanOrEqual(estimator.compressedSize, [SPUtilities gzipCompressData:data].length);
+    XCTAssertLessThan(estimator.compressedSize, data.length);
+}
+
+- (void)testBase64UrlEncodedString {
+    XCTAssertEqualObjects(@"", [SPUtilities base64UrlEncodedStringWithData:[NSData data]]);
+    XCTAssertEqualObjects(@"eyJLZXkxIjoiVmFsdWUxIn0", [SPUtilities base64UrlEncodedStringWithData:[@"{\"Key1\":\"Value1\"}" dataUsingEncoding:NSUTF8StringEncoding]]);
+
+    // Same as the standard encoding with the URL-safe alphabet and no padding, for every remainder length
+    for (NSUInteger length = 1; length < 100; length++) {
+        NSMutableData *data = [NSMutableData dataWithLength:length];
+        uint8_t *bytes = data.mutableBytes;
+        for (NSUInteger i = 0; i < length; i++) {
+            bytes[i] = (uint8_t)(i * 37 + length * 11);
+        }
+        NSString *expected = [[[[data base64EncodedStringWithOptions:0]
+                                stringByReplacingOccurrencesOfString:@"/" withString:@"_"]
+                               stringByReplacingOccurrencesOfString:@"+" withString:@"-"]
+                              stringByTrimmingCharactersInSet:[NSCharacterSet characterSetWithCharactersInString:@"="]];
+        XCTAssertEqualObjects(expected, [SPUtilities base64UrlEncodedStringWithData:data]);
+    }
+}
+
 @end
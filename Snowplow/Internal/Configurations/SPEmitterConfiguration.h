@@ -46,6 +46,25 @@ typedef NS_ENUM(NSUInteger, SPBufferOption) {
     SPBufferOptionHeavyGroup __deprecated_enum_msg("Use BufferOption.largeGroup instead.") = SPBufferOptionLargeGroup
 } NS_SWIFT_NAME(BufferOption);
 
+/*!
+ @brief An enum for the events evicted first when the event store is over capacity.
+ */
+typedef NS_ENUM(NSUInteger, SPEvictionPolicy) {
+    /**
+     * Evicts the oldest events.
+     */
+    SPEvictionPolicyDropOldest = 0,
+    /**
+     * Evicts the events with the lowest priority set in `eventPriorities`, oldest first.
+     * Events not listed have priority 0.
+     */
+    SPEvictionPolicyDropLowestPriority,
+    /**
+     * Evicts the events listed in `evictableEvents` before any other event, oldest first.
+     */
+    SPEvictionPolicyDropBySchema,
+} NS_SWIFT_NAME(EvictionPolicy);
+
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -86,6 +105,76 @@ NS_SWIFT_NAME(EmitterConfigurationProtocol)
  * Whether to anonymise server-side user identifiers including the `network_userid` and `user_ipaddress`
  */
 @property () BOOL serverAnonymisation;
+/**
+ * Whether to gzip the body of POST requests sent to the collector.
+ * When enabled, `byteLimitPost` is applied to the compressed size of the request.
+ */
+@property () BOOL requestCompression;
+/**
+ * Minimum size in bytes of a POST body before it gets compressed.
+ * Smaller requests are sent uncompressed as the gzip overhead isn't worth it.
+ */
+@property () NSInteger compressionThreshold;
+/**
+ * Maximum time in seconds a tracked event waits for other events before the emitter sends them together.
+ * With 0 (default) every tracked event triggers sending straight away.
+ */
+@property () NSTimeInterval batchingDelay;
+/**
+ * Number of events waiting to be sent that triggers sending before the `batchingDelay` has elapsed.
+ */
+@property () NSInteger batchingEventCount;
+/**
+ * Size in bytes of the events waiting to be sent that triggers sending before the `batchingDelay` has elapsed.
+ */
+@property () NSInteger batchingByteSize;
+/**
+ * Schemas (for self-describing events) or event names (for primitive events, e.g. `pv`, `se`)
+ * of the events that are sent as soon as they are tracked, regardless of `batchingDelay`.
+ */
+@property (nonatomic, nullable) NSArray<NSString *> *immediateFlushEvents;
+/**
+ * Maximum number of events kept in the event store while they can't be sent.
+ * With 0 (default) the number of events is not limited.
+ */
+@property () NSInteger maxStoredEvents;
+/**
+ * Maximum size in bytes of the events kept in the event store while they can't be sent.
+ * With 0 (default) the size is not limited.
+ */
+@property () NSInteger maxStoredBytes;
+/**
+ * Maximum time in seconds an event is kept in the event store while it can't be sent.
+ * With 0 (default) the events don't expire.
+ */
+@property () NSTimeInterval maxEventAge;
+/**
+ * Which events are evicted first when the event store is over `maxStoredEvents` or `maxStoredBytes`.
+ * By default, the oldest events are evicted.
+ */
+@property () SPEvictionPolicy evictionPolicy;
+/**
+ * Priorities of the events used by `SPEvictionPolicyDropLowestPriority`, keyed by schema
+ * (for self-describing events) or event name (for primitive events, e.g. `pv`, `se`).
+ */
+@property (nonatomic, nullable) NSDictionary<NSString *, NSNumber *> *eventPriorities;
+/**
+ * Schemas or event names of the events evicted first by `SPEvictionPolicyDropBySchema`.
+ */
+@property (nonatomic, nullable) NSArray<NSString *> *evictableEvents;
+/**
+ * Maximum number of times the emitter tries to send an event that keeps failing with a retriable error.
+ * Once reached, the event is moved to the dead-letter events of the store (if supported) and not sent again.
+ * With 0 (default) the events are retried until they are sent or evicted.
+ */
+@property () NSInteger maxSendAttempts;
+/**
+ * Whether a batch of events rejected by the collector is split in two halves that are sent again,
+ * narrowing down to the events causing the failure so that the other events of the batch get through.
+ * The isolated events that can't be retried are moved to the dead-letter events of the store (if supported)
+ * instead of being dropped. Disabled by default.
+ */
+@property () BOOL bisectFailedBatches;
 
 @end
 
@@ -112,6 +201,17 @@ NS_SWIFT_NAME(EmitterConfiguration)
  *         byteLimitGet = 40000;
  *         byteLimitPost = 40000;
  *         serverAnonymisation = false;
+ *         requestCompression = false;
+ *         compressionThreshold = 1024;
+ *         batchingDelay = 0;
+ *         batchingEventCount = 10;
+ *         batchingByteSize = 20000;
+ *         maxStoredEvents = 0;
+ *         maxStoredBytes = 0;
+ *         maxEventAge = 0;
+ *         evictionPolicy = EvictionPolicy.dropOldest;
+ *         maxSendAttempts = 0;
+ *         bisectFailedBatches = false;
  */
 - (instancetype)init;
 
@@ -155,6 +255,64 @@ SP_BUILDER_DECLARE_NULLABLE(NSDictionary *, customRetryForStatusCodes)
  * Whether to anonymise server-side user identifiers including the `network_userid` and `user_ipaddress`
  */
 SP_BUILDER_DECLARE(BOOL, serverAnonymisation)
+/**
+ * Whether to gzip the body of POST requests sent to the collector.
+ * When enabled, `byteLimitPost` is applied to the compressed size of the request.
+ */
+SP_BUILDER_DECLARE(BOOL, requestCompression)
+/**
+ * Minimum size in bytes of a POST body before it gets compressed.
+ */
+SP_BUILDER_DECLARE(NSInteger, compressionThreshold)
+/**
+ * Maximum time in seconds a tracked event waits for other events before the emitter sends them together.
+ * With 0 (default) every tracked event triggers sending straight away.
+ */
+SP_BUILDER_DECLARE(NSTimeInterval, batchingDelay)
+/**
+ * Number of events waiting to be sent that triggers sending before the `batchingDelay` has elapsed.
+ */
+SP_BUILDER_DECLARE(NSInteger, batchingEventCount)
+/**
+ * Size in bytes of the events waiting to be sent that triggers sending before the `batchingDelay` has elapsed.
+ */
+SP_BUILDER_DECLARE(NSInteger, batchingByteSize)
+/**
+ * Schemas or event names of the events that are sent as soon as they are tracked.
+ */
+SP_BUILDER_DECLARE_NULLABLE(NSArray<NSString *> *, immediateFlushEvents)
+/**
+ * Maximum number of events kept in the event store, 0 for no limit.
+ */
+SP_BUILDER_DECLARE(NSInteger, maxStoredEvents)
+/**
+ * Maximum size in bytes of the events kept in the event store, 0 for no limit.
+ */
+SP_BUILDER_DECLARE(NSInteger, maxStoredBytes)
+/**
+ * Maximum time in seconds an event is kept in the event store, 0 for no limit.
+ */
+SP_BUILDER_DECLARE(NSTimeInterval, maxEventAge)
+/**
+ * Which events are evicted first when the event store is over capacity.
+ */
+SP_BUILDER_DECLARE(SPEvictionPolicy, evictionPolicy)
+/**
+ * Priorities of the events, keyed by schema or event name, used by `SPEvictionPolicyDropLowestPriority`.
+ */
+SP_BUILDER_DECLARE_NULLABLE(NSDictionary<NSString *, NSNumber *> *, eventPriorities)
+/**
+ * Schemas or event names of the events evicted first by `SPEvictionPolicyDropBySchema`.
+ */
+SP_BUILDER_DECLARE_NULLABLE(NSArray<NSString *> *, evictableEvents)
+/**
+ * Maximum number of times an event is sent before it's dead-lettered, 0 for no limit.
+ */
+SP_BUILDER_DECLARE(NSInteger, maxSendAttempts)
+/**
+ * Whether failed batches are split to isolate the events causing the failure.
+ */
+SP_BUILDER_DECLARE(BOOL, bisectFailedBatches)
 
 @end
 
@@ -31,6 +31,20 @@
 @synthesize requestCallback;
 @synthesize customRetryForStatusCodes;
 @synthesize serverAnonymisation;
+@synthesize requestCompression;
+@synthesize compressionThreshold;
+@synthesize batchingDelay;
+@synthesize batchingEventCount;
+@synthesize batchingByteSize;
+@synthesize immediateFlushEvents;
+@synthesize maxStoredEvents;
+@synthesize maxStoredBytes;
+@synthesize maxEventAge;
+@synthesize evictionPolicy;
+@synthesize eventPriorities;
+@synthesize evictableEvents;
+@synthesize maxSendAttempts;
+@synthesize bisectFailedBatches;
 
 - (instancetype)init {
     if (self = [super init]) {
@@ -42,6 +56,20 @@
         self.eventStore = nil;
         self.requestCallback = nil;
         self.serverAnonymisation = NO;
+        self.requestCompression = NO;
+        self.compressionThreshold = 1024;
+        self.batchingDelay = 0;
+        self.batchingEventCount = 10;
+        self.batchingByteSize = 20000;
+        self.immediateFlushEvents = nil;
+        self.maxStoredEvents = 0;
+        self.maxStoredBytes = 0;
+        self.maxEventAge = 0;
+        self.evictionPolicy = SPEvictionPolicyDropOldest;
+        self.eventPriorities = nil;
+        self.evictableEvents = nil;
+        self.maxSendAttempts = 0;
+        self.bisectFailedBatches = NO;
     }
     return self;
 }
@@ -56,6 +84,20 @@ SP_BUILDER_METHOD(NSInteger, byteLimitPost)
 SP_BUILDER_METHOD(id<SPRequestCallback>, requestCallback)
 SP_BUILDER_METHOD(NSDictionary *, customRetryForStatusCodes)
 SP_BUILDER_METHOD(BOOL, serverAnonymisation)
+SP_BUILDER_METHOD(BOOL, requestCompression)
+SP_BUILDER_METHOD(NSInteger, compressionThreshold)
+SP_BUILDER_METHOD(NSTimeInterval, batchingDelay)
+SP_BUILDER_METHOD(NSInteger, batchingEventCount)
+SP_BUILDER_METHOD(NSInteger, batchingByteSize)
+SP_BUILDER_METHOD(NSArray *, immediateFlushEvents)
+SP_BUILDER_METHOD(NSInteger, maxStoredEvents)
+SP_BUILDER_METHOD(NSInteger, maxStoredBytes)
+SP_BUILDER_METHOD(NSTimeInterval, maxEventAge)
+SP_BUILDER_METHOD(SPEvictionPolicy, evictionPolicy)
+SP_BUILDER_METHOD(NSDictionary *, eventPriorities)
+SP_BUILDER_METHOD(NSArray *, evictableEvents)
+SP_BUILDER_METHOD(NSInteger, maxSendAttempts)
+SP_BUILDER_METHOD(BOOL, bisectFailedBatches)
 
 SP_BUILDER_METHOD(id<SPEventStore>, eventStore)
 
@@ -72,6 +114,20 @@ SP_BUILDER_METHOD(id<SPEventStore>, eventStore)
     copy.eventStore = self.eventStore;
     copy.customRetryForStatusCodes = self.customRetryForStatusCodes;
     copy.serverAnonymisation = self.serverAnonymisation;
+    copy.requestCompression = self.requestCompression;
+    copy.compressionThreshold = self.compressionThreshold;
+    copy.batchingDelay = self.batchingDelay;
+    copy.batchingEventCount = self.batchingEventCount;
+    copy.batchingByteSize = self.batchingByteSize;
+    copy.immediateFlushEvents = self.immediateFlushEvents;
+    copy.maxStoredEvents = self.maxStoredEvents;
+    copy.maxStoredBytes = self.maxStoredBytes;
+    copy.maxEventAge = self.maxEventAge;
+    copy.evictionPolicy = self.evictionPolicy;
+    copy.eventPriorities = self.eventPriorities;
+    copy.evictableEvents = self.evictableEvents;
+    copy.maxSendAttempts = self.maxSendAttempts;
+    copy.bisectFailedBatches = self.bisectFailedBatches;
     return copy;
 }
 
@@ -89,6 +145,20 @@ SP_BUILDER_METHOD(id<SPEventStore>, eventStore)
     [coder encodeInteger:self.byteLimitPost forKey:SP_STR_PROP(byteLimitPost)];
     [coder encodeObject:self.customRetryForStatusCodes forKey:SP_STR_PROP(customRetryForStatusCodes)];
     [coder encodeBool:self.serverAnonymisation forKey:SP_STR_PROP(serverAnonymisation)];
+    [coder encodeBool:self.requestCompression forKey:SP_STR_PROP(requestCompression)];
+    [coder encodeInteger:self.compressionThreshold forKey:SP_STR_PROP(compressionThreshold)];
+    [coder encodeDouble:self.batchingDelay forKey:SP_STR_PROP(batchingDelay)];
+    [coder encodeInteger:self.batchingEventCount forKey:SP_STR_PROP(batchingEventCount)];
+    [coder encodeInteger:self.batchingByteSize forKey:SP_STR_PROP(batchingByteSize)];
+    [coder encodeObject:self.immediateFlushEvents forKey:SP_STR_PROP(immediateFlushEvents)];
+    [coder encodeInteger:self.maxStoredEvents forKey:SP_STR_PROP(maxStoredEvents)];
+    [coder encodeInteger:self.maxStoredBytes forKey:SP_STR_PROP(maxStoredBytes)];
+    [coder encodeDouble:self.maxEventAge forKey:SP_STR_PROP(maxEventAge)];
+    [coder encodeInteger:self.evictionPolicy forKey:SP_STR_PROP(evictionPolicy)];
+    [coder encodeObject:self.eventPriorities forKey:SP_STR_PROP(eventPriorities)];
+    [coder encodeObject:self.evictableEvents forKey:SP_STR_PROP(evictableEvents)];
+    [coder encodeInteger:self.maxSendAttempts forKey:SP_STR_PROP(maxSendAttempts)];
+    [coder encodeBool:self.bisectFailedBatches forKey:SP_STR_PROP(bisectFailedBatches)];
 }
 
 - (nullable instancetype)initWithCoder:(nonnull NSCoder *)coder {
@@ -100,6 +170,20 @@ SP_BUILDER_METHOD(id<SPEventStore>, eventStore)
         self.byteLimitPost = [coder decodeIntegerForKey:SP_STR_PROP(byteLimitPost)];
         self.customRetryForStatusCodes = [coder decodeObjectForKey:SP_STR_PROP(customRetryForStatusCodes)];
         self.serverAnonymisation = [coder decodeBoolForKey:SP_STR_PROP(serverAnonymisation)];
+        self.requestCompression = [coder decodeBoolForKey:SP_STR_PROP(requestCompression)];
+        self.compressionThreshold = [coder decodeIntegerForKey:SP_STR_PROP(compressionThreshold)];
+        self.batchingDelay = [coder decodeDoubleForKey:SP_STR_PROP(batchingDelay)];
+        self.batchingEventCount = [coder decodeIntegerForKey:SP_STR_PROP(batchingEventCount)];
+        self.batchingByteSize = [coder decodeIntegerForKey:SP_STR_PROP(batchingByteSize)];
+        self.immediateFlushEvents = [coder decodeObjectForKey:SP_STR_PROP(immediateFlushEvents)];
+        self.maxStoredEvents = [coder decodeIntegerForKey:SP_STR_PROP(maxStoredEvents)];
+        self.maxStoredBytes = [coder decodeIntegerForKey:SP_STR_PROP(maxStoredBytes)];
+        self.maxEventAge = [coder decodeDoubleForKey:SP_STR_PROP(maxEventAge)];
+        self.evictionPolicy = [coder decodeIntegerForKey:SP_STR_PROP(evictionPolicy)];
+        self.eventPriorities = [coder decodeObjectForKey:SP_STR_PROP(eventPriorities)];
+        self.evictableEvents = [coder decodeObjectForKey:SP_STR_PROP(evictableEvents)];
+        self.maxSendAttempts = [coder decodeIntegerForKey:SP_STR_PROP(maxSendAttempts)];
+        self.bisectFailedBatches = [coder decodeBoolForKey:SP_STR_PROP(bisectFailedBatches)];
     }
     return self;
 }
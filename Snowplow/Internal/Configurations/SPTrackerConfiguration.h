@@ -24,6 +24,21 @@
 #import "SPDevicePlatform.h"
 #import "SPLoggerDelegate.h"
 
+/*!
+ @brief What `track` does when the queue of the events waiting to be processed in background is full.
+ */
+typedef NS_ENUM(NSUInteger, SPTrackingQueueOverflowPolicy) {
+    /**
+     * Waits for room in the queue, so no event is lost but the calling thread can be slowed down.
+     * As `track` is usually called on the main thread, it may stall the UI until the queued events are processed.
+     */
+    SPTrackingQueueOverflowPolicyBlock = 0,
+    /**
+     * Discards the event: `track` returns nil. It's the default.
+     */
+    SPTrackingQueueOverflowPolicyDropNewest,
+} NS_SWIFT_NAME(TrackingQueueOverflowPolicy);
+
 NS_ASSUME_NONNULL_BEGIN
 
 NS_SWIFT_NAME(TrackerConfigurationProtocol)
@@ -106,6 +121,23 @@ NS_SWIFT_NAME(TrackerConfigurationProtocol)
  * Setting this property on a running tracker instance starts a new session (if sessions are tracked).
  */
 @property () BOOL userAnonymisation;
+/**
+ * Whether the tracked events are processed in background.
+ * When enabled, `track` only assigns the event identifier and timestamp, and the events are decorated
+ * (state machines, session, global contexts) and stored in the order they were tracked on a serial queue.
+ * The built-in events are copied when tracked, so they can be modified afterwards; custom subclasses
+ * of `SPEvent` are copied only if they conform to `NSCopying`, otherwise they must not be modified once passed to `track`.
+ * Disabling it blocks the calling thread until the events already queued are processed.
+ */
+@property () BOOL asynchronousTracking;
+/**
+ * Maximum number of tracked events waiting to be processed in background when `asynchronousTracking` is enabled.
+ */
+@property () NSInteger trackingQueueCapacity;
+/**
+ * What `track` does when `trackingQueueCapacity` events are waiting to be processed.
+ */
+@property () SPTrackingQueueOverflowPolicy trackingQueueOverflowPolicy;
 
 @end
 
@@ -136,6 +168,9 @@ NS_SWIFT_NAME(TrackerConfiguration)
  *         exceptionAutotracking = true;
  *         diagnosticAutotracking = false;
  *         userAnonymisation = false;
+ *         asynchronousTracking = false;
+ *         trackingQueueCapacity = 1000;
+ *         trackingQueueOverflowPolicy = TrackingQueueOverflowPolicy.dropNewest;
  */
 - (instancetype)init;
 
@@ -211,6 +246,18 @@ SP_BUILDER_DECLARE(NSString *, trackerVersionSuffix)
  * Whether to anonymise client-side user identifiers in session (userId, previousSessionId), subject (userId, networkUserId, domainUserId, ipAddress) and platform context entities (IDFA)
  */
 SP_BUILDER_DECLARE(BOOL, userAnonymisation)
+/**
+ * Whether the tracked events are processed in background.
+ */
+SP_BUILDER_DECLARE(BOOL, asynchronousTracking)
+/**
+ * Maximum number of tracked events waiting to be processed in background.
+ */
+SP_BUILDER_DECLARE(NSInteger, trackingQueueCapacity)
+/**
+ * What `track` does when the queue of the events waiting to be processed is full.
+ */
+SP_BUILDER_DECLARE(SPTrackingQueueOverflowPolicy, trackingQueueOverflowPolicy)
 
 @end
 
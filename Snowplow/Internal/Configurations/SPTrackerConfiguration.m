@@ -42,6 +42,9 @@
 @synthesize diagnosticAutotracking;
 @synthesize trackerVersionSuffix;
 @synthesize userAnonymisation;
+@synthesize asynchronousTracking;
+@synthesize trackingQueueCapacity;
+@synthesize trackingQueueOverflowPolicy;
 
 - (instancetype)initWithDictionary:(NSDictionary<NSString *,NSObject *> *)dictionary {
     if (self = [self init]) {
@@ -69,6 +72,13 @@
         self.exceptionAutotracking = [dictionary sp_boolForKey:SP_STR_PROP(exceptionAutotracking) defaultValue:self.exceptionAutotracking];
         self.diagnosticAutotracking = [dictionary sp_boolForKey:SP_STR_PROP(diagnosticAutotracking) defaultValue:self.diagnosticAutotracking];
         self.userAnonymisation = [dictionary sp_boolForKey:SP_STR_PROP(userAnonymisation) defaultValue:self.userAnonymisation];
+        self.asynchronousTracking = [dictionary sp_boolForKey:SP_STR_PROP(asynchronousTracking) defaultValue:self.asynchronousTracking];
+        self.trackingQueueCapacity = [dictionary sp_numberForKey:SP_STR_PROP(trackingQueueCapacity) defaultValue:@(self.trackingQueueCapacity)].integerValue;
+        NSString *trackingQueueOverflowPolicy = [dictionary sp_stringForKey:SP_STR_PROP(trackingQueueOverflowPolicy) defaultValue:nil];
+        if (trackingQueueOverflowPolicy) {
+            NSUInteger index = [@[@"block", @"dropNewest"] indexOfObject:trackingQueueOverflowPolicy];
+            self.trackingQueueOverflowPolicy = index != NSNotFound ? index : SPTrackingQueueOverflowPolicyDropNewest;
+        }
     }
     return self;
 }
@@ -95,6 +105,9 @@
         self.exceptionAutotracking = YES;
         self.diagnosticAutotracking = NO;
         self.userAnonymisation = NO;
+        self.asynchronousTracking = NO;
+        self.trackingQueueCapacity = 1000;
+        self.trackingQueueOverflowPolicy = SPTrackingQueueOverflowPolicyDropNewest;
     }
     return self;
 }
@@ -118,6 +131,9 @@ SP_BUILDER_METHOD(BOOL, installAutotracking)
 SP_BUILDER_METHOD(BOOL, exceptionAutotracking)
 SP_BUILDER_METHOD(BOOL, diagnosticAutotracking)
 SP_BUILDER_METHOD(BOOL, userAnonymisation)
+SP_BUILDER_METHOD(BOOL, asynchronousTracking)
+SP_BUILDER_METHOD(NSInteger, trackingQueueCapacity)
+SP_BUILDER_METHOD(SPTrackingQueueOverflowPolicy, trackingQueueOverflowPolicy)
 SP_BUILDER_METHOD(NSString *, trackerVersionSuffix)
 
 // MARK: - NSCopying
@@ -142,6 +158,9 @@ SP_BUILDER_METHOD(NSString *, trackerVersionSuffix)
     copy.diagnosticAutotracking = self.diagnosticAutotracking;
     copy.trackerVersionSuffix = self.trackerVersionSuffix;
     copy.userAnonymisation = self.userAnonymisation;
+    copy.asynchronousTracking = self.asynchronousTracking;
+    copy.trackingQueueCapacity = self.trackingQueueCapacity;
+    copy.trackingQueueOverflowPolicy = self.trackingQueueOverflowPolicy;
     return copy;
 }
 
@@ -170,6 +189,9 @@ SP_BUILDER_METHOD(NSString *, trackerVersionSuffix)
     [coder encodeBool:self.diagnosticAutotracking forKey:SP_STR_PROP(diagnosticAutotracking)];
     [coder encodeObject:self.trackerVersionSuffix forKey:SP_STR_PROP(trackerVersionSuffix)];
     [coder encodeBool:self.userAnonymisation forKey:SP_STR_PROP(userAnonymisation)];
+    [coder encodeBool:self.asynchronousTracking forKey:SP_STR_PROP(asynchronousTracking)];
+    [coder encodeInteger:self.trackingQueueCapacity forKey:SP_STR_PROP(trackingQueueCapacity)];
+    [coder encodeInteger:self.trackingQueueOverflowPolicy forKey:SP_STR_PROP(trackingQueueOverflowPolicy)];
 }
 
 - (nullable instancetype)initWithCoder:(nonnull NSCoder *)coder {
@@ -192,6 +214,9 @@ SP_BUILDER_METHOD(NSString *, trackerVersionSuffix)
         self.diagnosticAutotracking = [coder decodeBoolForKey:SP_STR_PROP(diagnosticAutotracking)];
         self.trackerVersionSuffix = [coder decodeObjectForKey:SP_STR_PROP(trackerVersionSuffix)];
         self.userAnonymisation = [coder decodeBoolForKey:SP_STR_PROP(userAnonymisation)];
+        self.asynchronousTracking = [coder decodeBoolForKey:SP_STR_PROP(asynchronousTracking)];
+        self.trackingQueueCapacity = [coder decodeIntegerForKey:SP_STR_PROP(trackingQueueCapacity)];
+        self.trackingQueueOverflowPolicy = [coder decodeIntegerForKey:SP_STR_PROP(trackingQueueOverflowPolicy)];
     }
     return self;
 }
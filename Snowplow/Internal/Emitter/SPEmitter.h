@@ -24,6 +24,7 @@
 #import "SPEventStore.h"
 #import "SPEmitterConfiguration.h"
 #import "SPEmitterEventProcessing.h"
+#import "SPEmitterMetrics.h"
 
 @protocol SPRequestCallback;
 @class SPPayload;
@@ -102,6 +103,90 @@ NS_SWIFT_NAME(EmitterBuilder)
  */
 - (void) setServerAnonymisation:(BOOL)serverAnonymisation;
 
+/*!
+ @brief Emitter builder method to enable gzip compression of POST requests.
+ @param requestCompression Whether to compress the POST body. When enabled, the byte limit for POST requests applies to the compressed size.
+ */
+- (void) setRequestCompression:(BOOL)requestCompression;
+
+/*!
+ @brief Emitter builder method to set the minimum size of a POST body before it gets compressed.
+ @param compressionThreshold Minimum size in bytes of the body to compress.
+ */
+- (void) setCompressionThreshold:(NSInteger)compressionThreshold;
+
+/*!
+ @brief Emitter builder method to set how long tracked events can wait to be sent together.
+ @param batchingDelay Maximum delay in seconds, 0 sends every event as soon as it's tracked.
+ */
+- (void) setBatchingDelay:(NSTimeInterval)batchingDelay;
+
+/*!
+ @brief Emitter builder method to set the number of waiting events that triggers sending.
+ @param batchingEventCount Number of events.
+ */
+- (void) setBatchingEventCount:(NSInteger)batchingEventCount;
+
+/*!
+ @brief Emitter builder method to set the size of the waiting events that triggers sending.
+ @param batchingByteSize Size in bytes.
+ */
+- (void) setBatchingByteSize:(NSInteger)batchingByteSize;
+
+/*!
+ @brief Emitter builder method to set the events sent as soon as they are tracked.
+ @param immediateFlushEvents Schemas or event names of the events.
+ */
+- (void) setImmediateFlushEvents:(NSArray<NSString *> *)immediateFlushEvents;
+
+/*!
+ @brief Emitter builder method to set the maximum number of events kept in the event store.
+ @param maxStoredEvents Number of events, 0 for no limit.
+ */
+- (void) setMaxStoredEvents:(NSInteger)maxStoredEvents;
+
+/*!
+ @brief Emitter builder method to set the maximum size of the events kept in the event store.
+ @param maxStoredBytes Size in bytes, 0 for no limit.
+ */
+- (void) setMaxStoredBytes:(NSInteger)maxStoredBytes;
+
+/*!
+ @brief Emitter builder method to set the maximum time an event is kept in the event store.
+ @param maxEventAge Time in seconds, 0 for no limit.
+ */
+- (void) setMaxEventAge:(NSTimeInterval)maxEventAge;
+
+/*!
+ @brief Emitter builder method to set which events are evicted first when the event store is over capacity.
+ @param evictionPolicy The eviction policy.
+ */
+- (void) setEvictionPolicy:(SPEvictionPolicy)evictionPolicy;
+
+/*!
+ @brief Emitter builder method to set the priorities used by SPEvictionPolicyDropLowestPriority.
+ @param eventPriorities Priorities keyed by schema or event name.
+ */
+- (void) setEventPriorities:(NSDictionary<NSString *, NSNumber *> *)eventPriorities;
+
+/*!
+ @brief Emitter builder method to set the events evicted first by SPEvictionPolicyDropBySchema.
+ @param evictableEvents Schemas or event names of the events.
+ */
+- (void) setEvictableEvents:(NSArray<NSString *> *)evictableEvents;
+
+/*!
+ @brief Emitter builder method to set how many times an event is sent before it's dead-lettered.
+ @param maxSendAttempts Number of attempts, 0 for no limit.
+ */
+- (void) setMaxSendAttempts:(NSInteger)maxSendAttempts;
+
+/*!
+ @brief Emitter builder method to set whether failed batches are split to isolate the events causing the failure.
+ @param bisectFailedBatches Whether to split the failed batches.
+ */
+- (void) setBisectFailedBatches:(BOOL)bisectFailedBatches;
+
 /*!
  @brief Builder method to set request headers.
  @param requestHeadersKeyValue custom headers (key, value) for http requests.
@@ -164,6 +249,34 @@ NS_SWIFT_NAME(Emitter)
 @property (readonly, nonatomic) NSDictionary<NSNumber *, NSNumber *> *customRetryForStatusCodes;
 /*! @brief Whether to anonymise server-side user identifiers including the `network_userid` and `user_ipaddress`. */
 @property (readonly, nonatomic) BOOL serverAnonymisation;
+/*! @brief Whether POST requests are gzip compressed. */
+@property (readonly, nonatomic) BOOL requestCompression;
+/*! @brief Minimum size in bytes of a POST body before it gets compressed. */
+@property (readonly, nonatomic) NSInteger compressionThreshold;
+/*! @brief Maximum time in seconds tracked events wait to be sent together. */
+@property (readonly, nonatomic) NSTimeInterval batchingDelay;
+/*! @brief Number of waiting events that triggers sending. */
+@property (readonly, nonatomic) NSInteger batchingEventCount;
+/*! @brief Size in bytes of the waiting events that triggers sending. */
+@property (readonly, nonatomic) NSInteger batchingByteSize;
+/*! @brief Schemas or event names of the events sent as soon as they are tracked. */
+@property (readonly, nonatomic) NSArray<NSString *> *immediateFlushEvents;
+/*! @brief Maximum number of events kept in the event store. */
+@property (readonly, nonatomic) NSInteger maxStoredEvents;
+/*! @brief Maximum size in bytes of the events kept in the event store. */
+@property (readonly, nonatomic) NSInteger maxStoredBytes;
+/*! @brief Maximum time in seconds an event is kept in the event store. */
+@property (readonly, nonatomic) NSTimeInterval maxEventAge;
+/*! @brief Which events are evicted first when the event store is over capacity. */
+@property (readonly, nonatomic) SPEvictionPolicy evictionPolicy;
+/*! @brief Priorities of the events keyed by schema or event name. */
+@property (readonly, nonatomic) NSDictionary<NSString *, NSNumber *> *eventPriorities;
+/*! @brief Schemas or event names of the events evicted first. */
+@property (readonly, nonatomic) NSArray<NSString *> *evictableEvents;
+/*! @brief Maximum number of times an event is sent before it's dead-lettered. */
+@property (readonly, nonatomic) NSInteger maxSendAttempts;
+/*! @brief Whether failed batches are split to isolate the events causing the failure. */
+@property (readonly, nonatomic) BOOL bisectFailedBatches;
 
 /*!
  @brief Builds the emitter using a build block of functions.
@@ -181,8 +294,39 @@ NS_SWIFT_NAME(Emitter)
  */
 - (void)addPayloadToBuffer:(SPPayload *)eventPayload;
 
+/*!
+ @brief Insert a Payload object into the buffer to be sent to collector.
+ @param eventPayload A payload to be sent.
+ @param flushImmediately Whether to send the event without waiting for the batching delay.
+ */
+- (void)addPayloadToBuffer:(SPPayload *)eventPayload flushImmediately:(BOOL)flushImmediately;
+
+/*!
+ @brief Insert several Payload objects into the buffer at once.
+
+ The payloads are added to the store in a single write, when the store supports it, and trigger at most one flush.
+ @param eventPayloads The payloads to be sent, in the order they have been tracked.
+ @param flushImmediately Whether to send the events without waiting for the batching delay.
+ */
+- (void)addPayloadsToBuffer:(NSArray<SPPayload *> *)eventPayloads flushImmediately:(BOOL)flushImmediately;
+
+/*!
+ @brief Whether the event has to be sent without waiting for the batching delay.
+ @param schema The schema of a self-describing event.
+ @param eventName The name of a primitive event.
+ */
+- (BOOL)isImmediateFlushEventWithSchema:(NSString *)schema eventName:(NSString *)eventName;
+
+/*!
+ @brief Priority of the event in the event store according to the eviction policy.
+ @param schema The schema of a self-describing event.
+ @param eventName The name of a primitive event.
+ */
+- (NSInteger)evictionPriorityForEventWithSchema:(NSString *)schema eventName:(NSString *)eventName;
+
 /*!
  @brief Empties the buffer of events using the respective HTTP request method.
+ It doesn't wait for a scheduled retry if the emitter is backing off.
  */
 - (void)flush;
 
@@ -216,4 +360,29 @@ NS_SWIFT_NAME(Emitter)
  */
 - (BOOL) getSendingStatus;
 
+/*!
+ @brief Returns whether the emitter is waiting for a scheduled retry after an emit round where all the requests failed.
+ */
+- (BOOL) isBackingOff;
+
+/*!
+ @brief Returns the number of consecutive emit rounds where all the requests failed.
+ */
+- (NSUInteger) retryAttempts;
+
+/*!
+ @brief Returns the date of the next scheduled retry, or nil if the emitter is not backing off.
+ */
+- (NSDate *) nextRetryDate;
+
+/*!
+ @brief Returns a snapshot of the emitter activity.
+ */
+- (SPEmitterMetrics *) metrics;
+
+/*!
+ @brief Clears the counters and samples of the emitter activity.
+ */
+- (void) resetMetrics;
+
 @end
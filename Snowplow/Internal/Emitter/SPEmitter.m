@@ -26,6 +26,7 @@
 #import "SPDefaultNetworkConnection.h"
 #import "SPEventStore.h"
 #import "SPUtilities.h"
+#import "SPGzipSizeEstimator.h"
 #import "SPPayload.h"
 #import "SPSelfDescribingJson.h"
 #import "SPRequestResult.h"
@@ -33,6 +34,7 @@
 #import "SPRequestCallback.h"
 #import "SPRequest.h"
 #import "SPLogger.h"
+#import "SPEmitterMetricsRecorder.h"
 
 @implementation SPEmitter {
     id<SPEventStore> _eventStore;
@@ -41,10 +43,20 @@
     NSString *         _url;
     NSTimer *          _timer;
     BOOL               _isSending;
-    NSOperationQueue * _dataOperationQueue;
+    NSUInteger         _activeEmitRounds;
     BOOL               _builderFinished;
     NSString *         _namespace;
     BOOL               _pausedEmit;
+    NSUInteger         _retryAttempts;
+    NSDate *           _nextRetryDate;
+    dispatch_source_t  _retryTimer;
+    NSSet<NSString *> *_immediateFlushEventSet;
+    NSUInteger         _batchedEventCount;
+    NSUInteger         _batchedByteSize;
+    dispatch_source_t  _batchingTimer;
+    SPEmitterMetricsRecorder *_metricsRecorder;
+    NSDate *           _oldestEventDate;
+    NSSet<NSString *> *_evictableEventSet;
 }
 
 const NSUInteger POST_WRAPPER_BYTES = 88;
@@ -73,22 +85,46 @@ const NSUInteger POST_WRAPPER_BYTES = 88;
         _byteLimitGet = 40000;
         _byteLimitPost = 40000;
         _isSending = NO;
-        _dataOperationQueue = [[NSOperationQueue alloc] init];
+        _activeEmitRounds = 0;
         _builderFinished = NO;
         _customPostPath = nil;
         _requestHeaders = nil;
         _eventStore = nil;
         _networkConnection = nil;
         _pausedEmit = NO;
+        _retryAttempts = 0;
+        _nextRetryDate = nil;
+        _retryTimer = nil;
         _customRetryForStatusCodes = @{};
         _serverAnonymisation = NO;
+        _requestCompression = NO;
+        _compressionThreshold = 1024;
+        _batchingDelay = 0;
+        _batchingEventCount = 10;
+        _batchingByteSize = 20000;
+        _immediateFlushEvents = nil;
+        _immediateFlushEventSet = [NSSet set];
+        _batchedEventCount = 0;
+        _batchedByteSize = 0;
+        _batchingTimer = nil;
+        _metricsRecorder = [SPEmitterMetricsRecorder new];
+        _oldestEventDate = nil;
+        _maxStoredEvents = 0;
+        _maxStoredBytes = 0;
+        _maxEventAge = 0;
+        _evictionPolicy = SPEvictionPolicyDropOldest;
+        _eventPriorities = @{};
+        _evictableEvents = nil;
+        _evictableEventSet = [NSSet set];
+        _maxSendAttempts = 0;
+        _bisectFailedBatches = NO;
     }
     return self;
 }
 
 - (void) setup {
-    _dataOperationQueue.maxConcurrentOperationCount = _emitThreadPoolSize;
     [self setupNetworkConnection];
+    [self setupEventStoreCapacity];
     [self resumeTimer];
     _builderFinished = YES;
 }
@@ -114,9 +150,18 @@ const NSUInteger POST_WRAPPER_BYTES = 88;
         [builder setByteLimitGet:strongSelf->_byteLimitGet];
         [builder setByteLimitPost:strongSelf->_byteLimitPost];
         [builder setServerAnonymisation:strongSelf->_serverAnonymisation];
+        [builder setRequestCompression:strongSelf->_requestCompression];
+        [builder setCompressionThreshold:strongSelf->_compressionThreshold];
     }];
 }
 
+- (void)setupEventStoreCapacity {
+    id<SPEventStore> eventStore = _eventStore;
+    if ([eventStore respondsToSelector:@selector(setCapacityWithMaxEventCount:maxByteSize:maxEventAge:)]) {
+        [eventStore setCapacityWithMaxEventCount:_maxStoredEvents maxByteSize:_maxStoredBytes maxEventAge:_maxEventAge];
+    }
+}
+
 // MARK: - Builder methods
 
 - (void)setNamespace:(NSString *)namespace {
@@ -127,6 +172,7 @@ const NSUInteger POST_WRAPPER_BYTES = 88;
 #else
         _eventStore = [[SPSQLiteEventStore alloc] initWithNamespace:_namespace];
 #endif
+        [self setupEventStoreCapacity];
     }
 }
 
@@ -170,9 +216,6 @@ const NSUInteger POST_WRAPPER_BYTES = 88;
 - (void) setEmitThreadPoolSize:(NSInteger)emitThreadPoolSize {
     if (emitThreadPoolSize > 0) {
         _emitThreadPoolSize = emitThreadPoolSize;
-        if (_dataOperationQueue.maxConcurrentOperationCount != emitThreadPoolSize) {
-            _dataOperationQueue.maxConcurrentOperationCount = _emitThreadPoolSize;
-        }
         if (_builderFinished && _networkConnection) {
             [self setupNetworkConnection];
         }
@@ -200,6 +243,95 @@ const NSUInteger POST_WRAPPER_BYTES = 88;
     }
 }
 
+- (void) setRequestCompression:(BOOL)requestCompression {
+    _requestCompression = requestCompression;
+    if (_builderFinished && _networkConnection) {
+        [self setupNetworkConnection];
+    }
+}
+
+- (void) setCompressionThreshold:(NSInteger)compressionThreshold {
+    if (compressionThreshold >= 0) {
+        _compressionThreshold = compressionThreshold;
+        if (_builderFinished && _networkConnection) {
+            [self setupNetworkConnection];
+        }
+    }
+}
+
+- (void) setBatchingDelay:(NSTimeInterval)batchingDelay {
+    if (batchingDelay >= 0) {
+        _batchingDelay = batchingDelay;
+    }
+}
+
+- (void) setBatchingEventCount:(NSInteger)batchingEventCount {
+    if (batchingEventCount > 0) {
+        _batchingEventCount = batchingEventCount;
+    }
+}
+
+- (void) setBatchingByteSize:(NSInteger)batchingByteSize {
+    if (batchingByteSize > 0) {
+        _batchingByteSize = batchingByteSize;
+    }
+}
+
+- (void) setImmediateFlushEvents:(NSArray<NSString *> *)immediateFlushEvents {
+    _immediateFlushEvents = immediateFlushEvents;
+    _immediateFlushEventSet = immediateFlushEvents ? [NSSet setWithArray:immediateFlushEvents] : [NSSet set];
+}
+
+- (void) setMaxStoredEvents:(NSInteger)maxStoredEvents {
+    if (maxStoredEvents >= 0) {
+        _maxStoredEvents = maxStoredEvents;
+        if (_builderFinished) {
+            [self setupEventStoreCapacity];
+        }
+    }
+}
+
+- (void) setMaxStoredBytes:(NSInteger)maxStoredBytes {
+    if (maxStoredBytes >= 0) {
+        _maxStoredBytes = maxStoredBytes;
+        if (_builderFinished) {
+            [self setupEventStoreCapacity];
+        }
+    }
+}
+
+- (void) setMaxEventAge:(NSTimeInterval)maxEventAge {
+    if (maxEventAge >= 0) {
+        _maxEventAge = maxEventAge;
+        if (_builderFinished) {
+            [self setupEventStoreCapacity];
+        }
+    }
+}
+
+- (void) setEvictionPolicy:(SPEvictionPolicy)evictionPolicy {
+    _evictionPolicy = evictionPolicy;
+}
+
+- (void) setEventPriorities:(NSDictionary<NSString *, NSNumber *> *)eventPriorities {
+    _eventPriorities = eventPriorities ?: @{};
+}
+
+- (void) setEvictableEvents:(NSArray<NSString *> *)evictableEvents {
+    _evictableEvents = evictableEvents;
+    _evictableEventSet = evictableEvents ? [NSSet setWithArray:evictableEvents] : [NSSet set];
+}
+
+- (void) setMaxSendAttempts:(NSInteger)maxSendAttempts {
+    if (maxSendAttempts >= 0) {
+        _maxSendAttempts = maxSendAttempts;
+    }
+}
+
+- (void) setBisectFailedBatches:(BOOL)bisectFailedBatches {
+    _bisectFailedBatches = bisectFailedBatches;
+}
+
 - (void) setCustomPostPath:(NSString *)customPath {
     _customPostPath = customPath;
     if (_builderFinished && _networkConnection) {
@@ -224,6 +356,7 @@ const NSUInteger POST_WRAPPER_BYTES = 88;
 - (void)setEventStore:(id<SPEventStore>)eventStore {
     if (!_builderFinished || !_eventStore || [_eventStore count] == 0 ) {
         _eventStore = eventStore;
+        [self setupEventStoreCapacity];
     }
 }
 
@@ -245,7 +378,7 @@ const NSUInteger POST_WRAPPER_BYTES = 88;
         if (strongSelf == nil) return;
         
         strongSelf->_timer = [NSTimer scheduledTimerWithTimeInterval:kSPDefaultBufferTimeout
-                                                              target:[[SPWeakTimerTarget alloc] initWithTarget:strongSelf andSelector:@selector(flush)]
+                                                              target:[[SPWeakTimerTarget alloc] initWithTarget:strongSelf andSelector:@selector(dispatchSendGuard)]
                                                             selector:@selector(timerFired:)
                                                             userInfo:nil
                                                              repeats:YES];
@@ -267,18 +400,79 @@ const NSUInteger POST_WRAPPER_BYTES = 88;
 }
 
 - (void)addPayloadToBuffer:(SPPayload *)eventPayload {
+    [self addPayloadToBuffer:eventPayload flushImmediately:NO];
+}
+
+- (void)addPayloadToBuffer:(SPPayload *)eventPayload flushImmediately:(BOOL)flushImmediately {
+    [self addPayloadsToBuffer:@[eventPayload] flushImmediately:flushImmediately];
+}
+
+- (void)addPayloadsToBuffer:(NSArray<SPPayload *> *)eventPayloads flushImmediately:(BOOL)flushImmediately {
+    if (!eventPayloads.count) {
+        return;
+    }
     __weak __typeof__(self) weakSelf = self;
     
     dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
         __typeof__(self) strongSelf = weakSelf;
         if (strongSelf == nil) return;
         
-        [strongSelf->_eventStore addEvent:eventPayload];
-        [strongSelf flush];
+        id<SPEventStore> eventStore = strongSelf->_eventStore;
+        if (eventPayloads.count > 1 && [eventStore respondsToSelector:@selector(addEvents:)]) {
+            [eventStore addEvents:eventPayloads];
+        } else {
+            for (SPPayload *eventPayload in eventPayloads) {
+                [eventStore addEvent:eventPayload];
+            }
+        }
+        @synchronized (strongSelf) {
+            if (!strongSelf->_oldestEventDate) {
+                strongSelf->_oldestEventDate = [NSDate date];
+            }
+        }
+        if (flushImmediately || [strongSelf shouldSendBatchWithPayloads:eventPayloads]) {
+            [strongSelf sendGuard];
+        }
     });
 }
 
+- (BOOL)isImmediateFlushEventWithSchema:(NSString *)schema eventName:(NSString *)eventName {
+    NSSet<NSString *> *immediateFlushEventSet = _immediateFlushEventSet;
+    if (!immediateFlushEventSet.count) {
+        return NO;
+    }
+    return (schema && [immediateFlushEventSet containsObject:schema])
+        || (eventName && [immediateFlushEventSet containsObject:eventName]);
+}
+
+- (NSInteger)evictionPriorityForEventWithSchema:(NSString *)schema eventName:(NSString *)eventName {
+    switch (_evictionPolicy) {
+        case SPEvictionPolicyDropLowestPriority: {
+            NSDictionary<NSString *, NSNumber *> *eventPriorities = _eventPriorities;
+            NSNumber *priority = (schema ? eventPriorities[schema] : nil) ?: (eventName ? eventPriorities[eventName] : nil);
+            return priority.integerValue;
+        }
+        case SPEvictionPolicyDropBySchema: {
+            NSSet<NSString *> *evictableEventSet = _evictableEventSet;
+            BOOL evictable = (schema && [evictableEventSet containsObject:schema])
+                || (eventName && [evictableEventSet containsObject:eventName]);
+            return evictable ? -1 : 0;
+        }
+        default:
+            return 0;
+    }
+}
+
 - (void)flush {
+    // An explicit flush doesn't wait for the scheduled retry.
+    @synchronized (self) {
+        [self cancelRetryTimer];
+        _nextRetryDate = nil;
+    }
+    [self dispatchSendGuard];
+}
+
+- (void)dispatchSendGuard {
     if ([NSThread isMainThread]) {
         dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
             [self sendGuard];
@@ -288,42 +482,330 @@ const NSUInteger POST_WRAPPER_BYTES = 88;
     }
 }
 
+// MARK: - Batching
+
+/*!
+ @brief Accounts the new event in the current batch.
+ @return Whether the batch is full and has to be sent now, otherwise it's sent when the batching delay expires.
+ */
+- (BOOL)shouldSendBatchWithPayloads:(NSArray<SPPayload *> *)payloads {
+    if (_batchingDelay <= 0) {
+        return YES;
+    }
+    NSUInteger byteSize = 0;
+    for (SPPayload *payload in payloads) {
+        byteSize += payload.byteSize;
+    }
+    @synchronized (self) {
+        _batchedEventCount += payloads.count;
+        _batchedByteSize += byteSize;
+        if (_batchedEventCount >= _batchingEventCount || _batchedByteSize >= _batchingByteSize) {
+            return YES;
+        }
+        if (!_batchingTimer) {
+            _batchingTimer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0));
+            dispatch_source_set_timer(_batchingTimer,
+                                      dispatch_time(DISPATCH_TIME_NOW, (int64_t)(_batchingDelay * NSEC_PER_SEC)),
+                                      DISPATCH_TIME_FOREVER,
+                                      (uint64_t)(0.1 * _batchingDelay * NSEC_PER_SEC));
+            __weak __typeof__(self) weakSelf = self;
+            dispatch_source_set_event_handler(_batchingTimer, ^{
+                __typeof__(self) strongSelf = weakSelf;
+                if (strongSelf == nil) return;
+                [strongSelf sendGuard];
+            });
+            dispatch_resume(_batchingTimer);
+        }
+        return NO;
+    }
+}
+
+/*!
+ @brief Starts a new batch: the events waiting so far are going to be picked up by the next emit round.
+ */
+- (void)resetBatch {
+    if (!_batchedEventCount && !_batchingTimer) {
+        return;
+    }
+    @synchronized (self) {
+        _batchedEventCount = 0;
+        _batchedByteSize = 0;
+        if (_batchingTimer) {
+            dispatch_source_cancel(_batchingTimer);
+            _batchingTimer = nil;
+        }
+    }
+}
+
 // MARK: - Control methods
 
 - (void) sendGuard {
-    if (_isSending || _pausedEmit) {
+    [self resetBatch];
+    NSUInteger maxEmitRounds = [self isLeasingEventStore] ? kSPEmitterMaxConcurrentRounds : 1;
+    @synchronized (self) {
+        if (_activeEmitRounds >= maxEmitRounds || _pausedEmit || _retryTimer) {
+            return;
+        }
+        _activeEmitRounds++;
+        _isSending = YES;
+    }
+    [self attemptEmit];
+}
+
+/*!
+ @brief Whether the event store leases the events it returns, so that emit rounds can overlap.
+ */
+- (BOOL)isLeasingEventStore {
+    return [_eventStore respondsToSelector:@selector(leaseEmittableEventsWithQueryLimit:leaseDuration:)];
+}
+
+- (void)releaseEventsWithIds:(NSArray<NSNumber *> *)storeIds {
+    id<SPEventStore> eventStore = _eventStore;
+    if (storeIds.count && [eventStore respondsToSelector:@selector(releaseEventsWithIds:)]) {
+        [eventStore releaseEventsWithIds:storeIds];
+    }
+}
+
+/*!
+ @brief Counts a failed attempt for the events in the store.
+ @return The events that reached `maxAttempts` and have been dead-lettered by the store.
+ */
+- (NSArray<NSNumber *> *)recordFailedAttemptForEventsWithIds:(NSArray<NSNumber *> *)storeIds maxAttempts:(NSUInteger)maxAttempts {
+    id<SPEventStore> eventStore = _eventStore;
+    if (!storeIds.count || ![eventStore respondsToSelector:@selector(recordFailedAttemptForEventsWithIds:maxAttempts:)]) {
+        return @[];
+    }
+    return [eventStore recordFailedAttemptForEventsWithIds:storeIds maxAttempts:maxAttempts] ?: @[];
+}
+
+- (void)attemptEmit {
+    NSDate *roundStartDate = [NSDate date];
+    NSArray<SPEmitterEvent *> *events = nil;
+    NSArray<SPRequest *> *requests = nil;
+    @try {
+        events = [self eventsForNextRound];
+        requests = events ? [self buildRequestsFromEvents:events] : nil;
+    } @catch (NSException *exception) {
+        SPLogError(@"Received exception during emission process: %@", exception);
+    }
+    if (!requests) {
+        [self finishEmitRound:NO];
         return;
     }
-    @synchronized (self) {
-        if (!_isSending && !_pausedEmit) {
-            _isSending = YES;
+    __weak __typeof__(self) weakSelf = self;
+    @try {
+        [self sendRequests:requests events:events completion:^(NSArray<SPRequestResult *> *results) {
+            __typeof__(self) strongSelf = weakSelf;
+            if (strongSelf == nil) return;
+            BOOL shouldContinue = NO;
             @try {
-                [self attemptEmit];
+                shouldContinue = [strongSelf processResults:results];
             } @catch (NSException *exception) {
                 SPLogError(@"Received exception during emission process: %@", exception);
-                _isSending = NO;
             }
+            [strongSelf->_metricsRecorder recordEmitRoundDuration:-[roundStartDate timeIntervalSinceNow]];
+            [strongSelf finishEmitRound:shouldContinue];
+        }];
+    } @catch (NSException *exception) {
+        SPLogError(@"Received exception during emission process: %@", exception);
+        NSMutableArray<NSNumber *> *storeIds = [NSMutableArray new];
+        for (SPRequest *request in requests) {
+            [storeIds addObjectsFromArray:request.emitterEventIds];
         }
+        [self releaseEventsWithIds:storeIds];
+        [self finishEmitRound:NO];
     }
 }
 
-- (void)attemptEmit {
+- (void)finishEmitRound:(BOOL)shouldContinue {
+    if (!shouldContinue || _pausedEmit) {
+        @synchronized (self) {
+            _activeEmitRounds -= MIN(_activeEmitRounds, 1);
+            _isSending = _activeEmitRounds > 0;
+        }
+        return;
+    }
+    // Schedule the next round instead of recursing so the thread is released between rounds.
+    __weak __typeof__(self) weakSelf = self;
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        __typeof__(self) strongSelf = weakSelf;
+        if (strongSelf == nil) return;
+        [strongSelf attemptEmit];
+    });
+}
+
+/*!
+ @brief Sends the requests through the asynchronous API of the network connection when available,
+ so no thread is blocked waiting for the collector.
+ */
+- (void)sendRequests:(NSArray<SPRequest *> *)requests completion:(void (^)(NSArray<SPRequestResult *> *results))completion {
+    id<SPNetworkConnection> networkConnection = _networkConnection;
+    if ([networkConnection respondsToSelector:@selector(sendRequests:completion:)]) {
+        [networkConnection sendRequests:requests completion:completion];
+    } else {
+        completion([networkConnection sendRequests:requests]);
+    }
+}
+
+/*!
+ @brief Sends the requests and, when `bisectFailedBatches` is enabled, splits the failed batches to isolate the failing events.
+ Batches are split only if some request of the round succeeded or the round has a single request:
+ when all the requests fail the collector is likely down and every half would fail too.
+ */
+- (void)sendRequests:(NSArray<SPRequest *> *)requests events:(NSArray<SPEmitterEvent *> *)events completion:(void (^)(NSArray<SPRequestResult *> *results))completion {
+    if (!_bisectFailedBatches) {
+        [self sendRequests:requests completion:completion];
+        return;
+    }
+    NSMutableDictionary<NSNumber *, SPEmitterEvent *> *eventsById = [NSMutableDictionary dictionaryWithCapacity:events.count];
+    for (SPEmitterEvent *event in events) {
+        eventsById[@(event.storeId)] = event;
+    }
+    __weak __typeof__(self) weakSelf = self;
+    [self sendRequests:requests completion:^(NSArray<SPRequestResult *> *results) {
+        __typeof__(self) strongSelf = weakSelf;
+        if (strongSelf == nil || (results.count > 1 && ![strongSelf hasSuccessfulResult:results])) {
+            completion(results);
+            return;
+        }
+        [strongSelf bisectResults:results eventsById:eventsById completion:completion];
+    }];
+}
+
+/*!
+ @brief Replaces each failed batch with the results of sending its two halves, recursing into the halves that fail.
+ A branch stops when both halves fail, as the failure isn't caused by a single event.
+ @param completion Called with the results of the requests that haven't been split.
+ */
+- (void)bisectResults:(NSArray<SPRequestResult *> *)results eventsById:(NSDictionary<NSNumber *, SPEmitterEvent *> *)eventsById completion:(void (^)(NSArray<SPRequestResult *> *results))completion {
+    NSMutableArray<SPRequestResult *> *finalResults = [NSMutableArray new];
+    dispatch_group_t group = dispatch_group_create();
+    __weak __typeof__(self) weakSelf = self;
+    for (SPRequestResult *result in results) {
+        NSArray<SPRequest *> *halfRequests = [self shouldBisectResult:result] ? [self buildHalfRequestsOfResult:result eventsById:eventsById] : nil;
+        if (!halfRequests) {
+            @synchronized (finalResults) {
+                [finalResults addObject:result];
+            }
+            continue;
+        }
+        SPLogDebug(@"Request with %@ events failed with status %ld. Sending it in two halves.", @(result.storeIds.count), (long)result.statusCode);
+        [_metricsRecorder recordRequestResults:@[result]];
+        dispatch_group_enter(group);
+        [self sendRequests:halfRequests completion:^(NSArray<SPRequestResult *> *halfResults) {
+            void (^addResults)(NSArray<SPRequestResult *> *) = ^(NSArray<SPRequestResult *> *bisectedResults) {
+                @synchronized (finalResults) {
+                    [finalResults addObjectsFromArray:bisectedResults];
+                }
+                dispatch_group_leave(group);
+            };
+            __typeof__(self) strongSelf = weakSelf;
+            if (strongSelf == nil || ![strongSelf hasSuccessfulResult:halfResults]) {
+                addResults(halfResults);
+                return;
+            }
+            [strongSelf bisectResults:halfResults eventsById:eventsById completion:addResults];
+        }];
+    }
+    dispatch_group_notify(group, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        completion(finalResults);
+    });
+}
+
+/*!
+ @brief Network errors and oversize requests don't depend on which events are in the batch.
+ */
+- (BOOL)shouldBisectResult:(SPRequestResult *)result {
+    return !result.isSuccessful && !result.isOversize && result.statusCode > 0 && result.storeIds.count > 1;
+}
+
+- (BOOL)hasSuccessfulResult:(NSArray<SPRequestResult *> *)results {
+    for (SPRequestResult *result in results) {
+        if (result.isSuccessful) {
+            return YES;
+        }
+    }
+    return NO;
+}
+
+/*!
+ @return The requests sending the events of the result in two halves, or nil if some events are missing.
+ */
+- (NSArray<SPRequest *> *)buildHalfRequestsOfResult:(SPRequestResult *)result eventsById:(NSDictionary<NSNumber *, SPEmitterEvent *> *)eventsById {
+    NSArray<NSNumber *> *storeIds = result.storeIds;
+    NSMutableArray<SPEmitterEvent *> *events = [NSMutableArray arrayWithCapacity:storeIds.count];
+    for (NSNumber *storeId in storeIds) {
+        SPEmitterEvent *event = eventsById[storeId];
+        if (!event) {
+            return nil;
+        }
+        [events addObject:event];
+    }
+    NSUInteger half = events.count / 2;
+    NSArray<SPRequest *> *requests = [self buildRequestsFromEvents:[events subarrayWithRange:NSMakeRange(0, half)]];
+    return [requests arrayByAddingObjectsFromArray:[self buildRequestsFromEvents:[events subarrayWithRange:NSMakeRange(half, events.count - half)]]];
+}
+
+/*!
+ @brief Reads the next batch of events from the store.
+ @return The events to send or nil if there aren't events to send.
+ */
+- (NSArray<SPEmitterEvent *> *)eventsForNextRound {
     if (!_eventStore.count) {
         SPLogDebug(@"Database empty. Returning.", nil);
-        _isSending = NO;
-        return;
+        @synchronized (self) {
+            _oldestEventDate = nil;
+        }
+        return nil;
     }
-    
-    NSArray<SPEmitterEvent *> *events = [_eventStore emittableEventsWithQueryLimit:_emitRange];
-    NSArray<SPRequest *> *requests = [self buildRequestsFromEvents:events];
-    NSArray<SPRequestResult *> *sendResults = [_networkConnection sendRequests:requests];
-    
+    NSArray<SPEmitterEvent *> *events = nil;
+    if ([self isLeasingEventStore]) {
+        events = [_eventStore leaseEmittableEventsWithQueryLimit:_emitRange leaseDuration:kSPEmitterLeaseDuration];
+        if (!events.count) {
+            // The remaining events are being sent by other rounds.
+            return nil;
+        }
+        if (events.count >= _emitRange) {
+            // There is a backlog: another round can send the next events while this one waits for the collector.
+            __weak __typeof__(self) weakSelf = self;
+            dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+                [weakSelf sendGuard];
+            });
+        }
+    } else {
+        events = [_eventStore emittableEventsWithQueryLimit:_emitRange];
+        if (!events.count) {
+            // The counted events can't be read (e.g. corrupt records), retrying straight away would spin.
+            SPLogDebug(@"No events could be read from the store. Returning.", nil);
+            return nil;
+        }
+    }
+    BOOL isOnlyRound;
+    @synchronized (self) {
+        isOnlyRound = _activeEmitRounds <= 1;
+    }
+    if (isOnlyRound) {
+        // With overlapping rounds only the first one reads the oldest events.
+        [self updateOldestEventDateWithEvent:events.firstObject];
+    }
+    return events;
+}
+
+/*!
+ @brief Removes the sent events from the store and notifies the callback.
+ @return Whether another round should follow immediately.
+ */
+- (BOOL)processResults:(NSArray<SPRequestResult *> *)sendResults {
     SPLogVerbose(@"Processing emitter results.");
+    [_metricsRecorder recordRequestResults:sendResults];
     
     NSInteger successCount = 0;
     NSInteger failedWillRetryCount = 0;
     NSInteger failedWontRetryCount = 0;
     NSMutableArray<NSNumber *> *removableEvents = [NSMutableArray new];
+    NSMutableArray<NSNumber *> *retryEvents = [NSMutableArray new];
+    NSMutableArray<NSNumber *> *rejectedEvents = [NSMutableArray new];
+    NSMutableArray<NSNumber *> *quarantineEvents = [NSMutableArray new];
     
     for (SPRequestResult *result in sendResults) {
         NSArray<NSNumber *> *resultIndexArray = result.storeIds;
@@ -332,15 +814,40 @@ const NSUInteger POST_WRAPPER_BYTES = 88;
             [removableEvents addObjectsFromArray:resultIndexArray];
         } else if ([result shouldRetry:_customRetryForStatusCodes]) {
             failedWillRetryCount += resultIndexArray.count;
+            [retryEvents addObjectsFromArray:resultIndexArray];
+            [_metricsRecorder recordRetryWithStatusCode:result.statusCode];
+            if (result.statusCode > 0) {
+                // Only the collector rejecting the events counts as an attempt, not the device being offline.
+                [rejectedEvents addObjectsFromArray:resultIndexArray];
+            }
+        } else if (_bisectFailedBatches && result.statusCode > 0 && !result.isOversize) {
+            // The failing events have been isolated by the bisection, they are kept aside rather than dropped.
+            failedWontRetryCount += resultIndexArray.count;
+            [quarantineEvents addObjectsFromArray:resultIndexArray];
         } else {
             failedWontRetryCount += resultIndexArray.count;
             [removableEvents addObjectsFromArray:resultIndexArray];
             SPLogError(@"Sending events to Collector failed with status %ld. Events will be dropped.", (long)[result statusCode]);
         }
     }
+    if (quarantineEvents.count) {
+        NSArray<NSNumber *> *quarantinedEvents = [self recordFailedAttemptForEventsWithIds:quarantineEvents maxAttempts:1];
+        [quarantineEvents removeObjectsInArray:quarantinedEvents];
+        [removableEvents addObjectsFromArray:quarantineEvents];
+        SPLogError(@"Sending %@ events to Collector failed. %@ events moved to the dead-letter events, the others will be dropped.",
+                   @(quarantinedEvents.count + quarantineEvents.count), @(quarantinedEvents.count));
+    }
+    NSArray<NSNumber *> *deadLetterEvents = [self recordFailedAttemptForEventsWithIds:rejectedEvents maxAttempts:(NSUInteger)_maxSendAttempts];
+    if (deadLetterEvents.count) {
+        [retryEvents removeObjectsInArray:deadLetterEvents];
+        failedWillRetryCount -= deadLetterEvents.count;
+        failedWontRetryCount += deadLetterEvents.count;
+        SPLogError(@"%@ events failed to be sent %@ times. They have been moved to the dead-letter events.", @(deadLetterEvents.count), @(_maxSendAttempts));
+    }
     NSInteger allFailureCount = failedWillRetryCount + failedWontRetryCount;
     
     [_eventStore removeEventsWithIds:removableEvents];
+    [self releaseEventsWithIds:retryEvents];
     
     SPLogDebug(@"Success Count: %@", [@(successCount) stringValue]);
     SPLogDebug(@"Failure Count: %@", [@(allFailureCount) stringValue]);
@@ -355,14 +862,82 @@ const NSUInteger POST_WRAPPER_BYTES = 88;
     
     if (failedWillRetryCount > 0 && successCount == 0) {
         SPLogDebug(@"Ending emitter run as all requests failed.", nil);
-        [NSThread sleepForTimeInterval:5];
-        _isSending = NO;
+        [self scheduleRetry];
+        return NO;
+    }
+    if (successCount > 0) {
+        @synchronized (self) {
+            _retryAttempts = 0;
+        }
+    }
+    return YES;
+}
+
+/*!
+ @brief The events are read oldest first, so the creation time of the first one gives the age of the queue.
+ */
+- (void)updateOldestEventDateWithEvent:(SPEmitterEvent *)event {
+    // Read without parsing the stored payload.
+    long long timestampMs = [[event.payload stringValueForKey:kSPTimestamp] longLongValue];
+    if (timestampMs <= 0) {
         return;
-    } else {
-        [self attemptEmit];
+    }
+    @synchronized (self) {
+        _oldestEventDate = [NSDate dateWithTimeIntervalSince1970:timestampMs / 1000.0];
+    }
+}
+
+// MARK: - Retry backoff
+
+- (void)scheduleRetry {
+    @synchronized (self) {
+        _retryAttempts++;
+        NSTimeInterval delay = [self retryDelayForAttempt:_retryAttempts];
+        _nextRetryDate = [NSDate dateWithTimeIntervalSinceNow:delay];
+        SPLogDebug(@"Retrying emission in %.1f seconds (attempt %@).", delay, [@(_retryAttempts) stringValue]);
+        
+        [self cancelRetryTimer];
+        _retryTimer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0));
+        dispatch_source_set_timer(_retryTimer,
+                                  dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)),
+                                  DISPATCH_TIME_FOREVER,
+                                  (uint64_t)(0.1 * delay * NSEC_PER_SEC));
+        __weak __typeof__(self) weakSelf = self;
+        dispatch_source_set_event_handler(_retryTimer, ^{
+            __typeof__(self) strongSelf = weakSelf;
+            if (strongSelf == nil) return;
+            [strongSelf retryTimerFired];
+        });
+        dispatch_resume(_retryTimer);
     }
 }
 
+- (void)retryTimerFired {
+    @synchronized (self) {
+        [self cancelRetryTimer];
+        _nextRetryDate = nil;
+    }
+    [self sendGuard];
+}
+
+- (void)cancelRetryTimer {
+    if (_retryTimer) {
+        dispatch_source_cancel(_retryTimer);
+        _retryTimer = nil;
+    }
+}
+
+/*!
+ @brief Exponential backoff capped at kSPEmitterRetryMaxDelay, with the upper half randomised ("equal jitter")
+ so that many devices recovering from the same outage don't retry in lockstep.
+ */
+- (NSTimeInterval)retryDelayForAttempt:(NSUInteger)attempt {
+    double exponent = MIN(attempt - 1, 16);
+    NSTimeInterval delay = MIN(kSPEmitterRetryBaseDelay * pow(2, exponent), kSPEmitterRetryMaxDelay);
+    double jitter = (double)arc4random_uniform(1000) / 1000.0;
+    return delay / 2 + jitter * delay / 2;
+}
+
 - (NSArray<SPRequest *> *)buildRequestsFromEvents:(NSArray<SPEmitterEvent *> *)events {
     NSMutableArray<SPRequest *> *requests = [NSMutableArray new];
     NSNumber *sendingTime = [SPUtilities getTimestamp];
@@ -377,9 +952,14 @@ const NSUInteger POST_WRAPPER_BYTES = 88;
             [requests addObject:request];
         }
     } else {
+        BOOL isCompressed = [self isPostCompressed];
         for (int i = 0; i < events.count; i += _bufferOption) {
             NSMutableArray<SPPayload *> *eventArray = [NSMutableArray new];
             NSMutableArray<NSNumber *> *indexArray = [NSMutableArray new];
+            // Running total of the payloads in eventArray, so each payload is measured only once.
+            NSUInteger eventArrayByteSize = 0;
+            // Running compressed size of eventArray, created once the batch is over the limit uncompressed.
+            SPGzipSizeEstimator *estimator = nil;
             
             for (int j = i; j < (i + _bufferOption) && j < events.count; j++) {
                 SPEmitterEvent *event = events[j];
@@ -387,27 +967,33 @@ const NSUInteger POST_WRAPPER_BYTES = 88;
                 SPPayload *payload = event.payload;
                 NSNumber *emitterEventId = @(event.storeId);
                 [self addSendingTimeToPayload:payload timestamp:sendingTime];
+                NSUInteger payloadByteSize = payload.byteSize;
 
-                if ([self isOversize:payload]) {
+                if ([self isOversize:payloadByteSize byteLimit:_byteLimitPost previousByteSize:0 previousCount:0]
+                    && (!isCompressed || [self isCompressedOversize:@[payload]])) {
                     SPRequest *request = [[SPRequest alloc] initWithPayload:payload emitterEventId:emitterEventId.longLongValue oversize:YES];
                     [requests addObject:request];
 
-                } else if ([self isOversize:payload previousPayloads:eventArray]) {
+                } else if ([self isBatchOversize:eventArray byteSize:eventArrayByteSize addingPayload:payload payloadByteSize:payloadByteSize
+                                       compressed:isCompressed estimator:&estimator]) {
                     SPRequest *request = [[SPRequest alloc] initWithPayloads:eventArray emitterEventIds:indexArray];
                     [requests addObject:request];
 
                     // Clear collection and build a new POST
                     eventArray = [NSMutableArray new];
                     indexArray = [NSMutableArray new];
+                    estimator = nil;
                     
                     // Build and store the request
                     [eventArray addObject:payload];
                     [indexArray addObject:emitterEventId];
+                    eventArrayByteSize = payloadByteSize;
                     
                 } else {
                     // Add event to collections
                     [eventArray addObject:payload];
                     [indexArray addObject:emitterEventId];
+                    eventArrayByteSize += payloadByteSize;
                 }
             }
             
@@ -422,25 +1008,80 @@ const NSUInteger POST_WRAPPER_BYTES = 88;
 }
 
 - (BOOL)isOversize:(SPPayload *)payload {
-    return [self isOversize:payload previousPayloads:[NSArray array]];
+    NSUInteger byteLimit = _networkConnection.httpMethod == SPHttpMethodGet ? _byteLimitGet : _byteLimitPost;
+    return [self isOversize:payload.byteSize byteLimit:byteLimit previousByteSize:0 previousCount:0];
 }
 
-- (BOOL)isOversize:(SPPayload *)payload previousPayloads:(NSArray<SPPayload *> *)previousPayloads {
-    NSUInteger byteLimit = _networkConnection.httpMethod == SPHttpMethodGet ? _byteLimitGet : _byteLimitPost;
-    return [self isOversize:payload byteLimit:byteLimit previousPayloads:previousPayloads];
+- (BOOL)isOversize:(NSUInteger)byteSize byteLimit:(NSUInteger)byteLimit previousByteSize:(NSUInteger)previousByteSize previousCount:(NSUInteger)previousCount {
+    NSUInteger totalByteSize = byteSize + previousByteSize;
+    NSUInteger wrapperBytes = previousCount > 0 ? (previousCount + POST_WRAPPER_BYTES) : 0;
+    return totalByteSize + wrapperBytes > byteLimit;
+}
+
+/*!
+ @brief Whether POST bodies are going to be gzipped by the network connection.
+ Only the default connection is configured by the emitter, custom ones send the body as they see fit.
+ */
+- (BOOL)isPostCompressed {
+    return _requestCompression && [_networkConnection isKindOfClass:[SPDefaultNetworkConnection class]];
 }
 
-- (BOOL)isOversize:(SPPayload *)payload byteLimit:(NSUInteger)byteLimit previousPayloads:(NSArray<SPPayload *> *)previousPayloads {
-    NSUInteger totalByteSize = payload.byteSize;
-    for (SPPayload *previousPayload in previousPayloads) {
-        totalByteSize += previousPayload.byteSize;
+/*!
+ @brief Checks the byte limit against the size the payloads will have once compressed.
+ It's only called when the uncompressed size is already over the limit, so the (bounded by the buffer option)
+ compression cost is paid only by batches that wouldn't fit otherwise.
+ */
+/*!
+ @brief Whether adding the payload takes the batch over the POST byte limit.
+ When compressed, the size of the batch is tracked by a running gzip stream created the first time
+ the batch is over the limit uncompressed, so the batch isn't compressed again for every payload.
+ The payload is appended to the estimator, which must be discarded if the batch is oversize.
+ */
+- (BOOL)isBatchOversize:(NSArray<SPPayload *> *)payloads
+               byteSize:(NSUInteger)byteSize
+          addingPayload:(SPPayload *)payload
+        payloadByteSize:(NSUInteger)payloadByteSize
+             compressed:(BOOL)isCompressed
+              estimator:(SPGzipSizeEstimator * __strong *)estimator {
+    if (!payloads.count || ![self isOversize:payloadByteSize byteLimit:_byteLimitPost previousByteSize:byteSize previousCount:payloads.count]) {
+        return NO;
     }
-    NSUInteger wrapperBytes = previousPayloads.count > 0 ? (previousPayloads.count + POST_WRAPPER_BYTES) : 0;
-    return totalByteSize + wrapperBytes > byteLimit;
+    if (!isCompressed) {
+        return YES;
+    }
+    if (!*estimator) {
+        // The JSON of the batch without the closing `]}`, so that the next payloads can be appended.
+        NSData *jsonData = [[SPRequest alloc] initWithPayloads:payloads emitterEventIds:@[]].jsonData;
+        *estimator = [SPGzipSizeEstimator new];
+        if (![*estimator appendData:[jsonData subdataWithRange:NSMakeRange(0, jsonData.length - 2)]]) {
+            return [self isCompressedOversize:[payloads arrayByAddingObject:payload]];
+        }
+    }
+    NSMutableData *data = [NSMutableData dataWithCapacity:payloadByteSize + 1];
+    [data appendBytes:"," length:1];
+    [data appendData:payload.jsonData];
+    if (![*estimator appendData:data]) {
+        return [self isCompressedOversize:[payloads arrayByAddingObject:payload]];
+    }
+    NSUInteger uncompressedSize = (*estimator).uncompressedSize + 2;
+    if (uncompressedSize < _compressionThreshold) {
+        return uncompressedSize > _byteLimitPost;
+    }
+    return (*estimator).compressedSize + 2 > _byteLimitPost;
+}
+
+- (BOOL)isCompressedOversize:(NSArray<SPPayload *> *)payloads {
+    NSData *jsonData = [[SPRequest alloc] initWithPayloads:payloads emitterEventIds:@[]].jsonData;
+    if (jsonData.length < _compressionThreshold) {
+        return jsonData.length > _byteLimitPost;
+    }
+    NSData *compressedData = [SPUtilities gzipCompressData:jsonData];
+    NSUInteger byteSize = compressedData ? compressedData.length : jsonData.length;
+    return byteSize > _byteLimitPost;
 }
 
 - (void)addSendingTimeToPayload:(SPPayload *)payload timestamp:(NSNumber *)timestamp {
-    [payload addValueToPayload:[NSString stringWithFormat:@"%lld", timestamp.longLongValue] forKey:kSPSentTimestamp];
+    [payload appendValueToPayload:[NSString stringWithFormat:@"%lld", timestamp.longLongValue] forNewKey:kSPSentTimestamp];
 }
 
 // MARK: - Getters
@@ -449,6 +1090,20 @@ const NSUInteger POST_WRAPPER_BYTES = 88;
     return _networkConnection.url;
 }
 
+- (SPEmitterMetrics *)metrics {
+    NSDate *oldestEventDate;
+    @synchronized (self) {
+        oldestEventDate = _oldestEventDate;
+    }
+    NSInteger queuedEventCount = [self getDbCount];
+    NSTimeInterval oldestEventAge = (queuedEventCount && oldestEventDate) ? MAX(-[oldestEventDate timeIntervalSinceNow], 0) : 0;
+    return [_metricsRecorder metricsWithQueuedEventCount:queuedEventCount oldestEventAge:oldestEventAge];
+}
+
+- (void)resetMetrics {
+    [_metricsRecorder reset];
+}
+
 - (NSUInteger) getDbCount {
     return [_eventStore count];
 }
@@ -457,8 +1112,30 @@ const NSUInteger POST_WRAPPER_BYTES = 88;
     return _isSending;
 }
 
+- (BOOL) isBackingOff {
+    @synchronized (self) {
+        return _retryTimer != nil;
+    }
+}
+
+- (NSUInteger) retryAttempts {
+    @synchronized (self) {
+        return _retryAttempts;
+    }
+}
+
+- (NSDate *) nextRetryDate {
+    @synchronized (self) {
+        return _nextRetryDate;
+    }
+}
+
 - (void) dealloc {
     [self pauseTimer];
+    [self cancelRetryTimer];
+    if (_batchingTimer) {
+        dispatch_source_cancel(_batchingTimer);
+    }
 }
 
 @end
@@ -36,6 +36,20 @@ SP_DIRTYFLAG(emitRange)
 SP_DIRTYFLAG(threadPoolSize)
 SP_DIRTYFLAG(customRetryForStatusCodes)
 SP_DIRTYFLAG(serverAnonymisation)
+SP_DIRTYFLAG(requestCompression)
+SP_DIRTYFLAG(compressionThreshold)
+SP_DIRTYFLAG(batchingDelay)
+SP_DIRTYFLAG(batchingEventCount)
+SP_DIRTYFLAG(batchingByteSize)
+SP_DIRTYFLAG(immediateFlushEvents)
+SP_DIRTYFLAG(maxStoredEvents)
+SP_DIRTYFLAG(maxStoredBytes)
+SP_DIRTYFLAG(maxEventAge)
+SP_DIRTYFLAG(evictionPolicy)
+SP_DIRTYFLAG(eventPriorities)
+SP_DIRTYFLAG(evictableEvents)
+SP_DIRTYFLAG(maxSendAttempts)
+SP_DIRTYFLAG(bisectFailedBatches)
 
 @end
 
@@ -33,5 +33,19 @@ SP_DIRTY_GETTER(NSInteger, byteLimitGet)
 SP_DIRTY_GETTER(NSInteger, byteLimitPost)
 SP_DIRTY_GETTER(NSDictionary *, customRetryForStatusCodes)
 SP_DIRTY_GETTER(BOOL, serverAnonymisation)
+SP_DIRTY_GETTER(BOOL, requestCompression)
+SP_DIRTY_GETTER(NSInteger, compressionThreshold)
+SP_DIRTY_GETTER(NSTimeInterval, batchingDelay)
+SP_DIRTY_GETTER(NSInteger, batchingEventCount)
+SP_DIRTY_GETTER(NSInteger, batchingByteSize)
+SP_DIRTY_GETTER(NSArray *, immediateFlushEvents)
+SP_DIRTY_GETTER(NSInteger, maxStoredEvents)
+SP_DIRTY_GETTER(NSInteger, maxStoredBytes)
+SP_DIRTY_GETTER(NSTimeInterval, maxEventAge)
+SP_DIRTY_GETTER(SPEvictionPolicy, evictionPolicy)
+SP_DIRTY_GETTER(NSDictionary *, eventPriorities)
+SP_DIRTY_GETTER(NSArray *, evictableEvents)
+SP_DIRTY_GETTER(NSInteger, maxSendAttempts)
+SP_DIRTY_GETTER(BOOL, bisectFailedBatches)
 
 @end
@@ -21,6 +21,7 @@
 
 #import <Foundation/Foundation.h>
 #import "SPEmitterConfiguration.h"
+#import "SPEmitterMetrics.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -37,6 +38,35 @@ NS_SWIFT_NAME(EmitterController)
  */
 @property (nonatomic, readonly) BOOL isSending;
 
+/**
+ * Whether the emitter is waiting for a scheduled retry because all the requests
+ * of the last emit round failed.
+ * While backing off, new events are stored but not sent until the retry is due or `flush` is called.
+ */
+@property (nonatomic, readonly) BOOL isBackingOff;
+
+/**
+ * Number of consecutive emit rounds where all the requests failed.
+ * The retry delay grows exponentially with it and it's reset as soon as a request succeeds.
+ */
+@property (nonatomic, readonly) NSUInteger retryAttempts;
+
+/**
+ * Date of the next scheduled retry, or nil if the emitter is not backing off.
+ */
+@property (nonatomic, readonly, nullable) NSDate *nextRetryDate;
+
+/**
+ * Snapshot of the emitter activity: request latencies, bytes sent, events per request,
+ * retries by status code, age of the queued events and duration of the emit rounds.
+ */
+@property (nonatomic, readonly) SPEmitterMetrics *metrics;
+
+/**
+ * Clears the counters and samples reported in `metrics`.
+ */
+- (void)resetMetrics;
+
 - (void)flush;
 
 /**
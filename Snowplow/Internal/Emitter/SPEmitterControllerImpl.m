@@ -78,6 +78,146 @@
     return [self.emitter serverAnonymisation];
 }
 
+- (void)setRequestCompression:(BOOL)requestCompression {
+    self.dirtyConfig.requestCompression = requestCompression;
+    self.dirtyConfig.requestCompressionUpdated = YES;
+    [self.emitter setRequestCompression:requestCompression];
+}
+
+- (BOOL)requestCompression {
+    return [self.emitter requestCompression];
+}
+
+- (void)setCompressionThreshold:(NSInteger)compressionThreshold {
+    self.dirtyConfig.compressionThreshold = compressionThreshold;
+    self.dirtyConfig.compressionThresholdUpdated = YES;
+    [self.emitter setCompressionThreshold:compressionThreshold];
+}
+
+- (NSInteger)compressionThreshold {
+    return [self.emitter compressionThreshold];
+}
+
+- (void)setBatchingDelay:(NSTimeInterval)batchingDelay {
+    self.dirtyConfig.batchingDelay = batchingDelay;
+    self.dirtyConfig.batchingDelayUpdated = YES;
+    [self.emitter setBatchingDelay:batchingDelay];
+}
+
+- (NSTimeInterval)batchingDelay {
+    return [self.emitter batchingDelay];
+}
+
+- (void)setBatchingEventCount:(NSInteger)batchingEventCount {
+    self.dirtyConfig.batchingEventCount = batchingEventCount;
+    self.dirtyConfig.batchingEventCountUpdated = YES;
+    [self.emitter setBatchingEventCount:batchingEventCount];
+}
+
+- (NSInteger)batchingEventCount {
+    return [self.emitter batchingEventCount];
+}
+
+- (void)setBatchingByteSize:(NSInteger)batchingByteSize {
+    self.dirtyConfig.batchingByteSize = batchingByteSize;
+    self.dirtyConfig.batchingByteSizeUpdated = YES;
+    [self.emitter setBatchingByteSize:batchingByteSize];
+}
+
+- (NSInteger)batchingByteSize {
+    return [self.emitter batchingByteSize];
+}
+
+- (void)setImmediateFlushEvents:(NSArray<NSString *> *)immediateFlushEvents {
+    self.dirtyConfig.immediateFlushEvents = immediateFlushEvents;
+    self.dirtyConfig.immediateFlushEventsUpdated = YES;
+    [self.emitter setImmediateFlushEvents:immediateFlushEvents];
+}
+
+- (NSArray<NSString *> *)immediateFlushEvents {
+    return [self.emitter immediateFlushEvents];
+}
+
+- (void)setMaxStoredEvents:(NSInteger)maxStoredEvents {
+    self.dirtyConfig.maxStoredEvents = maxStoredEvents;
+    self.dirtyConfig.maxStoredEventsUpdated = YES;
+    [self.emitter setMaxStoredEvents:maxStoredEvents];
+}
+
+- (NSInteger)maxStoredEvents {
+    return [self.emitter maxStoredEvents];
+}
+
+- (void)setMaxStoredBytes:(NSInteger)maxStoredBytes {
+    self.dirtyConfig.maxStoredBytes = maxStoredBytes;
+    self.dirtyConfig.maxStoredBytesUpdated = YES;
+    [self.emitter setMaxStoredBytes:maxStoredBytes];
+}
+
+- (NSInteger)maxStoredBytes {
+    return [self.emitter maxStoredBytes];
+}
+
+- (void)setMaxEventAge:(NSTimeInterval)maxEventAge {
+    self.dirtyConfig.maxEventAge = maxEventAge;
+    self.dirtyConfig.maxEventAgeUpdated = YES;
+    [self.emitter setMaxEventAge:maxEventAge];
+}
+
+- (NSTimeInterval)maxEventAge {
+    return [self.emitter maxEventAge];
+}
+
+- (void)setEvictionPolicy:(SPEvictionPolicy)evictionPolicy {
+    self.dirtyConfig.evictionPolicy = evictionPolicy;
+    self.dirtyConfig.evictionPolicyUpdated = YES;
+    [self.emitter setEvictionPolicy:evictionPolicy];
+}
+
+- (SPEvictionPolicy)evictionPolicy {
+    return [self.emitter evictionPolicy];
+}
+
+- (void)setEventPriorities:(NSDictionary<NSString *, NSNumber *> *)eventPriorities {
+    self.dirtyConfig.eventPriorities = eventPriorities;
+    self.dirtyConfig.eventPrioritiesUpdated = YES;
+    [self.emitter setEventPriorities:eventPriorities];
+}
+
+- (NSDictionary<NSString *, NSNumber *> *)eventPriorities {
+    return [self.emitter eventPriorities];
+}
+
+- (void)setEvictableEvents:(NSArray<NSString *> *)evictableEvents {
+    self.dirtyConfig.evictableEvents = evictableEvents;
+    self.dirtyConfig.evictableEventsUpdated = YES;
+    [self.emitter setEvictableEvents:evictableEvents];
+}
+
+- (NSArray<NSString *> *)evictableEvents {
+    return [self.emitter evictableEvents];
+}
+
+- (void)setMaxSendAttempts:(NSInteger)maxSendAttempts {
+    self.dirtyConfig.maxSendAttempts = maxSendAttempts;
+    self.dirtyConfig.maxSendAttemptsUpdated = YES;
+    [self.emitter setMaxSendAttempts:maxSendAttempts];
+}
+
+- (NSInteger)maxSendAttempts {
+    return [self.emitter maxSendAttempts];
+}
+
+- (void)setBisectFailedBatches:(BOOL)bisectFailedBatches {
+    self.dirtyConfig.bisectFailedBatches = bisectFailedBatches;
+    self.dirtyConfig.bisectFailedBatchesUpdated = YES;
+    [self.emitter setBisectFailedBatches:bisectFailedBatches];
+}
+
+- (BOOL)bisectFailedBatches {
+    return [self.emitter bisectFailedBatches];
+}
+
 - (void)setEmitRange:(NSInteger)emitRange {
     self.dirtyConfig.emitRange = emitRange;
     self.dirtyConfig.emitRangeUpdated = YES;
@@ -121,6 +261,26 @@
     return [self.emitter getSendingStatus];
 }
 
+- (BOOL)isBackingOff {
+    return [self.emitter isBackingOff];
+}
+
+- (NSUInteger)retryAttempts {
+    return [self.emitter retryAttempts];
+}
+
+- (NSDate *)nextRetryDate {
+    return [self.emitter nextRetryDate];
+}
+
+- (SPEmitterMetrics *)metrics {
+    return [self.emitter metrics];
+}
+
+- (void)resetMetrics {
+    [self.emitter resetMetrics];
+}
+
 - (void)pause {
     self.dirtyConfig.isPaused = YES;
     [self.emitter pauseEmit];
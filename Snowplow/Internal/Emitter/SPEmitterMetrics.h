@@ -0,0 +1,73 @@
+//
+//  SPEmitterMetrics.h
+//  Snowplow
+//
+//  Copyright (c) 2013-2022 Snowplow Analytics Ltd. All rights reserved.
+//
+//  This program is licensed to you under the Apache License Version 2.0,
+//  and you may not use this file except in compliance with the Apache License
+//  Version 2.0. You may obtain a copy of the Apache License Version 2.0 at
+//  http://www.apache.org/licenses/LICENSE-2.0.
+//
+//  Unless required by applicable law or agreed to in writing,
+//  software distributed under the Apache License Version 2.0 is distributed on
+//  an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+//  express or implied. See the Apache License Version 2.0 for the specific
+//  language governing permissions and limitations there under.
+//
+//  License: Apache License Version 2.0
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Snapshot of the emitter activity since it was created or since the last `resetMetrics`.
+ * Latencies and durations are in seconds. Percentiles are computed on the most recent samples.
+ */
+NS_SWIFT_NAME(EmitterMetrics)
+@interface SPEmitterMetrics : NSObject
+
+/// Number of requests sent to the collector.
+@property (nonatomic, readonly) NSInteger requestCount;
+/// Number of requests that didn't get a successful response.
+@property (nonatomic, readonly) NSInteger failedRequestCount;
+/// Number of events sent with successful requests.
+@property (nonatomic, readonly) NSInteger sentEventCount;
+
+/// Bytes sent to the collector, after compression.
+@property (nonatomic, readonly) NSInteger bytesSent;
+/// Bytes sent to the collector, before compression.
+@property (nonatomic, readonly) NSInteger uncompressedBytesSent;
+
+/// Average number of events per request.
+@property (nonatomic, readonly) double averageEventsPerRequest;
+/// Largest number of events sent in a single request.
+@property (nonatomic, readonly) NSInteger maxEventsPerRequest;
+
+/// Median time to get the collector response.
+@property (nonatomic, readonly) NSTimeInterval requestLatencyP50;
+/// 90th percentile of the time to get the collector response.
+@property (nonatomic, readonly) NSTimeInterval requestLatencyP90;
+/// 99th percentile of the time to get the collector response.
+@property (nonatomic, readonly) NSTimeInterval requestLatencyP99;
+
+/// Median duration of an emit round (reading events, sending them and removing them from the store).
+@property (nonatomic, readonly) NSTimeInterval emitRoundDurationP50;
+/// 90th percentile of the duration of an emit round.
+@property (nonatomic, readonly) NSTimeInterval emitRoundDurationP90;
+/// Longest emit round.
+@property (nonatomic, readonly) NSTimeInterval emitRoundDurationMax;
+
+/// Number of failed requests scheduled for retry, keyed by HTTP status code (0 for connection errors).
+@property (nonatomic, readonly) NSDictionary<NSNumber *, NSNumber *> *retriesByStatusCode;
+
+/// Number of events waiting in the event store.
+@property (nonatomic, readonly) NSInteger queuedEventCount;
+/// Age of the oldest event waiting in the event store, 0 when the store is empty.
+@property (nonatomic, readonly) NSTimeInterval oldestEventAge;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,68 @@
+//
+//  SPEmitterMetrics.m
+//  Snowplow
+//
+//  Copyright (c) 2013-2022 Snowplow Analytics Ltd. All rights reserved.
+//
+//  This program is licensed to you under the Apache License Version 2.0,
+//  and you may not use this file except in compliance with the Apache License
+//  Version 2.0. You may obtain a copy of the Apache License Version 2.0 at
+//  http://www.apache.org/licenses/LICENSE-2.0.
+//
+//  Unless required by applicable law or agreed to in writing,
+//  software distributed under the Apache License Version 2.0 is distributed on
+//  an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+//  express or implied. See the Apache License Version 2.0 for the specific
+//  language governing permissions and limitations there under.
+//
+//  License: Apache License Version 2.0
+//
+
+#import "SPEmitterMetrics.h"
+#import "SPEmitterMetricsRecorder.h"
+
+@implementation SPEmitterMetrics
+
+- (instancetype)initWithRecorder:(SPEmitterMetricsRecorder *)recorder queuedEventCount:(NSInteger)queuedEventCount oldestEventAge:(NSTimeInterval)oldestEventAge {
+    if (self = [super init]) {
+        _requestCount = recorder.requestCount;
+        _failedRequestCount = recorder.failedRequestCount;
+        _sentEventCount = recorder.sentEventCount;
+        _bytesSent = recorder.bytesSent;
+        _uncompressedBytesSent = recorder.uncompressedBytesSent;
+        _averageEventsPerRequest = recorder.requestCount ? (double)recorder.requestEventCount / recorder.requestCount : 0;
+        _maxEventsPerRequest = recorder.maxEventsPerRequest;
+
+        NSArray<NSNumber *> *latencies = [recorder.requestLatencies sortedArrayUsingSelector:@selector(compare:)];
+        _requestLatencyP50 = [self percentile:0.5 ofSortedSamples:latencies];
+        _requestLatencyP90 = [self percentile:0.9 ofSortedSamples:latencies];
+        _requestLatencyP99 = [self percentile:0.99 ofSortedSamples:latencies];
+
+        NSArray<NSNumber *> *durations = [recorder.emitRoundDurations sortedArrayUsingSelector:@selector(compare:)];
+        _emitRoundDurationP50 = [self percentile:0.5 ofSortedSamples:durations];
+        _emitRoundDurationP90 = [self percentile:0.9 ofSortedSamples:durations];
+        _emitRoundDurationMax = durations.lastObject.doubleValue;
+
+        _retriesByStatusCode = recorder.retriesByStatusCode;
+        _queuedEventCount = queuedEventCount;
+        _oldestEventAge = oldestEventAge;
+    }
+    return self;
+}
+
+/// Nearest-rank percentile.
+- (NSTimeInterval)percentile:(double)percentile ofSortedSamples:(NSArray<NSNumber *> *)samples {
+    if (!samples.count) {
+        return 0;
+    }
+    NSUInteger rank = (NSUInteger)ceil(percentile * samples.count);
+    return samples[MAX(rank, 1) - 1].doubleValue;
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"EmitterMetrics(requests: %@, failed: %@, events: %@, bytes: %@/%@, latency p50/p90/p99: %.3f/%.3f/%.3f, queued: %@)",
+            @(_requestCount), @(_failedRequestCount), @(_sentEventCount), @(_bytesSent), @(_uncompressedBytesSent),
+            _requestLatencyP50, _requestLatencyP90, _requestLatencyP99, @(_queuedEventCount)];
+}
+
+@end
@@ -0,0 +1,62 @@
+//
+//  SPEmitterMetricsRecorder.h
+//  Snowplow
+//
+//  Copyright (c) 2013-2022 Snowplow Analytics Ltd. All rights reserved.
+//
+//  This program is licensed to you under the Apache License Version 2.0,
+//  and you may not use this file except in compliance with the Apache License
+//  Version 2.0. You may obtain a copy of the Apache License Version 2.0 at
+//  http://www.apache.org/licenses/LICENSE-2.0.
+//
+//  Unless required by applicable law or agreed to in writing,
+//  software distributed under the Apache License Version 2.0 is distributed on
+//  an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+//  express or implied. See the Apache License Version 2.0 for the specific
+//  language governing permissions and limitations there under.
+//
+//  License: Apache License Version 2.0
+//
+
+#import <Foundation/Foundation.h>
+#import "SPEmitterMetrics.h"
+#import "SPRequestResult.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Collects the emitter activity. Samples for latencies and durations are kept in fixed size rings
+ * so the memory used doesn't depend on the traffic.
+ */
+@interface SPEmitterMetricsRecorder : NSObject
+
+@property (nonatomic, readonly) NSInteger requestCount;
+@property (nonatomic, readonly) NSInteger failedRequestCount;
+@property (nonatomic, readonly) NSInteger sentEventCount;
+@property (nonatomic, readonly) NSInteger requestEventCount;
+@property (nonatomic, readonly) NSInteger bytesSent;
+@property (nonatomic, readonly) NSInteger uncompressedBytesSent;
+@property (nonatomic, readonly) NSInteger maxEventsPerRequest;
+@property (nonatomic, readonly) NSArray<NSNumber *> *requestLatencies;
+@property (nonatomic, readonly) NSArray<NSNumber *> *emitRoundDurations;
+@property (nonatomic, readonly) NSDictionary<NSNumber *, NSNumber *> *retriesByStatusCode;
+
+- (void)recordRequestResults:(NSArray<SPRequestResult *> *)results;
+
+- (void)recordRetryWithStatusCode:(NSInteger)statusCode;
+
+- (void)recordEmitRoundDuration:(NSTimeInterval)duration;
+
+- (void)reset;
+
+- (SPEmitterMetrics *)metricsWithQueuedEventCount:(NSInteger)queuedEventCount oldestEventAge:(NSTimeInterval)oldestEventAge;
+
+@end
+
+@interface SPEmitterMetrics (SPEmitterMetricsRecorder)
+
+- (instancetype)initWithRecorder:(SPEmitterMetricsRecorder *)recorder queuedEventCount:(NSInteger)queuedEventCount oldestEventAge:(NSTimeInterval)oldestEventAge;
+
+@end
+
+NS_ASSUME_NONNULL_END
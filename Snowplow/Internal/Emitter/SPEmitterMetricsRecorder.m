@@ -0,0 +1,130 @@
+//
+//  SPEmitterMetricsRecorder.m
+//  Snowplow
+//
+//  Copyright (c) 2013-2022 Snowplow Analytics Ltd. All rights reserved.
+//
+//  This program is licensed to you under the Apache License Version 2.0,
+//  and you may not use this file except in compliance with the Apache License
+//  Version 2.0. You may obtain a copy of the Apache License Version 2.0 at
+//  http://www.apache.org/licenses/LICENSE-2.0.
+//
+//  Unless required by applicable law or agreed to in writing,
+//  software distributed under the Apache License Version 2.0 is distributed on
+//  an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+//  express or implied. See the Apache License Version 2.0 for the specific
+//  language governing permissions and limitations there under.
+//
+//  License: Apache License Version 2.0
+//
+
+#import "SPEmitterMetricsRecorder.h"
+
+static const NSUInteger kSPLatencySampleCapacity = 512;
+static const NSUInteger kSPRoundDurationSampleCapacity = 128;
+
+@implementation SPEmitterMetricsRecorder {
+    NSMutableArray<NSNumber *> *_requestLatencies;
+    NSUInteger _requestLatencyIndex;
+    NSMutableArray<NSNumber *> *_emitRoundDurations;
+    NSUInteger _emitRoundDurationIndex;
+    NSMutableDictionary<NSNumber *, NSNumber *> *_retriesByStatusCode;
+}
+
+- (instancetype)init {
+    if (self = [super init]) {
+        [self reset];
+    }
+    return self;
+}
+
+- (void)reset {
+    @synchronized (self) {
+        _requestCount = 0;
+        _failedRequestCount = 0;
+        _sentEventCount = 0;
+        _requestEventCount = 0;
+        _bytesSent = 0;
+        _uncompressedBytesSent = 0;
+        _maxEventsPerRequest = 0;
+        _requestLatencies = [NSMutableArray arrayWithCapacity:kSPLatencySampleCapacity];
+        _requestLatencyIndex = 0;
+        _emitRoundDurations = [NSMutableArray arrayWithCapacity:kSPRoundDurationSampleCapacity];
+        _emitRoundDurationIndex = 0;
+        _retriesByStatusCode = [NSMutableDictionary new];
+    }
+}
+
+- (void)recordRequestResults:(NSArray<SPRequestResult *> *)results {
+    @synchronized (self) {
+        for (SPRequestResult *result in results) {
+            NSInteger eventCount = result.storeIds.count;
+            _requestCount++;
+            _requestEventCount += eventCount;
+            _maxEventsPerRequest = MAX(_maxEventsPerRequest, eventCount);
+            if (result.isSuccessful) {
+                _sentEventCount += eventCount;
+            } else {
+                _failedRequestCount++;
+            }
+            _bytesSent += result.byteSize;
+            _uncompressedBytesSent += result.uncompressedByteSize;
+            if (result.duration > 0) {
+                [self addSample:result.duration to:_requestLatencies index:&_requestLatencyIndex capacity:kSPLatencySampleCapacity];
+            }
+        }
+    }
+}
+
+- (void)recordRetryWithStatusCode:(NSInteger)statusCode {
+    @synchronized (self) {
+        NSNumber *key = @(MAX(statusCode, 0));
+        _retriesByStatusCode[key] = @(_retriesByStatusCode[key].integerValue + 1);
+    }
+}
+
+- (void)recordEmitRoundDuration:(NSTimeInterval)duration {
+    @synchronized (self) {
+        [self addSample:duration to:_emitRoundDurations index:&_emitRoundDurationIndex capacity:kSPRoundDurationSampleCapacity];
+    }
+}
+
+- (SPEmitterMetrics *)metricsWithQueuedEventCount:(NSInteger)queuedEventCount oldestEventAge:(NSTimeInterval)oldestEventAge {
+    @synchronized (self) {
+        return [[SPEmitterMetrics alloc] initWithRecorder:self queuedEventCount:queuedEventCount oldestEventAge:oldestEventAge];
+    }
+}
+
+// MARK: - Getters
+
+- (NSArray<NSNumber *> *)requestLatencies {
+    @synchronized (self) {
+        return _requestLatencies.copy;
+    }
+}
+
+- (NSArray<NSNumber *> *)emitRoundDurations {
+    @synchronized (self) {
+        return _emitRoundDurations.copy;
+    }
+}
+
+- (NSDictionary<NSNumber *, NSNumber *> *)retriesByStatusCode {
+    @synchronized (self) {
+        return _retriesByStatusCode.copy;
+    }
+}
+
+// MARK: - Private methods
+
+/// Appends the sample until the ring is full, then overwrites the oldest one.
+- (void)addSample:(NSTimeInterval)sample to:(NSMutableArray<NSNumber *> *)samples index:(NSUInteger *)index capacity:(NSUInteger)capacity {
+    if (samples.count < capacity) {
+        [samples addObject:@(sample)];
+    } else {
+        samples[*index] = @(sample);
+    }
+    *index = (*index + 1) % capacity;
+}
+
+@end
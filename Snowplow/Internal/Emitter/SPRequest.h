@@ -31,6 +31,8 @@ NS_SWIFT_NAME(Request)
 @property (nonatomic,readonly) NSArray<NSNumber *> *emitterEventIds;
 @property (nonatomic,readonly) BOOL oversize;
 @property (nonatomic,readonly) NSString *customUserAgent;
+/** The payload serialized as JSON. For grouped events the serialized events are concatenated in the payload_data envelope. */
+@property (nonatomic,readonly) NSData *jsonData;
 
 - (instancetype)initWithPayload:(SPPayload *)payload emitterEventId:(long long)emitterEventId;
 
@@ -25,14 +25,17 @@
 
 @interface SPRequest ()
 
-@property (nonatomic,readwrite) SPPayload *payload;
 @property (nonatomic,readwrite) NSArray<NSNumber *> *emitterEventIds;
 @property (nonatomic,readwrite) BOOL oversize;
-@property (nonatomic,readwrite) NSString *customUserAgent;
 
 @end
 
-@implementation SPRequest
+@implementation SPRequest {
+    SPPayload *_payload;
+    NSArray<SPPayload *> *_payloads;
+    NSString *_customUserAgent;
+    BOOL _isCustomUserAgentSet;
+}
 
 - (instancetype)initWithPayload:(SPPayload *)payload emitterEventId:(long long)emitterEventId {
     return [self initWithPayload:payload emitterEventId:emitterEventId oversize:NO];
@@ -40,9 +43,8 @@
 
 - (instancetype)initWithPayload:(SPPayload *)payload emitterEventId:(long long)emitterEventId oversize:(BOOL)oversize {
     if (self = [super init]) {
-        self.payload = payload;
+        _payload = payload;
         self.emitterEventIds = @[[NSNumber numberWithLongLong:emitterEventId]];
-        self.customUserAgent = [self userAgentFromPayload:payload];
         self.oversize = oversize;
     }
     return self;
@@ -50,25 +52,69 @@
 
 - (instancetype)initWithPayloads:(NSArray<SPPayload *> *)payloads emitterEventIds:(NSArray<NSNumber *> *)emitterEventIds {
     if (self = [super init]) {
-        NSString *tempUserAgent = nil;
-        NSMutableArray<NSDictionary<NSString *, NSObject *> *> *payloadData = [NSMutableArray new];
-        for (SPPayload *payload in payloads) {
-            [payloadData addObject:[payload getAsDictionary]];
-            tempUserAgent = [self userAgentFromPayload:payload];
-        }
-        SPSelfDescribingJson *payloadBundle = [[SPSelfDescribingJson alloc] initWithSchema:kSPPayloadDataSchema andData:payloadData];
-        self.payload = [[SPPayload alloc] initWithNSDictionary:[payloadBundle getAsDictionary]];
+        // The payload_data bundle is built lazily as the default network connection only needs jsonData.
+        _payloads = payloads.copy;
         self.emitterEventIds = emitterEventIds;
-        self.customUserAgent = tempUserAgent;
         self.oversize = NO;
     }
     return self;
 }
 
-// MARK: Private methods
+- (SPPayload *)payload {
+    @synchronized (self) {
+        if (!_payload) {
+            NSMutableArray<NSDictionary<NSString *, NSObject *> *> *payloadData = [NSMutableArray new];
+            for (SPPayload *payload in _payloads) {
+                [payloadData addObject:[payload getAsDictionary]];
+            }
+            SPSelfDescribingJson *payloadBundle = [[SPSelfDescribingJson alloc] initWithSchema:kSPPayloadDataSchema andData:payloadData];
+            _payload = [[SPPayload alloc] initWithNSDictionary:[payloadBundle getAsDictionary]];
+        }
+        return _payload;
+    }
+}
+
+- (NSString *)customUserAgent {
+    @synchronized (self) {
+        if (!_isCustomUserAgentSet) {
+            NSArray<SPPayload *> *payloads = _payloads ?: @[_payload];
+            _customUserAgent = [self userAgentFromPayload:payloads.lastObject];
+            _isCustomUserAgentSet = YES;
+        }
+        return _customUserAgent;
+    }
+}
+
+- (NSData *)jsonData {
+    if (!_payloads) {
+        return [self.payload jsonData];
+    }
+    // Splice the already serialized events in the payload_data envelope instead of serializing it again.
+    NSString *prefix = [NSString stringWithFormat:@"{\"%@\":\"%@\",\"%@\":[", kSPSchema, kSPPayloadDataSchema, kSPData];
+    NSData *prefixData = [prefix dataUsingEncoding:NSUTF8StringEncoding];
+    NSUInteger capacity = prefixData.length + _payloads.count + 2;
+    NSMutableArray<NSData *> *payloadsData = [NSMutableArray arrayWithCapacity:_payloads.count];
+    for (SPPayload *payload in _payloads) {
+        NSData *data = [payload jsonData];
+        if (data.length) {
+            [payloadsData addObject:data];
+            capacity += data.length;
+        }
+    }
+    NSMutableData *result = [NSMutableData dataWithCapacity:capacity];
+    [result appendData:prefixData];
+    [payloadsData enumerateObjectsUsingBlock:^(NSData *data, NSUInteger idx, BOOL *stop) {
+        if (idx > 0) {
+            [result appendBytes:"," length:1];
+        }
+        [result appendData:data];
+    }];
+    [result appendBytes:"]}" length:2];
+    return result;
+}
 
 - (NSString *)userAgentFromPayload:(SPPayload *)payload {
-    return (NSString *)[[payload getAsDictionary] valueForKey:kSPUseragent];
+    return [payload stringValueForKey:kSPUseragent];
 }
 
 @end
@@ -30,6 +30,12 @@ NS_SWIFT_NAME(RequestResult)
 @property (nonatomic, readonly) BOOL isOversize;
 /// Returns the stored index array, needed to remove the events after sending.
 @property (nonatomic, readonly) NSArray<NSNumber *> *storeIds;
+/// Time in seconds to get the response from the Collector, 0 if not measured.
+@property (nonatomic) NSTimeInterval duration;
+/// Bytes sent to the Collector (after compression), 0 if not measured.
+@property (nonatomic) NSUInteger byteSize;
+/// Bytes of the request before compression, 0 if not measured.
+@property (nonatomic) NSUInteger uncompressedByteSize;
 
 /**
  * Creates a request result object
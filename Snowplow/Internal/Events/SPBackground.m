@@ -24,7 +24,7 @@
 #import "SPTrackerConstants.h"
 #import "SPUtilities.h"
 
-@interface SPBackground ()
+@interface SPBackground () <NSCopying>
 
 @property (readwrite) NSNumber *index;
 
@@ -53,4 +53,13 @@
 
 }
 
+// --- NSCopying
+
+- (id)copyWithZone:(NSZone *)zone {
+    SPBackground *copy = [[SPBackground allocWithZone:zone] initWithIndex:_index];
+    copy.trueTimestamp = self.trueTimestamp;
+    copy.contexts = [self.contexts mutableCopy];
+    return copy;
+}
+
 @end
@@ -27,7 +27,7 @@
 #import "SPSelfDescribingJson.h"
 #import "SPConsentDocument.h"
 
-@interface SPConsentGranted ()
+@interface SPConsentGranted () <NSCopying>
 
 @property (nonatomic, readwrite) NSString *expiry;
 @property (nonatomic, readwrite) NSString *documentId;
@@ -92,4 +92,16 @@ SP_BUILDER_METHOD(NSArray<SPSelfDescribingJson *> *, documents)
     }
 }
 
+// --- NSCopying
+
+- (id)copyWithZone:(NSZone *)zone {
+    SPConsentGranted *copy = [[SPConsentGranted allocWithZone:zone] initWithExpiry:_expiry documentId:_documentId version:_version];
+    copy.name = _name;
+    copy.documentDescription = _documentDescription;
+    copy.documents = [_documents copy];
+    copy.trueTimestamp = self.trueTimestamp;
+    copy.contexts = [self.contexts mutableCopy];
+    return copy;
+}
+
 @end
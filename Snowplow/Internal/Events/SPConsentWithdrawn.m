@@ -26,6 +26,9 @@
 #import "SPSelfDescribingJson.h"
 #import "SPConsentDocument.h"
 
+@interface SPConsentWithdrawn () <NSCopying>
+@end
+
 @implementation SPConsentWithdrawn
 
 - (instancetype)init {
@@ -79,5 +82,20 @@ SP_BUILDER_METHOD(NSArray<SPSelfDescribingJson *> *, documents)
     }
 }
 
+// --- NSCopying
+
+- (id)copyWithZone:(NSZone *)zone {
+    SPConsentWithdrawn *copy = [[SPConsentWithdrawn allocWithZone:zone] init];
+    copy.all = _all;
+    copy.documentId = _documentId;
+    copy.version = _version;
+    copy.name = _name;
+    copy.documentDescription = _documentDescription;
+    copy.documents = [_documents copy];
+    copy.trueTimestamp = self.trueTimestamp;
+    copy.contexts = [self.contexts mutableCopy];
+    return copy;
+}
+
 @end
 
@@ -24,7 +24,7 @@
 #import "SPPayload.h"
 #import "SPSelfDescribingJson.h"
 
-@interface SPDeepLinkReceived ()
+@interface SPDeepLinkReceived () <NSCopying>
 
 @property (nonatomic, nonnull, readwrite) NSString *url;
 
@@ -62,5 +62,15 @@ SP_BUILDER_METHOD(NSString *, referrer)
     return payload;
 }
 
+// --- NSCopying
+
+- (id)copyWithZone:(NSZone *)zone {
+    SPDeepLinkReceived *copy = [[SPDeepLinkReceived allocWithZone:zone] initWithUrl:_url];
+    copy.referrer = _referrer;
+    copy.trueTimestamp = self.trueTimestamp;
+    copy.contexts = [self.contexts mutableCopy];
+    return copy;
+}
+
 @end
 
@@ -26,7 +26,7 @@
 #import "SPPayload.h"
 #import "SPTracker.h"
 
-@interface SPEcommerce ()
+@interface SPEcommerce () <NSCopying>
 
 @property (nonatomic, readwrite) NSString *orderId;
 @property (nonatomic, readwrite) NSNumber *totalValue;
@@ -87,4 +87,22 @@ SP_BUILDER_METHOD(NSString *, currency)
     }
 }
 
+// --- NSCopying
+
+- (id)copyWithZone:(NSZone *)zone {
+    // The items are tracked after the transaction, so they are copied too.
+    NSArray<SPEcommerceItem *> *items = [[NSArray alloc] initWithArray:_items copyItems:YES];
+    SPEcommerce *copy = [[SPEcommerce allocWithZone:zone] initWithOrderId:_orderId totalValue:_totalValue items:items];
+    copy.affiliation = _affiliation;
+    copy.taxValue = _taxValue;
+    copy.shipping = _shipping;
+    copy.city = _city;
+    copy.state = _state;
+    copy.country = _country;
+    copy.currency = _currency;
+    copy.trueTimestamp = self.trueTimestamp;
+    copy.contexts = [self.contexts mutableCopy];
+    return copy;
+}
+
 @end
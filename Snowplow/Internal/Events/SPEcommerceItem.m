@@ -25,7 +25,7 @@
 #import "SPUtilities.h"
 #import "SPPayload.h"
 
-@interface SPEcommerceItem ()
+@interface SPEcommerceItem () <NSCopying>
 
 @property (nonatomic, readwrite) NSString *sku;
 @property (nonatomic, readwrite) NSNumber *price;
@@ -70,4 +70,17 @@ SP_BUILDER_METHOD(NSString *, orderId)
     return payload;
 }
 
+// --- NSCopying
+
+- (id)copyWithZone:(NSZone *)zone {
+    SPEcommerceItem *copy = [[SPEcommerceItem allocWithZone:zone] initWithSku:_sku price:_price quantity:_quantity];
+    copy.name = _name;
+    copy.category = _category;
+    copy.currency = _currency;
+    copy.orderId = _orderId;
+    copy.trueTimestamp = self.trueTimestamp;
+    copy.contexts = [self.contexts mutableCopy];
+    return copy;
+}
+
 @end
@@ -25,7 +25,7 @@
 #import "SPUtilities.h"
 #import "SPSelfDescribingJson.h"
 
-@interface SPForeground ()
+@interface SPForeground () <NSCopying>
 
 @property (readwrite) NSNumber *index;
 
@@ -52,4 +52,13 @@
     return payload;
 }
 
+// --- NSCopying
+
+- (id)copyWithZone:(NSZone *)zone {
+    SPForeground *copy = [[SPForeground allocWithZone:zone] initWithIndex:_index];
+    copy.trueTimestamp = self.trueTimestamp;
+    copy.contexts = [self.contexts mutableCopy];
+    return copy;
+}
+
 @end
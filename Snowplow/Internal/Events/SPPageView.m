@@ -25,7 +25,7 @@
 #import "SPUtilities.h"
 #import "SPPayload.h"
 
-@interface SPPageView ()
+@interface SPPageView () <NSCopying>
 
 @property (nonatomic, readwrite) NSString *pageUrl;
 
@@ -60,4 +60,15 @@ SP_BUILDER_METHOD(NSString *, referrer)
     return payload;
 }
 
+// --- NSCopying
+
+- (id)copyWithZone:(NSZone *)zone {
+    SPPageView *copy = [[SPPageView allocWithZone:zone] initWithPageUrl:_pageUrl];
+    copy.pageTitle = _pageTitle;
+    copy.referrer = _referrer;
+    copy.trueTimestamp = self.trueTimestamp;
+    copy.contexts = [self.contexts mutableCopy];
+    return copy;
+}
+
 @end
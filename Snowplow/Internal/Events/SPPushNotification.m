@@ -25,7 +25,7 @@
 #import "SPUtilities.h"
 
 
-@interface SPPushNotification ()
+@interface SPPushNotification () <NSCopying>
 
 @property NSString *date;
 @property NSString *action;
@@ -107,6 +107,15 @@
     };
 }
 
+// --- NSCopying
+
+- (id)copyWithZone:(NSZone *)zone {
+    SPPushNotification *copy = [[SPPushNotification allocWithZone:zone] initWithDate:_date action:_action trigger:_trigger category:_category thread:_thread notification:_notification];
+    copy.trueTimestamp = self.trueTimestamp;
+    copy.contexts = [self.contexts mutableCopy];
+    return copy;
+}
+
 @end
 
 
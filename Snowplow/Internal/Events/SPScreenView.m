@@ -28,7 +28,7 @@
 #import "SPScreenState.h"
 
 
-@interface SPScreenView ()
+@interface SPScreenView () <NSCopying>
 
 @property (nonatomic, readwrite) NSString *name;
 @property (nonatomic, readwrite) NSString *screenId;
@@ -75,4 +75,20 @@ SP_BUILDER_METHOD(NSString *, topViewControllerClassName)
     return payload;
 }
 
+// --- NSCopying
+
+- (id)copyWithZone:(NSZone *)zone {
+    SPScreenView *copy = [[SPScreenView allocWithZone:zone] initWithName:_name screenId:[[NSUUID alloc] initWithUUIDString:_screenId]];
+    copy.type = _type;
+    copy.previousName = _previousName;
+    copy.previousId = _previousId;
+    copy.previousType = _previousType;
+    copy.transitionType = _transitionType;
+    copy.viewControllerClassName = _viewControllerClassName;
+    copy.topViewControllerClassName = _topViewControllerClassName;
+    copy.trueTimestamp = self.trueTimestamp;
+    copy.contexts = [self.contexts mutableCopy];
+    return copy;
+}
+
 @end
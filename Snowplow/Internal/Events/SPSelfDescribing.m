@@ -26,6 +26,9 @@
 #import "SPPayload.h"
 #import "SPSelfDescribingJson.h"
 
+@interface SPSelfDescribing () <NSCopying>
+@end
+
 @implementation SPSelfDescribing {
     SPSelfDescribingJson * _eventData;
     NSString * _schema;
@@ -65,4 +68,16 @@
     return _payload;
 }
 
+// --- NSCopying
+
+- (id)copyWithZone:(NSZone *)zone {
+    // The payload has been validated when the event was created.
+    SPSelfDescribing *copy = [[SPSelfDescribing allocWithZone:zone] initWithSchema:_schema payload:@{}];
+    copy->_payload = [_payload copy];
+    copy->_eventData = _eventData;
+    copy.trueTimestamp = self.trueTimestamp;
+    copy.contexts = [self.contexts mutableCopy];
+    return copy;
+}
+
 @end
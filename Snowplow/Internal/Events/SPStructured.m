@@ -25,7 +25,7 @@
 #import "SPUtilities.h"
 #import "SPPayload.h"
 
-@interface SPStructured ()
+@interface SPStructured () <NSCopying>
 
 @property (nonatomic, readwrite) NSString *category;
 @property (nonatomic, readwrite) NSString *action;
@@ -66,4 +66,16 @@ SP_BUILDER_METHOD(NSNumber *, value)
     return payload;
 }
 
+// --- NSCopying
+
+- (id)copyWithZone:(NSZone *)zone {
+    SPStructured *copy = [[SPStructured allocWithZone:zone] initWithCategory:_category action:_action];
+    copy.label = _label;
+    copy.property = _property;
+    copy.value = _value;
+    copy.trueTimestamp = self.trueTimestamp;
+    copy.contexts = [self.contexts mutableCopy];
+    return copy;
+}
+
 @end
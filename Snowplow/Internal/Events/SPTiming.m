@@ -26,7 +26,7 @@
 #import "SPSelfDescribingJson.h"
 
 
-@interface SPTiming ()
+@interface SPTiming () <NSCopying>
 
 @property (nonatomic, readwrite) NSString *category;
 @property (nonatomic, readwrite) NSString *variable;
@@ -66,4 +66,14 @@ SP_BUILDER_METHOD(NSString *, label)
     return payload;
 }
 
+// --- NSCopying
+
+- (id)copyWithZone:(NSZone *)zone {
+    SPTiming *copy = [[SPTiming allocWithZone:zone] initWithCategory:_category variable:_variable timing:_timing];
+    copy.label = _label;
+    copy.trueTimestamp = self.trueTimestamp;
+    copy.contexts = [self.contexts mutableCopy];
+    return copy;
+}
+
 @end
@@ -26,7 +26,7 @@ const int kMaxMessageLength = 2048;
 const int kMaxStackLength = 8192;
 const int kMaxExceptionNameLength = 1024;
 
-@interface SPTrackerError ()
+@interface SPTrackerError () <NSCopying>
 
 @property (nonatomic) NSString *source;
 @property (nonatomic) NSString *message;
@@ -81,4 +81,13 @@ const int kMaxExceptionNameLength = 1024;
     return [s substringToIndex:MIN(s.length, maxLength)];
 }
 
+// --- NSCopying
+
+- (id)copyWithZone:(NSZone *)zone {
+    SPTrackerError *copy = [[SPTrackerError allocWithZone:zone] initWithSource:_source message:_message error:_error exception:_exception];
+    copy.trueTimestamp = self.trueTimestamp;
+    copy.contexts = [self.contexts mutableCopy];
+    return copy;
+}
+
 @end
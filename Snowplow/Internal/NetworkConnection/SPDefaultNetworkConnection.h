@@ -41,7 +41,7 @@ NS_SWIFT_NAME(DefaultNetworkConnectionBuilder)
 
 /*!
  @brief Builder method to set thread pool size.
- @param emitThreadPoolSize The number of threads used by the emitter.
+ @param emitThreadPoolSize The maximum number of concurrent connections opened to the collector.
  */
 - (void) setEmitThreadPoolSize:(NSUInteger)emitThreadPoolSize;
 
@@ -75,6 +75,18 @@ NS_SWIFT_NAME(DefaultNetworkConnectionBuilder)
  */
 - (void) setServerAnonymisation:(BOOL)serverAnonymisation;
 
+/*!
+ @brief Builder method to enable gzip compression of POST requests.
+ @param requestCompression Whether to compress the POST body and send it with `Content-Encoding: gzip`.
+ */
+- (void) setRequestCompression:(BOOL)requestCompression;
+
+/*!
+ @brief Builder method to set the minimum size of a POST body before it gets compressed.
+ @param compressionThreshold Minimum size in bytes of the body to compress.
+ */
+- (void) setCompressionThreshold:(NSUInteger)compressionThreshold;
+
 @end
 
 NS_SWIFT_NAME(DefaultNetworkConnection)
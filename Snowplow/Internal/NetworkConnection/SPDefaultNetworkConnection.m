@@ -34,8 +34,10 @@
     NSString *_customPostPath;
     NSDictionary<NSString *, NSString *> *_requestHeaders;
     BOOL _serverAnonymisation;
+    BOOL _requestCompression;
+    NSUInteger _compressionThreshold;
 
-    NSOperationQueue *_dataOperationQueue;
+    NSURLSession *_urlSession;
     NSURL *_urlEndpoint;
     BOOL _builderFinished;
 }
@@ -58,9 +60,11 @@
         _byteLimitPost = 40000;
         _customPostPath = nil;
         _requestHeaders = nil;
-        _dataOperationQueue = [[NSOperationQueue alloc] init];
+        _urlSession = nil;
         _builderFinished = NO;
         _serverAnonymisation = NO;
+        _requestCompression = NO;
+        _compressionThreshold = 1024;
     }
     return self;
 }
@@ -121,9 +125,14 @@
 }
 
 - (void)setEmitThreadPoolSize:(NSUInteger)emitThreadPoolSize {
-    _emitThreadPoolSize = emitThreadPoolSize;
-    if (_dataOperationQueue.maxConcurrentOperationCount != emitThreadPoolSize) {
-        _dataOperationQueue.maxConcurrentOperationCount = _emitThreadPoolSize;
+    @synchronized (self) {
+        if (_emitThreadPoolSize == emitThreadPoolSize) {
+            return;
+        }
+        _emitThreadPoolSize = emitThreadPoolSize;
+        // The connection limit can't be changed on a live session: in-flight tasks complete on the old one.
+        [_urlSession finishTasksAndInvalidate];
+        _urlSession = nil;
     }
 }
 
@@ -147,6 +156,14 @@
     _serverAnonymisation = serverAnonymisation;
 }
 
+- (void)setRequestCompression:(BOOL)requestCompression {
+    _requestCompression = requestCompression;
+}
+
+- (void)setCompressionThreshold:(NSUInteger)compressionThreshold {
+    _compressionThreshold = compressionThreshold;
+}
+
 // MARK: - Implement SPNetworkConnection protocol
 
 - (SPHttpMethod)httpMethod {
@@ -158,50 +175,85 @@
 }
 
 - (NSArray<SPRequestResult *> *)sendRequests:(NSArray<SPRequest *> *)requests {
+    __block NSArray<SPRequestResult *> *sendResults = nil;
+    dispatch_semaphore_t sem = dispatch_semaphore_create(0);
+    [self sendRequests:requests completion:^(NSArray<SPRequestResult *> *results) {
+        sendResults = results;
+        dispatch_semaphore_signal(sem);
+    }];
+    dispatch_semaphore_wait(sem, DISPATCH_TIME_FOREVER);
+    return sendResults;
+}
+
+- (void)sendRequests:(NSArray<SPRequest *> *)requests completion:(void (^)(NSArray<SPRequestResult *> *))completion {
     NSMutableArray<SPRequestResult *> *results = [NSMutableArray new];
+    NSURLSession *session = [self urlSession];
+    dispatch_group_t group = dispatch_group_create();
     
     for (SPRequest *request in requests) {
         NSMutableURLRequest *urlRequest = _httpMethod == SPHttpMethodGet
         ? [self buildGetRequest:request]
         : [self buildPostRequest:request];
 
-        [_dataOperationQueue addOperationWithBlock:^{
-            //source: https://forums.developer.apple.com/thread/11519
-            __block NSHTTPURLResponse *httpResponse = nil;
-            __block NSError *connectionError = nil;
-            dispatch_semaphore_t sem;
-            
-            sem = dispatch_semaphore_create(0);
-            
-            [[[NSURLSession sharedSession] dataTaskWithRequest:urlRequest
-                                             completionHandler:^(NSData *data, NSURLResponse *urlResponse, NSError *error) {
-                
-                connectionError = error;
-                httpResponse = (NSHTTPURLResponse*)urlResponse;
-                dispatch_semaphore_signal(sem);
-            }] resume];
-            
-            dispatch_semaphore_wait(sem, DISPATCH_TIME_FOREVER);
+        NSUInteger byteSize = _httpMethod == SPHttpMethodGet ? urlRequest.URL.absoluteString.length : urlRequest.HTTPBody.length;
+        NSUInteger uncompressedByteSize = [urlRequest valueForHTTPHeaderField:@"Content-Encoding"] ? request.jsonData.length : byteSize;
 
+        dispatch_group_enter(group);
+        NSDate *startDate = [NSDate date];
+        [[session dataTaskWithRequest:urlRequest
+                    completionHandler:^(NSData *data, NSURLResponse *urlResponse, NSError *error) {
+            NSHTTPURLResponse *httpResponse = (NSHTTPURLResponse *)urlResponse;
             SPRequestResult *result = [[SPRequestResult alloc] initWithStatusCode:[httpResponse statusCode] oversize:request.oversize storeIds:request.emitterEventIds];
+            result.duration = -[startDate timeIntervalSinceNow];
+            result.byteSize = byteSize;
+            result.uncompressedByteSize = uncompressedByteSize;
             if (![result isSuccessful]) {
-                SPLogError(@"Connection error: %@", connectionError);
+                SPLogError(@"Connection error: %@", error);
             }
-
             @synchronized (results) {
                 [results addObject:result];
             }
-        }];
+            dispatch_group_leave(group);
+        }] resume];
     }
-    [_dataOperationQueue waitUntilAllOperationsAreFinished];
-    return results;
+    // Leave the session's delegate queue as soon as possible, the results are processed by the caller.
+    dispatch_group_notify(group, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        completion(results);
+    });
+}
+
+/*!
+ @brief Session dedicated to the collector, so connections (and HTTP/2 streams) are reused across requests
+ and their number is capped by the emit thread pool size instead of the default per-host limit.
+ */
+- (NSURLSession *)urlSession {
+    @synchronized (self) {
+        if (!_urlSession) {
+            NSURLSessionConfiguration *configuration = [NSURLSessionConfiguration defaultSessionConfiguration];
+            configuration.HTTPMaximumConnectionsPerHost = MAX(_emitThreadPoolSize, 1);
+            configuration.URLCache = nil;
+            configuration.requestCachePolicy = NSURLRequestReloadIgnoringLocalCacheData;
+            _urlSession = [NSURLSession sessionWithConfiguration:configuration];
+        }
+        return _urlSession;
+    }
+}
+
+- (void)dealloc {
+    [_urlSession finishTasksAndInvalidate];
 }
 
-// MARK: - Private methods
 
 - (NSMutableURLRequest *)buildPostRequest:(SPRequest *)request {
-    NSData *requestData = [NSJSONSerialization dataWithJSONObject:[request.payload getAsDictionary] options:0 error:nil];
+    NSData *requestData = request.jsonData;
     NSMutableURLRequest *urlRequest = [NSMutableURLRequest requestWithURL:[NSURL URLWithString:_urlEndpoint.absoluteString]];
+    if (_requestCompression && requestData.length >= _compressionThreshold) {
+        NSData *compressedData = [SPUtilities gzipCompressData:requestData];
+        if (compressedData) {
+            requestData = compressedData;
+            [urlRequest setValue:@"gzip" forHTTPHeaderField:@"Content-Encoding"];
+        }
+    }
     [urlRequest setValue:[NSString stringWithFormat:@"%@", @(requestData.length).stringValue] forHTTPHeaderField:@"Content-Length"];
     [urlRequest setValue:kSPAcceptContentHeader forHTTPHeaderField:@"Accept"];
     [urlRequest setValue:kSPContentTypeHeader forHTTPHeaderField:@"Content-Type"];
@@ -59,6 +59,18 @@ NS_SWIFT_NAME(NetworkConnection)
  */
 - (NSArray<SPRequestResult *> *)sendRequests:(NSArray<SPRequest *> *)requests;
 
+@optional
+
+/**
+ * Send requests to the collector without blocking the calling thread.
+ * When implemented, the emitter prefers it over `sendRequests:`.
+ * @param requests to send,
+ * @param completion called once with the results of all the requests.
+ */
+- (void)sendRequests:(NSArray<SPRequest *> *)requests completion:(void (^)(NSArray<SPRequestResult *> *results))completion;
+
+@required
+
 /**
  * @return http method used to send requests to the collector.
  */
@@ -26,6 +26,12 @@ NS_SWIFT_NAME(Payload)
 
 @property (nonatomic) BOOL allowDiagnostic;
 
+/**
+ *  Priority used by the event store when it has to evict events, the lowest priority is evicted first.
+ *  It's not part of the serialized payload.
+ */
+@property (nonatomic) NSInteger priority;
+
 /**
  *  Initializes a newly allocated SPPayload
  *  @return A SnowplowPayload.
@@ -39,6 +45,14 @@ NS_SWIFT_NAME(Payload)
  */
 - (id)initWithNSDictionary:(NSDictionary<NSString *, NSObject *> *)dict;
 
+/**
+ *  Initializes a newly allocated SPPayload with the serialized JSON of a payload.
+ *  The JSON is parsed only if the payload is accessed or modified as a dictionary.
+ *  @param jsonData The JSON object serialized as returned by jsonData.
+ *  @return A SnowplowPayload.
+ */
+- (id)initWithJsonData:(NSData *)jsonData;
+
 /**
  *  Adds a simple name-value pair into the SPPayload intance.
  *  @param value A NSString value
@@ -53,6 +67,15 @@ NS_SWIFT_NAME(Payload)
  */
 - (void) addNumericValueToPayload:(NSNumber *)value forKey:(NSString *)key;
 
+/**
+ *  Adds a name-value pair for a key that is not already in the SPPayload instance.
+ *  When the payload has been initialized with initWithJsonData: the pair is appended to the serialized JSON
+ *  without parsing it, otherwise it behaves like addValueToPayload:forKey:.
+ *  @param value A NSString value
+ *  @param key A key of type NSString that isn't part of the payload
+ */
+- (void) appendValueToPayload:(NSString *)value forNewKey:(NSString *)key;
+
 /**
  *  Adds a dictionary of attributes to be appended into the SPPayload instance. It does NOT overwrite the existing data in the object.
  *  All attribute values must be NSString types to be added; all others are discarded.
@@ -72,6 +95,19 @@ NS_SWIFT_NAME(Payload)
           typeWhenEncoded:(NSString *)typeEncoded
        typeWhenNotEncoded:(NSString *)typeNotEncoded;
 
+/**
+ *  Adds JSON data serialized by the tracker into the SPPayload instance, like addJsonToPayload:base64Encoded:typeWhenEncoded:typeWhenNotEncoded:
+ *  but without parsing the data to check that it's a valid JSON object.
+ *  @param json NSData of a JSON object serialized by the tracker.
+ *  @param encode Boolean option to choose whether the JSON data should be encoded.
+ *  @param typeEncoded If the data is to be encoded, the result will be a value of the key in typeEncoded.
+ *  @param typeNotEncoded If the data is NOT going to be encoded, the result will be a value of the key in typeWhenNotEncoded.
+ */
+- (void) addTrustedJsonToPayload:(NSData *)json
+                   base64Encoded:(Boolean)encode
+                 typeWhenEncoded:(NSString *)typeEncoded
+              typeWhenNotEncoded:(NSString *)typeNotEncoded;
+
 /**
  *  Adds a JSON string of attributes to be appended into the SPPayload instance. Gives you the option to Base64 encode the data before adding it into the object. This method converts the string to NSData and uses the data with addJsonStringToPayload:base64Encoded:typeWhenEncoded:typeWhenNotEncoded:
  *  @param json NSData of JSON-compatible data to be added.
@@ -102,11 +138,35 @@ NS_SWIFT_NAME(Payload)
  */
 - (NSDictionary<NSString *, NSObject *> *) getAsDictionary;
 
+/**
+ * Returns the value of a key as a string without parsing the payload when it has been initialized with initWithJsonData:.
+ * Numeric values are returned as their string representation.
+ * @param key The top-level key of the payload.
+ * @return The value, or nil if the key is missing or its value isn't a string or a number.
+ */
+- (NSString *)stringValueForKey:(NSString *)key;
+
+/**
+ * Returns the payload serialized as JSON.
+ * The serialized data is cached and recomputed only after the payload is modified.
+ * @return NSData of the JSON object.
+ */
+- (NSData *) jsonData;
+
 /**
  * Returns the byte size of a payload.
+ * The size is cached and recomputed only after the payload is modified.
  * @return A long representing the byte size of the payload.
  */
 - (NSUInteger)byteSize;
 
+/**
+ * Checks the structure of serialized JSON without parsing it: a single object whose strings, arrays and objects are balanced.
+ * It doesn't validate the scalar values, but it rejects truncated or concatenated data.
+ * @param data The serialized JSON.
+ * @return Whether the data looks like a well formed JSON object.
+ */
++ (BOOL)isJsonObjectData:(NSData *)data;
+
 @end
 
@@ -23,11 +23,131 @@
 #import "SPPayload.h"
 #import "SPLogger.h"
 #import "SPJSONSerialization.h"
+#import "SPUtilities.h"
 
 #define SPLogPayloadError(issue, format, ...) if (self.allowDiagnostic) SPLogTrack(issue, format, ##__VA_ARGS__); else SPLogError(format, ##__VA_ARGS__)
 
+// MARK: - JSON scanning
+
+/// Returns the index of the first non-whitespace byte from `i`.
+static size_t SPSkipWhitespace(const uint8_t *bytes, size_t length, size_t i) {
+    while (i < length && (bytes[i] == ' ' || bytes[i] == '\n' || bytes[i] == '\r' || bytes[i] == '\t')) {
+        i++;
+    }
+    return i;
+}
+
+/// Returns the index after the string starting at `i`, or 0 if it isn't terminated.
+static size_t SPSkipString(const uint8_t *bytes, size_t length, size_t i, BOOL *hasEscapes) {
+    for (i++; i < length; i++) {
+        if (bytes[i] == '\\') {
+            *hasEscapes = YES;
+            i++;
+        } else if (bytes[i] == '"') {
+            return i + 1;
+        } else if (bytes[i] < 0x20) {
+            return 0;
+        }
+    }
+    return 0;
+}
+
+/// Returns the index after the value starting at `i`, or 0 if it isn't well formed.
+static size_t SPSkipValue(const uint8_t *bytes, size_t length, size_t i) {
+    if (i >= length) {
+        return 0;
+    }
+    BOOL hasEscapes = NO;
+    if (bytes[i] == '"') {
+        return SPSkipString(bytes, length, i, &hasEscapes);
+    }
+    if (bytes[i] != '{' && bytes[i] != '[') {
+        size_t start = i;
+        while (i < length && bytes[i] != ',' && bytes[i] != '}' && bytes[i] != ']' && bytes[i] != ':'
+               && bytes[i] != ' ' && bytes[i] != '\n' && bytes[i] != '\r' && bytes[i] != '\t' && bytes[i] != '"') {
+            i++;
+        }
+        return i > start ? i : 0;
+    }
+    // Objects and arrays only need to be balanced, the tracker serialized them.
+    uint8_t stack[64];
+    size_t depth = 0;
+    while (i < length) {
+        uint8_t c = bytes[i];
+        if (c == '"') {
+            i = SPSkipString(bytes, length, i, &hasEscapes);
+            if (!i) {
+                return 0;
+            }
+            continue;
+        }
+        if (c == '{' || c == '[') {
+            if (depth == sizeof(stack)) {
+                return 0;
+            }
+            stack[depth++] = c == '{' ? '}' : ']';
+        } else if (c == '}' || c == ']') {
+            if (!depth || stack[--depth] != c) {
+                return 0;
+            }
+            if (!depth) {
+                return i + 1;
+            }
+        }
+        i++;
+    }
+    return 0;
+}
+
+/// Finds the value of a top-level key of the serialized JSON object.
+/// The value range is returned without the quotes if the value is a string.
+static BOOL SPFindJsonObjectValue(NSData *data, NSData *key, NSRange *valueRange, BOOL *isString, BOOL *hasEscapes) {
+    const uint8_t *bytes = data.bytes;
+    size_t length = data.length;
+    size_t i = SPSkipWhitespace(bytes, length, 0);
+    if (i >= length || bytes[i] != '{') {
+        return NO;
+    }
+    i = SPSkipWhitespace(bytes, length, i + 1);
+    if (i < length && bytes[i] == '}') {
+        return NO;
+    }
+    while (i < length && bytes[i] == '"') {
+        BOOL keyHasEscapes = NO;
+        size_t keyEnd = SPSkipString(bytes, length, i, &keyHasEscapes);
+        if (!keyEnd) {
+            return NO;
+        }
+        BOOL isKey = !keyHasEscapes && keyEnd - i - 2 == key.length && memcmp(bytes + i + 1, key.bytes, key.length) == 0;
+        i = SPSkipWhitespace(bytes, length, keyEnd);
+        if (i >= length || bytes[i] != ':') {
+            return NO;
+        }
+        i = SPSkipWhitespace(bytes, length, i + 1);
+        size_t valueStart = i;
+        *hasEscapes = NO;
+        i = i < length && bytes[i] == '"' ? SPSkipString(bytes, length, i, hasEscapes) : SPSkipValue(bytes, length, i);
+        if (!i) {
+            return NO;
+        }
+        if (isKey) {
+            *isString = bytes[valueStart] == '"';
+            *valueRange = *isString ? NSMakeRange(valueStart + 1, i - valueStart - 2) : NSMakeRange(valueStart, i - valueStart);
+            return YES;
+        }
+        i = SPSkipWhitespace(bytes, length, i);
+        if (i >= length || bytes[i] != ',') {
+            return NO;
+        }
+        i = SPSkipWhitespace(bytes, length, i + 1);
+    }
+    return NO;
+}
+
 @implementation SPPayload {
     NSMutableDictionary * _payload;
+    NSData * _jsonData;
+    NSMutableSet<NSString *> * _appendedKeys;
 }
 
 - (id) init {
@@ -48,28 +168,65 @@
     return self;
 }
 
+- (id)initWithJsonData:(NSData *)jsonData {
+    self = [super init];
+    if (self) {
+        _jsonData = jsonData.copy;
+        self.allowDiagnostic = YES;
+    }
+    return self;
+}
+
 - (void) addValueToPayload:(NSString *)value forKey:(NSString *)key {
     if ([value length] == 0) {
         @synchronized (self) {
-            if ([_payload valueForKey:key] != nil) {
-                [_payload removeObjectForKey:key];
+            NSMutableDictionary *payload = [self materializedPayload];
+            if ([payload valueForKey:key] != nil) {
+                [payload removeObjectForKey:key];
+                _jsonData = nil;
             }
         }
         return;
     }
     @synchronized (self) {
-        [_payload setObject:value forKey:key];
+        [[self materializedPayload] setObject:value forKey:key];
+        _jsonData = nil;
     }
 }
 
 - (void) addNumericValueToPayload:(NSNumber *)value forKey:(NSString *)key {
     @synchronized (self) {
+        NSMutableDictionary *payload = [self materializedPayload];
         if (value) {
-            [_payload setObject:value forKey:key];
+            [payload setObject:value forKey:key];
+            _jsonData = nil;
+        }
+        else if ([payload valueForKey:key]) {
+            [payload removeObjectForKey:key];
+            _jsonData = nil;
+        }
+    }
+}
+
+- (void) appendValueToPayload:(NSString *)value forNewKey:(NSString *)key {
+    @synchronized (self) {
+        const char *bytes = _jsonData.bytes;
+        BOOL canAppend = !_payload && _jsonData.length >= 2 && bytes[_jsonData.length - 1] == '}' && ![_appendedKeys containsObject:key];
+        NSData *pair = canAppend && value.length ? [SPJSONSerialization serializeDictionary:@{key: value}] : nil;
+        if (!pair) {
+            [self addValueToPayload:value forKey:key];
+            return;
         }
-        else if ([_payload valueForKey:key]) {
-            [_payload removeObjectForKey:key];
+        // Replace the closing brace of the stored JSON with `,"key":"value"}`.
+        NSMutableData *data = [NSMutableData dataWithCapacity:_jsonData.length + pair.length];
+        [data appendBytes:bytes length:_jsonData.length - 1];
+        if (_jsonData.length > 2) {
+            [data appendBytes:"," length:1];
         }
+        [data appendBytes:(const char *)pair.bytes + 1 length:pair.length - 1];
+        _jsonData = data;
+        _appendedKeys = _appendedKeys ?: [NSMutableSet new];
+        [_appendedKeys addObject:key];
     }
 }
 
@@ -90,20 +247,19 @@
     if (!object) {
         return;
     }
+    [self addTrustedJsonToPayload:json
+                    base64Encoded:encode
+                  typeWhenEncoded:typeEncoded
+               typeWhenNotEncoded:typeNotEncoded];
+}
+
+- (void) addTrustedJsonToPayload:(NSData *)json
+                   base64Encoded:(Boolean)encode
+                 typeWhenEncoded:(NSString *)typeEncoded
+              typeWhenNotEncoded:(NSString *)typeNotEncoded {
     if (encode) {
-        NSString *encodedString = [json base64EncodedStringWithOptions:0];
-        
-        // We need URL safe with no padding. Since there is no built-in way to do this, we transform
-        // the encoded payload to make it URL safe by replacing chars that are different in the URL-safe
-        // alphabet. Namely, 62 is - instead of +, and 63 _ instead of /.
-        // See: https://tools.ietf.org/html/rfc4648#section-5
-        encodedString = [[encodedString stringByReplacingOccurrencesOfString:@"/" withString:@"_"]
-                         stringByReplacingOccurrencesOfString:@"+" withString:@"-"];
-        
-        // There is also no padding since the length is implicitly known.
-        encodedString = [encodedString stringByTrimmingCharactersInSet:[NSCharacterSet characterSetWithCharactersInString:@"="]];
-        
-        [self addValueToPayload:encodedString forKey:typeEncoded];
+        // URL safe with no padding, see: https://tools.ietf.org/html/rfc4648#section-5
+        [self addValueToPayload:[SPUtilities base64UrlEncodedStringWithData:json] forKey:typeEncoded];
     } else {
         [self addValueToPayload:[[NSString alloc] initWithData:json encoding:NSUTF8StringEncoding] forKey:typeNotEncoded];
     }
@@ -130,30 +286,96 @@
     if (!data) {
         return;
     }
-    [self addJsonToPayload:data
-             base64Encoded:encode
-           typeWhenEncoded:typeEncoded
-        typeWhenNotEncoded:typeNotEncoded];
+    // Serialized from a dictionary, so it doesn't need to be validated.
+    [self addTrustedJsonToPayload:data
+                    base64Encoded:encode
+                  typeWhenEncoded:typeEncoded
+               typeWhenNotEncoded:typeNotEncoded];
 }
 
 - (NSDictionary<NSString *, NSObject *> *) getAsDictionary {
     @synchronized (self) {
-        return _payload;
+        return [self materializedPayload];
     }
 }
 
-- (NSUInteger)byteSize {
-    if (!_payload) {
-        return 0;
+- (NSString *)stringValueForKey:(NSString *)key {
+    NSData *jsonData = nil;
+    @synchronized (self) {
+        if (_payload || !_jsonData) {
+            NSObject *value = [_payload objectForKey:key];
+            if ([value isKindOfClass:[NSString class]]) {
+                return (NSString *)value;
+            }
+            return [value isKindOfClass:[NSNumber class]] ? [(NSNumber *)value stringValue] : nil;
+        }
+        jsonData = _jsonData;
+    }
+    // The stored bytes are immutable, they are scanned outside of the lock.
+    NSRange range;
+    BOOL isString = NO;
+    BOOL hasEscapes = NO;
+    if (!SPFindJsonObjectValue(jsonData, [key dataUsingEncoding:NSUTF8StringEncoding], &range, &isString, &hasEscapes)) {
+        return nil;
     }
-    NSData *data = nil;
+    const uint8_t *bytes = jsonData.bytes;
+    if (isString && !hasEscapes) {
+        return [[NSString alloc] initWithBytes:bytes + range.location length:range.length encoding:NSUTF8StringEncoding];
+    }
+    if (!isString && (bytes[range.location] != '-' && (bytes[range.location] < '0' || bytes[range.location] > '9'))) {
+        return nil;
+    }
+    // Escaped strings and numbers are decoded by the JSON parser, wrapped in an array.
+    NSMutableData *array = [NSMutableData dataWithCapacity:range.length + 4];
+    [array appendBytes:"[" length:1];
+    if (isString) {
+        [array appendBytes:"\"" length:1];
+    }
+    [array appendBytes:bytes + range.location length:range.length];
+    [array appendBytes:(isString ? "\"]" : "]") length:(isString ? 2 : 1)];
+    NSObject *value = [[NSJSONSerialization JSONObjectWithData:array options:0 error:nil] firstObject];
+    if ([value isKindOfClass:[NSString class]]) {
+        return (NSString *)value;
+    }
+    return [value isKindOfClass:[NSNumber class]] ? [(NSNumber *)value stringValue] : nil;
+}
+
++ (BOOL)isJsonObjectData:(NSData *)data {
+    const uint8_t *bytes = data.bytes;
+    size_t length = data.length;
+    size_t start = SPSkipWhitespace(bytes, length, 0);
+    if (start >= length || bytes[start] != '{') {
+        return NO;
+    }
+    size_t end = SPSkipValue(bytes, length, start);
+    return end && SPSkipWhitespace(bytes, length, end) == length;
+}
+
+- (NSData *)jsonData {
     @synchronized (self) {
-        data = [SPJSONSerialization serializeDictionary:_payload];
-        if (!data) {
-            return 0;
+        // The serialized payload is cached until the next mutation as serializing is expensive.
+        if (!_jsonData) {
+            _jsonData = [SPJSONSerialization serializeDictionary:_payload ?: @{}];
         }
+        return _jsonData;
+    }
+}
+
+- (NSUInteger)byteSize {
+    return [self jsonData].length;
+}
+
+// MARK: - Private methods
+
+/// Parses the serialized JSON the first time the payload is read or modified as a dictionary.
+/// It must be called within a synchronized block.
+- (NSMutableDictionary *)materializedPayload {
+    if (!_payload) {
+        NSDictionary *dictionary = _jsonData ? [SPJSONSerialization deserializeData:_jsonData] : nil;
+        _payload = dictionary.mutableCopy ?: [NSMutableDictionary dictionary];
+        _appendedKeys = nil;
     }
-    return data.length;
+    return _payload;
 }
 
 - (NSString *)description {
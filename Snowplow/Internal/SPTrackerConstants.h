@@ -61,6 +61,10 @@ extern NSString * const kSPInstallationUserId;
 extern NSString * const kSPContentTypeHeader;
 extern NSString * const kSPAcceptContentHeader;
 extern NSInteger  const kSPDefaultBufferTimeout;
+extern NSTimeInterval const kSPEmitterRetryBaseDelay;
+extern NSTimeInterval const kSPEmitterRetryMaxDelay;
+extern NSTimeInterval const kSPEmitterLeaseDuration;
+extern NSUInteger const kSPEmitterMaxConcurrentRounds;
 extern NSString * const kSPEndpointPost;
 extern NSString * const kSPEndpointGet;
 
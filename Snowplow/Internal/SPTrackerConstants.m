@@ -44,6 +44,10 @@ NSString * const kSPInstallationUserId    = @"SPInstallationUserId";
 NSString * const kSPContentTypeHeader     = @"application/json; charset=utf-8";
 NSString * const kSPAcceptContentHeader   = @"text/html, application/x-www-form-urlencoded, text/plain, image/gif";
 NSInteger  const kSPDefaultBufferTimeout  = 60;
+NSTimeInterval const kSPEmitterRetryBaseDelay = 5;
+NSTimeInterval const kSPEmitterRetryMaxDelay  = 600;
+NSTimeInterval const kSPEmitterLeaseDuration  = 300;
+NSUInteger const kSPEmitterMaxConcurrentRounds = 2;
 NSString * const kSPEndpointPost          = @"/com.snowplowanalytics.snowplow/tp2";
 NSString * const kSPEndpointGet           = @"/i";
 
@@ -0,0 +1,60 @@
+//
+//  SPCompactPayloadCodec.h
+//  Snowplow
+//
+//  Copyright (c) 2013-2022 Snowplow Analytics Ltd. All rights reserved.
+//
+//  This program is licensed to you under the Apache License Version 2.0,
+//  and you may not use this file except in compliance with the Apache License
+//  Version 2.0. You may obtain a copy of the Apache License Version 2.0 at
+//  http://www.apache.org/licenses/LICENSE-2.0.
+//
+//  Unless required by applicable law or agreed to in writing,
+//  software distributed under the Apache License Version 2.0 is distributed on
+//  an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+//  express or implied. See the Apache License Version 2.0 for the specific
+//  language governing permissions and limitations there under.
+//
+//  License: Apache License Version 2.0
+//
+
+#import <Foundation/Foundation.h>
+
+@class SPPayload;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Compact binary record format for the stored payloads.
+ *
+ * A record starts with a marker byte (never `{`, so records can be told apart from JSON), the format version
+ * and a flags byte. The fields follow as a list of key and typed value, where the common payload keys from
+ * SPTrackerConstants are replaced by their index in a key dictionary. The fields can be compressed with a
+ * LZ4-style block compression. The key dictionary is append-only: a new key gets a new index and existing
+ * indices are never reused, so the records written by a previous version can still be decoded.
+ */
+@interface SPCompactPayloadCodec : NSObject
+
+/**
+ * Encodes the payload as a compact record.
+ * @param payload The payload to encode.
+ * @param compress Whether to compress the fields when it makes the record smaller.
+ * @return The record, or nil if the payload has values other than strings and numbers.
+ */
++ (nullable NSData *)dataWithPayload:(SPPayload *)payload compress:(BOOL)compress;
+
+/**
+ * Decodes a compact record.
+ * @param data The record.
+ * @return The payload, or nil if the record is corrupted or written by a newer format version.
+ */
++ (nullable SPPayload *)payloadWithData:(NSData *)data;
+
+/**
+ * Whether the data is a compact record rather than JSON.
+ */
++ (BOOL)isCompactData:(NSData *)data;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,394 @@
+//
+//  SPCompactPayloadCodec.m
+//  Snowplow
+//
+//  Copyright (c) 2013-2022 Snowplow Analytics Ltd. All rights reserved.
+//
+//  This program is licensed to you under the Apache License Version 2.0,
+//  and you may not use this file except in compliance with the Apache License
+//  Version 2.0. You may obtain a copy of the Apache License Version 2.0 at
+//  http://www.apache.org/licenses/LICENSE-2.0.
+//
+//  Unless required by applicable law or agreed to in writing,
+//  software distributed under the Apache License Version 2.0 is distributed on
+//  an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+//  express or implied. See the Apache License Version 2.0 for the specific
+//  language governing permissions and limitations there under.
+//
+//  License: Apache License Version 2.0
+//
+
+#import "SPCompactPayloadCodec.h"
+#import "SPPayload.h"
+#import "SPTrackerConstants.h"
+
+static const uint8_t kSPCompactMarker = 0xC5;
+static const uint8_t kSPCompactVersion = 1;
+static const uint8_t kSPCompactFlagCompressed = 1 << 0;
+
+/// Bodies shorter than this are rarely made smaller by the compression.
+static const NSUInteger kSPCompressionThreshold = 64;
+/// Upper bound of a decompressed body, so that a corrupted record can't cause a huge allocation.
+static const uint64_t kSPMaxBodyLength = 16 * 1024 * 1024;
+
+static const int kSPHashBits = 12;
+
+typedef NS_ENUM(uint8_t, SPCompactValueType) {
+    SPCompactValueTypeString = 0,
+    SPCompactValueTypeInteger,
+    SPCompactValueTypeDouble,
+    SPCompactValueTypeTrue,
+    SPCompactValueTypeFalse,
+};
+
+/// Keys replaced by their index + 1 in the records (0 introduces an inline key).
+/// The list is append-only: removing or reordering keys would break the records already stored.
+static NSArray<NSString *> *SPCompactKeys(void) {
+    static NSArray<NSString *> *keys;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        keys = @[
+            kSPEvent, kSPEid, kSPTimestamp, kSPTrueTimestamp, kSPSentTimestamp, kSPTrackerVersion, kSPAppId,
+            kSPNamespace, kSPUid, kSPContext, kSPContextEncoded, kSPUnstructured, kSPUnstructuredEncoded,
+            kSPPlatform, kSPResolution, kSPViewPort, kSPColorDepth, kSPTimezone, kSPLanguage, kSPIpAddress,
+            kSPUseragent, kSPNetworkUid, kSPDomainUid, kSPPageUrl, kSPPageTitle, kSPPageRefr,
+            kSPStuctCategory, kSPStuctAction, kSPStuctLabel, kSPStuctProperty, kSPStuctValue,
+            kSPEcommId, kSPEcommTotal, kSPEcommAffiliation, kSPEcommTax, kSPEcommShipping, kSPEcommCity,
+            kSPEcommState, kSPEcommCountry, kSPEcommCurrency, kSPEcommItemId, kSPEcommItemSku, kSPEcommItemName,
+            kSPEcommItemCategory, kSPEcommItemPrice, kSPEcommItemQuantity, kSPEcommItemCurrency,
+        ];
+    });
+    return keys;
+}
+
+static NSDictionary<NSString *, NSNumber *> *SPCompactKeyIndices(void) {
+    static NSDictionary<NSString *, NSNumber *> *indices;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        NSArray<NSString *> *keys = SPCompactKeys();
+        NSMutableDictionary<NSString *, NSNumber *> *result = [NSMutableDictionary dictionaryWithCapacity:keys.count];
+        for (NSUInteger i = 0; i < keys.count; i++) {
+            result[keys[i]] = @(i + 1);
+        }
+        indices = result;
+    });
+    return indices;
+}
+
+// MARK: - Varints
+
+static void SPAppendVarint(NSMutableData *data, uint64_t value) {
+    uint8_t buffer[10];
+    size_t length = 0;
+    do {
+        uint8_t byte = value & 0x7F;
+        value >>= 7;
+        buffer[length++] = value ? (byte | 0x80) : byte;
+    } while (value);
+    [data appendBytes:buffer length:length];
+}
+
+static BOOL SPReadVarint(const uint8_t *bytes, size_t length, size_t *offset, uint64_t *value) {
+    uint64_t result = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (*offset >= length) {
+            return NO;
+        }
+        uint8_t byte = bytes[(*offset)++];
+        result |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return YES;
+        }
+    }
+    return NO;
+}
+
+static void SPAppendString(NSMutableData *data, NSString *string) {
+    NSData *utf8 = [string dataUsingEncoding:NSUTF8StringEncoding];
+    SPAppendVarint(data, utf8.length);
+    [data appendData:utf8];
+}
+
+static NSString *SPReadString(const uint8_t *bytes, size_t length, size_t *offset) {
+    uint64_t stringLength;
+    if (!SPReadVarint(bytes, length, offset, &stringLength) || stringLength > length - *offset) {
+        return nil;
+    }
+    NSString *string = [[NSString alloc] initWithBytes:bytes + *offset length:(NSUInteger)stringLength encoding:NSUTF8StringEncoding];
+    *offset += (size_t)stringLength;
+    return string;
+}
+
+// MARK: - LZ4-style block compression
+
+/// Appends the length over the 4-bit token field as a run of 255 terminated by a smaller byte.
+static void SPAppendExtendedLength(NSMutableData *data, size_t length) {
+    uint8_t max = 255;
+    while (length >= 255) {
+        [data appendBytes:&max length:1];
+        length -= 255;
+    }
+    uint8_t last = (uint8_t)length;
+    [data appendBytes:&last length:1];
+}
+
+static BOOL SPReadExtendedLength(const uint8_t *bytes, size_t length, size_t *offset, size_t *value) {
+    uint8_t byte;
+    do {
+        if (*offset >= length) {
+            return NO;
+        }
+        byte = bytes[(*offset)++];
+        *value += byte;
+    } while (byte == 255);
+    return YES;
+}
+
+/// Appends a sequence of literals followed by a match, or only literals when matchLength is 0.
+static void SPAppendSequence(NSMutableData *data, const uint8_t *literals, size_t literalLength, size_t offset, size_t matchLength) {
+    uint8_t token = (uint8_t)(MIN(literalLength, (size_t)15) << 4);
+    if (matchLength) {
+        token |= (uint8_t)MIN(matchLength - 4, (size_t)15);
+    }
+    [data appendBytes:&token length:1];
+    if (literalLength >= 15) {
+        SPAppendExtendedLength(data, literalLength - 15);
+    }
+    [data appendBytes:literals length:literalLength];
+    if (!matchLength) {
+        return;
+    }
+    uint8_t offsetBytes[2] = {offset & 0xFF, (offset >> 8) & 0xFF};
+    [data appendBytes:offsetBytes length:2];
+    if (matchLength - 4 >= 15) {
+        SPAppendExtendedLength(data, matchLength - 4 - 15);
+    }
+}
+
+/// Greedy compression with a single-entry hash table of 4-byte sequences, in the LZ4 block format.
+static NSData *SPCompressBlock(const uint8_t *bytes, size_t length) {
+    NSMutableData *result = [NSMutableData dataWithCapacity:length];
+    uint32_t table[1 << kSPHashBits] = {0}; // position + 1, 0 for empty
+    size_t anchor = 0;
+    size_t i = 0;
+    while (i + 4 <= length) {
+        uint32_t sequence;
+        memcpy(&sequence, bytes + i, 4);
+        uint32_t hash = (sequence * 2654435761u) >> (32 - kSPHashBits);
+        size_t candidate = table[hash];
+        table[hash] = (uint32_t)(i + 1);
+        if (candidate && i - (candidate - 1) <= 0xFFFF && memcmp(bytes + candidate - 1, bytes + i, 4) == 0) {
+            size_t reference = candidate - 1;
+            size_t matchLength = 4;
+            while (i + matchLength < length && bytes[reference + matchLength] == bytes[i + matchLength]) {
+                matchLength++;
+            }
+            SPAppendSequence(result, bytes + anchor, i - anchor, i - reference, matchLength);
+            i += matchLength;
+            anchor = i;
+        } else {
+            i++;
+        }
+    }
+    SPAppendSequence(result, bytes + anchor, length - anchor, 0, 0);
+    return result;
+}
+
+static NSData *SPDecompressBlock(const uint8_t *bytes, size_t length, size_t decompressedLength) {
+    NSMutableData *result = [NSMutableData dataWithLength:decompressedLength];
+    uint8_t *output = result.mutableBytes;
+    size_t offset = 0;
+    size_t outputOffset = 0;
+    while (offset < length) {
+        uint8_t token = bytes[offset++];
+        size_t literalLength = token >> 4;
+        if (literalLength == 15 && !SPReadExtendedLength(bytes, length, &offset, &literalLength)) {
+            return nil;
+        }
+        if (literalLength > length - offset || literalLength > decompressedLength - outputOffset) {
+            return nil;
+        }
+        memcpy(output + outputOffset, bytes + offset, literalLength);
+        offset += literalLength;
+        outputOffset += literalLength;
+        if (offset == length) {
+            break;
+        }
+        if (length - offset < 2) {
+            return nil;
+        }
+        size_t matchOffset = bytes[offset] | ((size_t)bytes[offset + 1] << 8);
+        offset += 2;
+        size_t matchLength = token & 0x0F;
+        if (matchLength == 15 && !SPReadExtendedLength(bytes, length, &offset, &matchLength)) {
+            return nil;
+        }
+        matchLength += 4;
+        if (!matchOffset || matchOffset > outputOffset || matchLength > decompressedLength - outputOffset) {
+            return nil;
+        }
+        // Byte by byte as the match can overlap the bytes it produces.
+        for (size_t k = 0; k < matchLength; k++) {
+            output[outputOffset + k] = output[outputOffset - matchOffset + k];
+        }
+        outputOffset += matchLength;
+    }
+    return outputOffset == decompressedLength ? result : nil;
+}
+
+// MARK: - SPCompactPayloadCodec
+
+@implementation SPCompactPayloadCodec
+
++ (NSData *)dataWithPayload:(SPPayload *)payload compress:(BOOL)compress {
+    NSDictionary<NSString *, NSObject *> *dictionary = [payload getAsDictionary];
+    NSDictionary<NSString *, NSNumber *> *keyIndices = SPCompactKeyIndices();
+    NSMutableData *body = [NSMutableData dataWithCapacity:payload.byteSize];
+    SPAppendVarint(body, dictionary.count);
+    for (NSString *key in dictionary) {
+        NSObject *value = dictionary[key];
+        NSNumber *keyIndex = keyIndices[key];
+        SPAppendVarint(body, keyIndex.unsignedLongLongValue);
+        if (!keyIndex) {
+            SPAppendString(body, key);
+        }
+        uint8_t type;
+        if ([value isKindOfClass:NSString.class]) {
+            type = SPCompactValueTypeString;
+            [body appendBytes:&type length:1];
+            SPAppendString(body, (NSString *)value);
+        } else if ([value isKindOfClass:NSNumber.class]) {
+            NSNumber *number = (NSNumber *)value;
+            if (CFGetTypeID((__bridge CFTypeRef)number) == CFBooleanGetTypeID()) {
+                type = number.boolValue ? SPCompactValueTypeTrue : SPCompactValueTypeFalse;
+                [body appendBytes:&type length:1];
+            } else if (CFNumberIsFloatType((__bridge CFNumberRef)number)) {
+                type = SPCompactValueTypeDouble;
+                [body appendBytes:&type length:1];
+                double doubleValue = number.doubleValue;
+                uint64_t bits;
+                memcpy(&bits, &doubleValue, 8);
+                bits = CFSwapInt64HostToLittle(bits);
+                [body appendBytes:&bits length:8];
+            } else {
+                type = SPCompactValueTypeInteger;
+                [body appendBytes:&type length:1];
+                int64_t integer = number.longLongValue;
+                SPAppendVarint(body, ((uint64_t)integer << 1) ^ (uint64_t)(integer >> 63)); // zigzag
+            }
+        } else {
+            return nil;
+        }
+    }
+
+    NSMutableData *record = [NSMutableData dataWithCapacity:body.length + 8];
+    uint8_t header[3] = {kSPCompactMarker, kSPCompactVersion, 0};
+    NSData *compressedBody = nil;
+    if (compress && body.length >= kSPCompressionThreshold) {
+        compressedBody = SPCompressBlock(body.bytes, body.length);
+        if (compressedBody.length + 4 >= body.length) {
+            compressedBody = nil;
+        }
+    }
+    if (compressedBody) {
+        header[2] |= kSPCompactFlagCompressed;
+        [record appendBytes:header length:3];
+        SPAppendVarint(record, body.length);
+        [record appendData:compressedBody];
+    } else {
+        [record appendBytes:header length:3];
+        [record appendData:body];
+    }
+    return record;
+}
+
++ (SPPayload *)payloadWithData:(NSData *)data {
+    if (![self isCompactData:data] || data.length < 3) {
+        return nil;
+    }
+    const uint8_t *bytes = data.bytes;
+    if (bytes[1] > kSPCompactVersion) {
+        return nil;
+    }
+    size_t length = data.length;
+    size_t offset = 3;
+    NSData *body = nil;
+    if (bytes[2] & kSPCompactFlagCompressed) {
+        uint64_t bodyLength;
+        if (!SPReadVarint(bytes, length, &offset, &bodyLength) || bodyLength > kSPMaxBodyLength) {
+            return nil;
+        }
+        body = SPDecompressBlock(bytes + offset, length - offset, (size_t)bodyLength);
+        if (!body) {
+            return nil;
+        }
+        bytes = body.bytes;
+        length = body.length;
+        offset = 0;
+    }
+
+    NSArray<NSString *> *keys = SPCompactKeys();
+    uint64_t fieldCount;
+    if (!SPReadVarint(bytes, length, &offset, &fieldCount) || fieldCount > length) {
+        return nil;
+    }
+    NSMutableDictionary<NSString *, NSObject *> *dictionary = [NSMutableDictionary dictionaryWithCapacity:(NSUInteger)fieldCount];
+    for (uint64_t i = 0; i < fieldCount; i++) {
+        uint64_t keyIndex;
+        if (!SPReadVarint(bytes, length, &offset, &keyIndex)) {
+            return nil;
+        }
+        NSString *key = nil;
+        if (!keyIndex) {
+            key = SPReadString(bytes, length, &offset);
+        } else if (keyIndex <= keys.count) {
+            key = keys[(NSUInteger)keyIndex - 1];
+        }
+        if (!key || offset >= length) {
+            return nil;
+        }
+        NSObject *value = nil;
+        switch (bytes[offset++]) {
+            case SPCompactValueTypeString:
+                value = SPReadString(bytes, length, &offset);
+                break;
+            case SPCompactValueTypeInteger: {
+                uint64_t zigzag;
+                if (SPReadVarint(bytes, length, &offset, &zigzag)) {
+                    value = @((int64_t)(zigzag >> 1) ^ -(int64_t)(zigzag & 1));
+                }
+                break;
+            }
+            case SPCompactValueTypeDouble: {
+                if (length - offset >= 8) {
+                    uint64_t bits;
+                    memcpy(&bits, bytes + offset, 8);
+                    bits = CFSwapInt64LittleToHost(bits);
+                    double number;
+                    memcpy(&number, &bits, 8);
+                    value = @(number);
+                    offset += 8;
+                }
+                break;
+            }
+            case SPCompactValueTypeTrue:
+                value = @YES;
+                break;
+            case SPCompactValueTypeFalse:
+                value = @NO;
+                break;
+        }
+        if (!value) {
+            return nil;
+        }
+        dictionary[key] = value;
+    }
+    return [[SPPayload alloc] initWithNSDictionary:dictionary];
+}
+
++ (BOOL)isCompactData:(NSData *)data {
+    return data.length && ((const uint8_t *)data.bytes)[0] == kSPCompactMarker;
+}
+
+@end
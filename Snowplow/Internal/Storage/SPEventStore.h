@@ -68,6 +68,62 @@ NS_SWIFT_NAME(EventStore)
  */
 - (NSArray<SPEmitterEvent *> *)emittableEventsWithQueryLimit:(NSUInteger)queryLimit;
 
+@optional
+
+/**
+ * Adds several events to the store in a single write.
+ * @param payloads the payloads to be added, in order.
+ */
+- (void)addEvents:(NSArray<SPPayload *> *)payloads;
+
+/**
+ * Sets the capacity of the store. When a limit is exceeded the store evicts events
+ * in order of priority (see `SPPayload.priority`) and then from the oldest.
+ * @param maxEventCount the maximum number of events stored, 0 for no limit.
+ * @param maxByteSize the maximum size of the stored payloads in bytes, 0 for no limit.
+ * @param maxEventAge the maximum time in seconds an event is kept in the store, 0 for no limit.
+ */
+- (void)setCapacityWithMaxEventCount:(NSUInteger)maxEventCount maxByteSize:(NSUInteger)maxByteSize maxEventAge:(NSTimeInterval)maxEventAge;
+
+/**
+ * Returns the oldest events that are not already leased and leases them, so that they are not returned
+ * again until they are removed, released or the lease expires. It lets emit rounds send disjoint batches
+ * concurrently. Leases are not persisted: they are lost if the app terminates.
+ * @param queryLimit is the maximum number of events returned.
+ * @param leaseDuration is the time in seconds after which the events can be returned again.
+ * @return the leased events ordered by store identifier.
+ */
+- (NSArray<SPEmitterEvent *> *)leaseEmittableEventsWithQueryLimit:(NSUInteger)queryLimit leaseDuration:(NSTimeInterval)leaseDuration;
+
+/**
+ * Releases the lease of events that have to be sent again.
+ * @param storeIds the events' identifiers in the store.
+ */
+- (void)releaseEventsWithIds:(NSArray<NSNumber *> *)storeIds;
+
+/**
+ * Records a failed attempt to send the events: the store keeps the number of attempts and the time of the
+ * last one with each event. The events that reached the maximum number of attempts are moved out of the
+ * store into the dead-letter events, so that they are not sent again.
+ * @param storeIds the events' identifiers in the store.
+ * @param maxAttempts the number of attempts after which an event is dead-lettered, 0 for no limit.
+ * @return the identifiers of the events that have been dead-lettered.
+ */
+- (NSArray<NSNumber *> *)recordFailedAttemptForEventsWithIds:(NSArray<NSNumber *> *)storeIds maxAttempts:(NSUInteger)maxAttempts;
+
+/**
+ * Returns the dead-lettered events, oldest first, so that they can be inspected or exported by the app.
+ * @param queryLimit is the maximum number of events returned.
+ * @return EmitterEvent objects containing the identifiers of the dead-lettered events and their payloads.
+ */
+- (NSArray<SPEmitterEvent *> *)deadLetterEventsWithQueryLimit:(NSUInteger)queryLimit;
+
+/**
+ * Empties the dead-letter events.
+ * @return a boolean of success to remove.
+ */
+- (BOOL)removeAllDeadLetterEvents;
+
 @end
 
 NS_ASSUME_NONNULL_END
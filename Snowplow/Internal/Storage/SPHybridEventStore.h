@@ -0,0 +1,65 @@
+//
+//  SPHybridEventStore.h
+//  Snowplow
+//
+//  Copyright (c) 2013-2022 Snowplow Analytics Ltd. All rights reserved.
+//
+//  This program is licensed to you under the Apache License Version 2.0,
+//  and you may not use this file except in compliance with the Apache License
+//  Version 2.0. You may obtain a copy of the Apache License Version 2.0 at
+//  http://www.apache.org/licenses/LICENSE-2.0.
+//
+//  Unless required by applicable law or agreed to in writing,
+//  software distributed under the Apache License Version 2.0 is distributed on
+//  an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+//  express or implied. See the Apache License Version 2.0 for the specific
+//  language governing permissions and limitations there under.
+//
+//  License: Apache License Version 2.0
+//
+
+#import <Foundation/Foundation.h>
+#import "SPEventStore.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * EventStore keeping the new events in memory and writing them to a SQLite database in background batches.
+ * Adding an event never waits on disk: the buffered events are written when the flush batch size is reached
+ * or, at the latest, after the durability window. The buffered events can be sent before being written,
+ * but they are lost if the app is killed before the write.
+ * The buffer is also written when the app resigns active and when the store is released.
+ */
+NS_SWIFT_NAME(HybridEventStore)
+@interface SPHybridEventStore : NSObject <SPEventStore>
+
+/// The maximum time in seconds an event is kept only in memory.
+@property (nonatomic, readonly) NSTimeInterval durabilityWindow;
+
+/// The number of buffered events that triggers a write to the database.
+@property (nonatomic, readonly) NSUInteger flushBatchSize;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ * Creates the store with a durability window of 1 second and a flush batch size of 50 events.
+ * @param namespace The namespace of the tracker, used for the SQLite database.
+ */
+- (instancetype)initWithNamespace:(NSString *)namespace;
+
+/**
+ * Creates the store.
+ * @param namespace The namespace of the tracker, used for the SQLite database.
+ * @param durabilityWindow The maximum time in seconds an event is kept only in memory.
+ * @param flushBatchSize The number of buffered events that triggers a write to the database.
+ */
+- (instancetype)initWithNamespace:(NSString *)namespace durabilityWindow:(NSTimeInterval)durabilityWindow flushBatchSize:(NSUInteger)flushBatchSize;
+
+/**
+ * Writes the buffered events to the database and waits for the write to complete.
+ */
+- (void)flush;
+
+@end
+
+NS_ASSUME_NONNULL_END
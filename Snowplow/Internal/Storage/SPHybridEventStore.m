@@ -0,0 +1,249 @@
+//
+//  SPHybridEventStore.m
+//  Snowplow
+//
+//  Copyright (c) 2013-2022 Snowplow Analytics Ltd. All rights reserved.
+//
+//  This program is licensed to you under the Apache License Version 2.0,
+//  and you may not use this file except in compliance with the Apache License
+//  Version 2.0. You may obtain a copy of the Apache License Version 2.0 at
+//  http://www.apache.org/licenses/LICENSE-2.0.
+//
+//  Unless required by applicable law or agreed to in writing,
+//  software distributed under the Apache License Version 2.0 is distributed on
+//  an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+//  express or implied. See the Apache License Version 2.0 for the specific
+//  language governing permissions and limitations there under.
+//
+//  License: Apache License Version 2.0
+//
+
+#import "SPHybridEventStore.h"
+#import "SPSQLiteEventStore.h"
+#import "SPLogger.h"
+
+#if SNOWPLOW_TARGET_IOS || SNOWPLOW_TARGET_TV
+#import <UIKit/UIKit.h>
+#endif
+
+static const NSTimeInterval kSPDefaultDurabilityWindow = 1;
+static const NSUInteger kSPDefaultFlushBatchSize = 50;
+
+@implementation SPHybridEventStore {
+    SPSQLiteEventStore *_persistentStore;
+    dispatch_queue_t _flushQueue;
+    /// Held by the database writes and reads so that an event is never visible both in the buffer and in the database.
+    NSObject *_flushLock;
+    /// Buffered events by temporary store identifier, in insertion order. Temporary identifiers are negative.
+    NSMutableOrderedSet<NSNumber *> *_bufferedIds;
+    NSMutableDictionary<NSNumber *, SPPayload *> *_bufferedPayloads;
+    long long _lastBufferedId;
+    /// Buffered events returned by `emittableEventsWithQueryLimit:` that can still be removed with the temporary identifier.
+    NSMutableSet<NSNumber *> *_emittedBufferedIds;
+    /// Database identifiers of the emitted events that were written after being returned.
+    NSMutableDictionary<NSNumber *, NSNumber *> *_writtenEmittedIds;
+}
+
+- (instancetype)initWithNamespace:(NSString *)namespace {
+    return [self initWithNamespace:namespace durabilityWindow:kSPDefaultDurabilityWindow flushBatchSize:kSPDefaultFlushBatchSize];
+}
+
+- (instancetype)initWithNamespace:(NSString *)namespace durabilityWindow:(NSTimeInterval)durabilityWindow flushBatchSize:(NSUInteger)flushBatchSize {
+    if (self = [super init]) {
+        _durabilityWindow = MAX(durabilityWindow, 0);
+        _flushBatchSize = MAX(flushBatchSize, 1);
+        _persistentStore = [[SPSQLiteEventStore alloc] initWithNamespace:namespace];
+        _flushQueue = dispatch_queue_create("com.snowplowanalytics.snowplow.hybridEventStore", DISPATCH_QUEUE_SERIAL);
+        _flushLock = [NSObject new];
+        _bufferedIds = [NSMutableOrderedSet new];
+        _bufferedPayloads = [NSMutableDictionary new];
+        _lastBufferedId = 0;
+        _emittedBufferedIds = [NSMutableSet new];
+        _writtenEmittedIds = [NSMutableDictionary new];
+
+        #if SNOWPLOW_TARGET_IOS || SNOWPLOW_TARGET_TV
+        [[NSNotificationCenter defaultCenter] addObserver:self
+                                                 selector:@selector(scheduleFlush)
+                                                     name:UIApplicationWillResignActiveNotification
+                                                   object:nil];
+        #endif
+    }
+    return self;
+}
+
+- (void)dealloc {
+    #if SNOWPLOW_TARGET_IOS || SNOWPLOW_TARGET_TV
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+    #endif
+    // The scheduled flushes don't retain the store, so the remaining events are written here.
+    if (_bufferedIds.count) {
+        NSMutableArray<SPPayload *> *payloads = [NSMutableArray arrayWithCapacity:_bufferedIds.count];
+        for (NSNumber *bufferedId in _bufferedIds) {
+            [payloads addObject:_bufferedPayloads[bufferedId]];
+        }
+        [_persistentStore insertEvents:payloads];
+    }
+}
+
+// MARK: - SPEventStore
+
+- (void)addEvent:(SPPayload *)payload {
+    [self addEvents:@[payload]];
+}
+
+- (void)addEvents:(NSArray<SPPayload *> *)payloads {
+    if (!payloads.count) {
+        return;
+    }
+    NSUInteger previousCount;
+    NSUInteger bufferedCount;
+    @synchronized (self) {
+        previousCount = _bufferedIds.count;
+        for (SPPayload *payload in payloads) {
+            NSNumber *bufferedId = @(--_lastBufferedId);
+            [_bufferedIds addObject:bufferedId];
+            _bufferedPayloads[bufferedId] = payload;
+        }
+        bufferedCount = _bufferedIds.count;
+    }
+    // Flushes every time the buffer crosses a multiple of the batch size.
+    if (bufferedCount / _flushBatchSize > previousCount / _flushBatchSize) {
+        [self scheduleFlush];
+    } else if (previousCount == 0) {
+        [self scheduleFlushAfter:_durabilityWindow];
+    }
+}
+
+- (BOOL)removeEventWithId:(long long)storeId {
+    return [self removeEventsWithIds:@[@(storeId)]];
+}
+
+- (BOOL)removeEventsWithIds:(NSArray<NSNumber *> *)storeIds {
+    @synchronized (_flushLock) {
+        NSMutableArray<NSNumber *> *rowIds = [NSMutableArray arrayWithCapacity:storeIds.count];
+        @synchronized (self) {
+            for (NSNumber *storeId in storeIds) {
+                if (storeId.longLongValue >= 0) {
+                    [rowIds addObject:storeId];
+                } else if (_bufferedPayloads[storeId]) {
+                    [_bufferedIds removeObject:storeId];
+                    [_bufferedPayloads removeObjectForKey:storeId];
+                    [_emittedBufferedIds removeObject:storeId];
+                } else if (_writtenEmittedIds[storeId]) {
+                    [rowIds addObject:_writtenEmittedIds[storeId]];
+                    [_writtenEmittedIds removeObjectForKey:storeId];
+                }
+            }
+        }
+        return rowIds.count ? [_persistentStore removeEventsWithIds:rowIds] : YES;
+    }
+}
+
+- (BOOL)removeAllEvents {
+    @synchronized (_flushLock) {
+        @synchronized (self) {
+            [_bufferedIds removeAllObjects];
+            [_bufferedPayloads removeAllObjects];
+            [_emittedBufferedIds removeAllObjects];
+            [_writtenEmittedIds removeAllObjects];
+        }
+        return [_persistentStore removeAllEvents];
+    }
+}
+
+- (NSUInteger)count {
+    @synchronized (_flushLock) {
+        NSUInteger bufferedCount;
+        @synchronized (self) {
+            bufferedCount = _bufferedIds.count;
+        }
+        return [_persistentStore count] + bufferedCount;
+    }
+}
+
+- (NSArray<SPEmitterEvent *> *)emittableEventsWithQueryLimit:(NSUInteger)queryLimit {
+    @synchronized (_flushLock) {
+        NSArray<SPEmitterEvent *> *persistedEvents = [_persistentStore emittableEventsWithQueryLimit:queryLimit];
+        NSMutableArray<SPEmitterEvent *> *events = [NSMutableArray arrayWithCapacity:queryLimit];
+        for (SPEmitterEvent *event in persistedEvents) {
+            if (events.count >= queryLimit) break;
+            [events addObject:event];
+        }
+        @synchronized (self) {
+            // The emitter processes a batch before asking for the next one, so the previous mappings aren't needed anymore.
+            [_writtenEmittedIds removeAllObjects];
+            [_emittedBufferedIds removeAllObjects];
+            for (NSNumber *bufferedId in _bufferedIds) {
+                if (events.count >= queryLimit) break;
+                [events addObject:[[SPEmitterEvent alloc] initWithPayload:_bufferedPayloads[bufferedId] storeId:bufferedId.longLongValue]];
+                [_emittedBufferedIds addObject:bufferedId];
+            }
+        }
+        return events;
+    }
+}
+
+- (void)setCapacityWithMaxEventCount:(NSUInteger)maxEventCount maxByteSize:(NSUInteger)maxByteSize maxEventAge:(NSTimeInterval)maxEventAge {
+    [_persistentStore setCapacityWithMaxEventCount:maxEventCount maxByteSize:maxByteSize maxEventAge:maxEventAge];
+}
+
+// MARK: - Flush
+
+- (void)flush {
+    dispatch_sync(_flushQueue, ^{
+        [self writeBufferedEvents];
+    });
+}
+
+- (void)scheduleFlush {
+    [self scheduleFlushAfter:0];
+}
+
+- (void)scheduleFlushAfter:(NSTimeInterval)delay {
+    __weak __typeof__(self) weakSelf = self;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)), _flushQueue, ^{
+        [weakSelf writeBufferedEvents];
+    });
+}
+
+/// Called on the flush queue. Events stay in the buffer while they are written so they remain readable.
+- (void)writeBufferedEvents {
+    @synchronized (_flushLock) {
+        NSArray<NSNumber *> *bufferedIds;
+        NSMutableArray<SPPayload *> *payloads;
+        @synchronized (self) {
+            bufferedIds = _bufferedIds.array;
+            payloads = [NSMutableArray arrayWithCapacity:bufferedIds.count];
+            for (NSNumber *bufferedId in bufferedIds) {
+                [payloads addObject:_bufferedPayloads[bufferedId]];
+            }
+        }
+        if (!payloads.count) {
+            return;
+        }
+        NSArray<NSNumber *> *rowIds = [_persistentStore insertEvents:payloads];
+        BOOL hasFailures = NO;
+        @synchronized (self) {
+            for (NSUInteger i = 0; i < bufferedIds.count; i++) {
+                NSNumber *bufferedId = bufferedIds[i];
+                NSNumber *rowId = rowIds[i];
+                if (rowId.longLongValue < 0) {
+                    hasFailures = YES;
+                    continue;
+                }
+                [_bufferedIds removeObject:bufferedId];
+                [_bufferedPayloads removeObjectForKey:bufferedId];
+                if ([_emittedBufferedIds containsObject:bufferedId]) {
+                    [_emittedBufferedIds removeObject:bufferedId];
+                    _writtenEmittedIds[bufferedId] = rowId;
+                }
+            }
+        }
+        if (hasFailures) {
+            SPLogError(@"Failed to write buffered events to the database, retrying in %@s", @(_durabilityWindow));
+            [self scheduleFlushAfter:_durabilityWindow];
+        }
+    }
+}
+
+@end
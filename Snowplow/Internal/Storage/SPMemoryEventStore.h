@@ -24,9 +24,41 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+/**
+ * What the memory store does when an event is added while it holds as many events as its capacity.
+ */
+typedef NS_ENUM(NSInteger, SPMemoryEventStoreOverflowPolicy) {
+    /// Removes the oldest event to make room for the new one.
+    SPMemoryEventStoreOverflowPolicyDropOldest = 0,
+    /// Discards the new event.
+    SPMemoryEventStoreOverflowPolicyDropNewest,
+} NS_SWIFT_NAME(MemoryEventStoreOverflowPolicy);
+
+/**
+ * EventStore keeping the events in memory in a ring buffer indexed by store identifier.
+ * Events are added and removed in constant time and are read in insertion order.
+ */
 NS_SWIFT_NAME(MemoryEventStore)
 @interface SPMemoryEventStore : NSObject <SPEventStore>
 
+/// The maximum number of events held by the store, 0 if unbounded.
+@property (nonatomic, readonly) NSUInteger capacity;
+
+/// What the store does when an event is added while it is full.
+@property (nonatomic, readonly) SPMemoryEventStoreOverflowPolicy overflowPolicy;
+
+/**
+ * Creates an unbounded store.
+ */
+- (instancetype)init;
+
+/**
+ * Creates a store holding a fixed number of events.
+ * @param capacity The maximum number of events held by the store, 0 if unbounded.
+ * @param overflowPolicy What the store does when an event is added while it is full.
+ */
+- (instancetype)initWithCapacity:(NSUInteger)capacity overflowPolicy:(SPMemoryEventStoreOverflowPolicy)overflowPolicy;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -21,25 +21,57 @@
 
 #import "SPMemoryEventStore.h"
 
+/// Fraction of the capacity kept when the store evicts events, so that eviction runs in bulk rather than on every insert.
+static const double kSPEvictionLowWaterMark = 0.9;
+
+/// Initial number of slots of an unbounded store.
+static const NSUInteger kSPInitialSlotCount = 64;
+
+/// Maximum number of dead-lettered events kept, the oldest ones are removed first.
+static const NSUInteger kSPMaxDeadLetterEvents = 1000;
+
 @interface SPMemoryEventStore ()
 
-@property (nonatomic) NSUInteger sendLimit;
-@property (nonatomic) NSUInteger index;
-@property (nonatomic) NSMutableOrderedSet<SPEmitterEvent *> *orderedSet;
+/// Ring of slots where the event with a store identifier is at a fixed offset from the head:
+/// the slots between the head and the tail hold either an event or NSNull for the removed ones.
+@property (nonatomic) NSMutableArray *slots;
+@property (nonatomic) NSUInteger headIndex;
+@property (nonatomic) long long headStoreId;
+@property (nonatomic) long long nextStoreId;
+/// Events older than the head, ordered by store id. When the store has a capacity, old events still in the store
+/// (e.g. leased or retried) are moved out of the ring rather than growing it, so that the ring keeps its size.
+@property (nonatomic) NSMutableArray<SPEmitterEvent *> *displacedItems;
+/// Number of events in the store, displaced ones included.
+@property (nonatomic) NSUInteger eventCount;
+@property (nonatomic) NSMutableDictionary<NSNumber *, NSDate *> *insertionDates;
+@property (nonatomic) NSUInteger maxEventCount;
+@property (nonatomic) NSUInteger maxByteSize;
+@property (nonatomic) NSTimeInterval maxEventAge;
+@property (nonatomic) NSUInteger storedBytes;
+@property (nonatomic) NSMutableDictionary<NSNumber *, NSDate *> *leases;
+/// Failed attempts to send the events keyed by store id, only for the events that failed at least once.
+@property (nonatomic) NSMutableDictionary<NSNumber *, NSNumber *> *attempts;
+@property (nonatomic) NSMutableArray<SPEmitterEvent *> *deadLetterEvents;
 
 @end
 
 @implementation SPMemoryEventStore
 
 - (instancetype)init {
-    return [self initWithLimit:250];
+    return [self initWithCapacity:0 overflowPolicy:SPMemoryEventStoreOverflowPolicyDropOldest];
 }
 
-- (instancetype)initWithLimit:(NSUInteger)limit {
+- (instancetype)initWithCapacity:(NSUInteger)capacity overflowPolicy:(SPMemoryEventStoreOverflowPolicy)overflowPolicy {
     if (self = [super init]) {
-        self.orderedSet = [[NSMutableOrderedSet alloc] init];
-        self.sendLimit = limit;
-        self.index = 0;
+        _capacity = capacity;
+        _overflowPolicy = overflowPolicy;
+        self.insertionDates = [NSMutableDictionary new];
+        self.leases = [NSMutableDictionary new];
+        self.attempts = [NSMutableDictionary new];
+        self.deadLetterEvents = [NSMutableArray new];
+        self.displacedItems = [NSMutableArray new];
+        self.nextStoreId = 0;
+        [self resetSlots];
     }
     return self;
 }
@@ -48,38 +80,55 @@
 
 - (void)addEvent:(nonnull SPPayload *)payload {
     @synchronized (self) {
-        SPEmitterEvent *item = [[SPEmitterEvent alloc] initWithPayload:payload storeId:self.index++];
-        [self.orderedSet addObject:item];
+        [self insertEvent:payload];
+    }
+}
+
+- (void)addEvents:(NSArray<SPPayload *> *)payloads {
+    @synchronized (self) {
+        for (SPPayload *payload in payloads) {
+            [self insertEvent:payload];
+        }
     }
 }
 
 - (NSUInteger)count {
     @synchronized (self) {
-        return [self.orderedSet count];
+        return self.eventCount;
     }
 }
 
 - (nonnull NSArray<SPEmitterEvent *> *)emittableEventsWithQueryLimit:(NSUInteger)queryLimit {
     @synchronized (self) {
-        NSUInteger setCount = [self.orderedSet count];
-        if (setCount <= 0) {
+        NSUInteger len = MIN(queryLimit, self.eventCount);
+        if (!len) {
             return @[];
         }
-        NSUInteger len = MIN(queryLimit, setCount);
-        NSRange range = NSMakeRange(0, len);
-        SPEmitterEvent * __unsafe_unretained array[len];
-        [self.orderedSet getObjects:array range:range];
-        NSMutableArray<SPEmitterEvent *> *result = [[NSMutableArray alloc] initWithCapacity:len];
-        for (int i = 0; i < len; i++) {
-            [result addObject:array[i]];
+        if (!self.displacedItems.count && self.eventCount == self.nextStoreId - self.headStoreId) {
+            // No gaps: the batch is a contiguous slice of the ring, split in two if it wraps around.
+            NSUInteger firstLen = MIN(len, self.slots.count - self.headIndex);
+            NSMutableArray<SPEmitterEvent *> *result = [[self.slots subarrayWithRange:NSMakeRange(self.headIndex, firstLen)] mutableCopy];
+            if (firstLen < len) {
+                [result addObjectsFromArray:[self.slots subarrayWithRange:NSMakeRange(0, len - firstLen)]];
+            }
+            return result;
         }
+        NSMutableArray<SPEmitterEvent *> *result = [[NSMutableArray alloc] initWithCapacity:len];
+        [self enumerateItemsUsingBlock:^(SPEmitterEvent *item, BOOL *stop) {
+            [result addObject:item];
+            *stop = result.count >= len;
+        }];
         return result;
     }
 }
 
 - (BOOL)removeAllEvents {
     @synchronized (self) {
-        [self.orderedSet removeAllObjects];
+        [self resetSlots];
+        [self.insertionDates removeAllObjects];
+        [self.leases removeAllObjects];
+        [self.attempts removeAllObjects];
+        self.storedBytes = 0;
         return YES;
     }
 }
@@ -90,15 +139,297 @@
 
 - (BOOL)removeEventsWithIds:(nonnull NSArray<NSNumber *> *)storeIds {
     @synchronized (self) {
-        NSMutableArray<SPEmitterEvent *> *itemsToRemove = [NSMutableArray new];
-        for (SPEmitterEvent *item in self.orderedSet) {
-            if ([storeIds containsObject:[NSNumber numberWithLongLong:item.storeId]]) {
-                [itemsToRemove addObject:item];
+        for (NSNumber *storeId in storeIds) {
+            [self removeItemWithStoreId:storeId.longLongValue];
+        }
+        return YES;
+    }
+}
+
+- (NSArray<SPEmitterEvent *> *)leaseEmittableEventsWithQueryLimit:(NSUInteger)queryLimit leaseDuration:(NSTimeInterval)leaseDuration {
+    @synchronized (self) {
+        NSDate *now = [NSDate date];
+        NSDate *expiryDate = [now dateByAddingTimeInterval:leaseDuration];
+        NSMutableArray<SPEmitterEvent *> *result = [NSMutableArray new];
+        if (!queryLimit) {
+            return result;
+        }
+        [self enumerateItemsUsingBlock:^(SPEmitterEvent *item, BOOL *stop) {
+            NSNumber *storeId = @(item.storeId);
+            NSDate *leaseExpiryDate = self.leases[storeId];
+            if (leaseExpiryDate && [leaseExpiryDate compare:now] == NSOrderedDescending) {
+                return;
             }
+            self.leases[storeId] = expiryDate;
+            [result addObject:item];
+            *stop = result.count >= queryLimit;
+        }];
+        return result;
+    }
+}
+
+- (void)releaseEventsWithIds:(NSArray<NSNumber *> *)storeIds {
+    @synchronized (self) {
+        [self.leases removeObjectsForKeys:storeIds];
+    }
+}
+
+- (NSArray<NSNumber *> *)recordFailedAttemptForEventsWithIds:(NSArray<NSNumber *> *)storeIds maxAttempts:(NSUInteger)maxAttempts {
+    @synchronized (self) {
+        NSMutableArray<NSNumber *> *deadLetterIds = [NSMutableArray new];
+        for (NSNumber *storeId in storeIds) {
+            long long index = storeId.longLongValue;
+            SPEmitterEvent *item = [self itemWithStoreId:index];
+            if (!item) {
+                continue;
+            }
+            NSUInteger attempts = self.attempts[storeId].unsignedIntegerValue + 1;
+            if (!maxAttempts || attempts < maxAttempts) {
+                self.attempts[storeId] = @(attempts);
+                continue;
+            }
+            [self.deadLetterEvents addObject:item];
+            [self removeItemWithStoreId:index];
+            [deadLetterIds addObject:storeId];
+        }
+        if (self.deadLetterEvents.count > kSPMaxDeadLetterEvents) {
+            [self.deadLetterEvents removeObjectsInRange:NSMakeRange(0, self.deadLetterEvents.count - kSPMaxDeadLetterEvents)];
         }
-        [self.orderedSet removeObjectsInArray:itemsToRemove];
+        return deadLetterIds;
+    }
+}
+
+- (NSArray<SPEmitterEvent *> *)deadLetterEventsWithQueryLimit:(NSUInteger)queryLimit {
+    @synchronized (self) {
+        return [self.deadLetterEvents subarrayWithRange:NSMakeRange(0, MIN(queryLimit, self.deadLetterEvents.count))];
+    }
+}
+
+- (BOOL)removeAllDeadLetterEvents {
+    @synchronized (self) {
+        [self.deadLetterEvents removeAllObjects];
         return YES;
     }
 }
 
+- (void)setCapacityWithMaxEventCount:(NSUInteger)maxEventCount maxByteSize:(NSUInteger)maxByteSize maxEventAge:(NSTimeInterval)maxEventAge {
+    @synchronized (self) {
+        self.maxEventCount = maxEventCount;
+        self.maxByteSize = maxByteSize;
+        self.maxEventAge = maxEventAge;
+        self.storedBytes = 0;
+        if (maxByteSize) {
+            [self enumerateItemsUsingBlock:^(SPEmitterEvent *item, BOOL *stop) {
+                self.storedBytes += item.payload.byteSize;
+            }];
+        }
+        [self evictEvents];
+    }
+}
+
+// Private methods
+
+/// Must be called within a synchronized block.
+- (void)resetSlots {
+    NSUInteger slotCount = self.capacity ?: kSPInitialSlotCount;
+    self.slots = [NSMutableArray arrayWithCapacity:slotCount];
+    for (NSUInteger i = 0; i < slotCount; i++) {
+        [self.slots addObject:[NSNull null]];
+    }
+    self.headIndex = 0;
+    self.headStoreId = self.nextStoreId;
+    self.eventCount = 0;
+    [self.displacedItems removeAllObjects];
+}
+
+/// Doubles the slots, moving the events at the beginning of the new ring.
+/// Must be called within a synchronized block.
+- (void)growSlots {
+    NSUInteger slotCount = self.slots.count;
+    NSMutableArray *slots = [NSMutableArray arrayWithCapacity:slotCount * 2];
+    [slots addObjectsFromArray:[self.slots subarrayWithRange:NSMakeRange(self.headIndex, slotCount - self.headIndex)]];
+    [slots addObjectsFromArray:[self.slots subarrayWithRange:NSMakeRange(0, self.headIndex)]];
+    for (NSUInteger i = 0; i < slotCount; i++) {
+        [slots addObject:[NSNull null]];
+    }
+    self.slots = slots;
+    self.headIndex = 0;
+}
+
+/// Moves the event at the head out of the ring and advances the head to the next event.
+/// Must be called within a synchronized block.
+- (void)displaceHeadItem {
+    SPEmitterEvent *item = self.slots[self.headIndex];
+    [self.displacedItems addObject:item];
+    self.slots[self.headIndex] = [NSNull null];
+    [self advanceHead];
+}
+
+/// Moves the head past the removed events, or to the tail when the ring is empty.
+/// Must be called within a synchronized block.
+- (void)advanceHead {
+    if (self.eventCount == self.displacedItems.count) {
+        self.headIndex = 0;
+        self.headStoreId = self.nextStoreId;
+        return;
+    }
+    while (self.slots[self.headIndex] == [NSNull null]) {
+        self.headIndex = (self.headIndex + 1) % self.slots.count;
+        self.headStoreId++;
+    }
+}
+
+/// Must be called within a synchronized block.
+- (NSUInteger)slotIndexOfStoreId:(long long)storeId {
+    return (self.headIndex + (NSUInteger)(storeId - self.headStoreId)) % self.slots.count;
+}
+
+/// Index of the event in the displaced events, NSNotFound if it isn't there.
+/// Must be called within a synchronized block.
+- (NSUInteger)displacedIndexOfStoreId:(long long)storeId {
+    SPEmitterEvent *probe = [[SPEmitterEvent alloc] initWithPayload:[SPPayload new] storeId:storeId];
+    return [self.displacedItems indexOfObject:probe
+                                inSortedRange:NSMakeRange(0, self.displacedItems.count)
+                                      options:NSBinarySearchingFirstEqual
+                              usingComparator:^NSComparisonResult(SPEmitterEvent *a, SPEmitterEvent *b) {
+        return a.storeId < b.storeId ? NSOrderedAscending : (a.storeId > b.storeId ? NSOrderedDescending : NSOrderedSame);
+    }];
+}
+
+/// Must be called within a synchronized block.
+- (SPEmitterEvent *)itemWithStoreId:(long long)storeId {
+    if (storeId < self.headStoreId) {
+        NSUInteger index = [self displacedIndexOfStoreId:storeId];
+        return index == NSNotFound ? nil : self.displacedItems[index];
+    }
+    if (storeId >= self.nextStoreId) {
+        return nil;
+    }
+    id item = self.slots[[self slotIndexOfStoreId:storeId]];
+    return item == [NSNull null] ? nil : item;
+}
+
+/// Enumerates the events in insertion order.
+/// Must be called within a synchronized block.
+- (void)enumerateItemsUsingBlock:(void (^)(SPEmitterEvent *item, BOOL *stop))block {
+    BOOL stop = NO;
+    for (SPEmitterEvent *item in [self.displacedItems copy]) {
+        block(item, &stop);
+        if (stop) {
+            return;
+        }
+    }
+    NSUInteger remaining = self.eventCount - self.displacedItems.count;
+    for (long long storeId = self.headStoreId; storeId < self.nextStoreId && remaining && !stop; storeId++) {
+        id slot = self.slots[[self slotIndexOfStoreId:storeId]];
+        if (slot != [NSNull null]) {
+            remaining--;
+            block(slot, &stop);
+        }
+    }
+}
+
+/// Must be called within a synchronized block.
+- (void)insertEvent:(SPPayload *)payload {
+    if (self.capacity && self.eventCount >= self.capacity) {
+        if (self.overflowPolicy == SPMemoryEventStoreOverflowPolicyDropNewest) {
+            return;
+        }
+        SPEmitterEvent *oldestDisplacedItem = self.displacedItems.firstObject;
+        [self removeItemWithStoreId:oldestDisplacedItem ? oldestDisplacedItem.storeId : self.headStoreId];
+    }
+    while (self.nextStoreId - self.headStoreId >= (long long)self.slots.count) {
+        if (!self.capacity) {
+            [self growSlots];
+            break;
+        }
+        // The span between the head and the tail includes the removed events: rather than growing the ring,
+        // the old events that are still there are moved out of it.
+        [self displaceHeadItem];
+    }
+    SPEmitterEvent *item = [[SPEmitterEvent alloc] initWithPayload:payload storeId:self.nextStoreId++];
+    self.slots[[self slotIndexOfStoreId:item.storeId]] = item;
+    self.eventCount++;
+    // Always recorded, so that the events already in the store expire if the maximum age is set later.
+    self.insertionDates[@(item.storeId)] = [NSDate date];
+    if (self.maxByteSize) {
+        self.storedBytes += payload.byteSize;
+    }
+    [self evictEvents];
+}
+
+/// Must be called within a synchronized block.
+- (void)removeItemWithStoreId:(long long)storeId {
+    SPEmitterEvent *item = [self itemWithStoreId:storeId];
+    if (!item) {
+        return;
+    }
+    if (storeId < self.headStoreId) {
+        [self.displacedItems removeObjectAtIndex:[self displacedIndexOfStoreId:storeId]];
+    } else {
+        self.slots[[self slotIndexOfStoreId:storeId]] = [NSNull null];
+    }
+    self.eventCount--;
+    [self.insertionDates removeObjectForKey:@(storeId)];
+    [self.leases removeObjectForKey:@(storeId)];
+    [self.attempts removeObjectForKey:@(storeId)];
+    if (self.maxByteSize) {
+        self.storedBytes -= MIN(item.payload.byteSize, self.storedBytes);
+    }
+    if (!self.eventCount && self.slots.count > (self.capacity ?: kSPInitialSlotCount)) {
+        [self resetSlots];
+        return;
+    }
+    if (storeId >= self.headStoreId) {
+        [self advanceHead];
+    }
+}
+
+/// Removes the expired events and, when the store is over capacity, the events with lowest priority
+/// (oldest first) down to the low water mark.
+/// Must be called within a synchronized block.
+- (void)evictEvents {
+    if (self.maxEventAge > 0) {
+        // Events are ordered by insertion, so the expired ones are at the beginning.
+        NSDate *expiryDate = [NSDate dateWithTimeIntervalSinceNow:-self.maxEventAge];
+        NSMutableArray<NSNumber *> *expiredStoreIds = [NSMutableArray new];
+        [self enumerateItemsUsingBlock:^(SPEmitterEvent *item, BOOL *stop) {
+            NSDate *insertionDate = self.insertionDates[@(item.storeId)];
+            if (!insertionDate) {
+                return;
+            }
+            if ([insertionDate compare:expiryDate] != NSOrderedAscending) {
+                *stop = YES;
+                return;
+            }
+            [expiredStoreIds addObject:@(item.storeId)];
+        }];
+        for (NSNumber *storeId in expiredStoreIds) {
+            [self removeItemWithStoreId:storeId.longLongValue];
+        }
+    }
+
+    BOOL isOverCount = self.maxEventCount && self.eventCount > self.maxEventCount;
+    BOOL isOverBytes = self.maxByteSize && self.storedBytes > self.maxByteSize;
+    if (!isOverCount && !isOverBytes) {
+        return;
+    }
+    NSUInteger targetCount = self.maxEventCount ? (NSUInteger)(self.maxEventCount * kSPEvictionLowWaterMark) : NSUIntegerMax;
+    NSUInteger targetBytes = self.maxByteSize ? (NSUInteger)(self.maxByteSize * kSPEvictionLowWaterMark) : NSUIntegerMax;
+    NSMutableArray<SPEmitterEvent *> *items = [NSMutableArray arrayWithCapacity:self.eventCount];
+    [self enumerateItemsUsingBlock:^(SPEmitterEvent *item, BOOL *stop) {
+        [items addObject:item];
+    }];
+    NSArray<SPEmitterEvent *> *candidates = [items sortedArrayWithOptions:NSSortStable usingComparator:^NSComparisonResult(SPEmitterEvent *a, SPEmitterEvent *b) {
+        NSInteger priorityA = a.payload.priority;
+        NSInteger priorityB = b.payload.priority;
+        return priorityA < priorityB ? NSOrderedAscending : (priorityA > priorityB ? NSOrderedDescending : NSOrderedSame);
+    }];
+    NSUInteger evictCount = 0;
+    while (evictCount < candidates.count && (self.eventCount > targetCount || (self.maxByteSize && self.storedBytes > targetBytes))) {
+        [self removeItemWithStoreId:candidates[evictCount].storeId];
+        evictCount++;
+    }
+}
+
 @end
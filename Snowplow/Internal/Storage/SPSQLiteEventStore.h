@@ -26,9 +26,29 @@
 @class SPPayload;
 @class FMDatabaseQueue;
 
+/**
+ * Format of the events written to the database.
+ */
+typedef NS_ENUM(NSInteger, SPEventStoreEncoding) {
+    /// Events are stored as JSON.
+    SPEventStoreEncodingJSON = 0,
+    /// Events are stored in a compact binary format where the common keys are replaced by an index.
+    SPEventStoreEncodingCompact,
+    /// Events are stored in the compact binary format, compressed when it makes them smaller.
+    SPEventStoreEncodingCompactCompressed,
+} NS_SWIFT_NAME(EventStoreEncoding);
+
 NS_SWIFT_NAME(SQLiteEventStore)
 @interface SPSQLiteEventStore :NSObject <SPEventStore>
 
+/**
+ * Format of the events written to the database, JSON by default.
+ * Events in any format can be read, so the encoding can be changed at any time. When it changes, the events
+ * already stored are converted in background, which also lets an app switch back to JSON before downgrading
+ * to a tracker version that only reads JSON.
+ */
+@property (nonatomic) SPEventStoreEncoding encoding;
+
 /**
  * IMPORTANT: This method is for internal use only. It's signature and behaviour might change in any
  * future tracker release.
@@ -55,6 +75,13 @@ NS_SWIFT_NAME(SQLiteEventStore)
  */
 - (long long int)insertEvent:(SPPayload *)payload;
 
+/**
+ *  Inserts several events in a single transaction.
+ *  @param payloads The payloads to be inserted into the database.
+ *  @return The rowIds of the inserted entries in the same order of the payloads, -1 for the entries not inserted.
+ */
+- (NSArray<NSNumber *> *)insertEvents:(NSArray<SPPayload *> *)payloads;
+
 /**
  *  Finds the row in the event table with the supplied ID.
  *  @param id_ Unique ID of the row in the events table to be returned.
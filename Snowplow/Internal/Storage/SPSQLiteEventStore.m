@@ -24,6 +24,7 @@
 #import "SPPayload.h"
 #import "SPUtilities.h"
 #import "SPJSONSerialization.h"
+#import "SPCompactPayloadCodec.h"
 #import "SPLogger.h"
 
 #if SWIFT_PACKAGE
@@ -42,16 +43,102 @@
 
 @end
 
-@implementation SPSQLiteEventStore
+/// Fraction of the capacity kept when the store evicts events, so that eviction runs in bulk rather than on every insert.
+static const double kSPEvictionLowWaterMark = 0.9;
+/// Minimum interval in seconds between two checks of the expired events.
+static const NSTimeInterval kSPAgeEvictionInterval = 60;
+/// Time in seconds the events added are buffered so that they are written to the database in a single transaction.
+static const NSTimeInterval kSPGroupCommitWindow = 0.01;
+/// Number of events converted per transaction when the encoding changes.
+static const NSUInteger kSPEncodingMigrationPageSize = 100;
+/// Maximum number of dead-lettered events kept, the oldest ones are deleted first.
+static const NSUInteger kSPMaxDeadLetterEvents = 1000;
+
+@implementation SPSQLiteEventStore {
+    // Capacity and running totals, only accessed on the database queue.
+    NSUInteger _maxEventCount;
+    NSUInteger _maxByteSize;
+    NSTimeInterval _maxEventAge;
+    BOOL _isCapped;
+    NSUInteger _storedBytes;
+    NSDate *_lastAgeEvictionDate;
+    // Number of rows in the table, reconciled with the database when it's opened.
+    // It's only changed on the database queue, within @synchronized (self) so `count` doesn't need the queue.
+    NSUInteger _storedCount;
+    // Events waiting for the group commit, guarded by @synchronized (self).
+    NSMutableArray<NSData *> *_pendingEventData;
+    NSMutableArray<NSNumber *> *_pendingEventPriorities;
+    NSUInteger _committingCount;
+    BOOL _isCommitScheduled;
+    // Expiry date of the leased events keyed by store id, only accessed on the database queue.
+    NSMutableDictionary<NSNumber *, NSDate *> *_leases;
+    // Format of the new events, guarded by @synchronized (self).
+    SPEventStoreEncoding _encoding;
+    // Completed once the database is open and migrated.
+    dispatch_group_t _openGroup;
+    // Capacity set by the user until it's applied on the database queue, guarded by @synchronized (self).
+    NSUInteger _requestedMaxEventCount;
+    NSUInteger _requestedMaxByteSize;
+    NSTimeInterval _requestedMaxEventAge;
+}
 
 static NSString * const _queryCreateTable = @"CREATE TABLE IF NOT EXISTS 'events' (id INTEGER PRIMARY KEY, eventData BLOB, dateCreated TIMESTAMP DEFAULT CURRENT_TIMESTAMP)";
 static NSString * const _querySelectAll   = @"SELECT * FROM 'events'";
+static NSString * const _querySelectPage  = @"SELECT id, eventData FROM 'events' WHERE id > ? ORDER BY id LIMIT ?";
 static NSString * const _querySelectCount = @"SELECT Count(*) FROM 'events'";
-static NSString * const _queryInsertEvent = @"INSERT INTO 'events' (eventData) VALUES (?)";
+static NSString * const _queryInsertEvent = @"INSERT INTO 'events' (eventData, priority, byteSize, encoding) VALUES (?, ?, ?, ?)";
 static NSString * const _querySelectId    = @"SELECT * FROM 'events' WHERE id=?";
 static NSString * const _queryDeleteId    = @"DELETE FROM 'events' WHERE id=?";
 static NSString * const _queryDeleteIds   = @"DELETE FROM 'events' WHERE id IN (%@)";
 static NSString * const _queryDeleteAll   = @"DELETE FROM 'events'";
+static NSString * const _querySelectTotals = @"SELECT Count(*), Total(byteSize) FROM 'events'";
+static NSString * const _querySelectBytesForIds = @"SELECT Total(byteSize) FROM 'events' WHERE id IN (%@)";
+static NSString * const _querySelectEvictable = @"SELECT byteSize FROM 'events' ORDER BY priority, id";
+static NSString * const _queryDeleteEvictable = @"DELETE FROM 'events' WHERE id IN (SELECT id FROM 'events' ORDER BY priority, id LIMIT ?)";
+static NSString * const _querySelectExpiredTotals = @"SELECT Count(*), Total(byteSize) FROM 'events' WHERE dateCreated < datetime('now', ?)";
+static NSString * const _queryDeleteExpired = @"DELETE FROM 'events' WHERE dateCreated < datetime('now', ?)";
+static NSString * const _querySelectToEncode = @"SELECT id, eventData, byteSize FROM 'events' WHERE encoding != ? AND id > ? ORDER BY id LIMIT ?";
+static NSString * const _queryUpdateEventData = @"UPDATE 'events' SET eventData = ?, byteSize = ?, encoding = ? WHERE id = ?";
+static NSString * const _queryRecordAttempt = @"UPDATE 'events' SET attempts = attempts + 1, lastAttempt = CURRENT_TIMESTAMP WHERE id IN (%@)";
+static NSString * const _querySelectExhausted = @"SELECT id, byteSize FROM 'events' WHERE id IN (%@) AND attempts >= ?";
+static NSString * const _queryInsertDeadLetters = @"INSERT INTO 'deadLetterEvents' (eventData, attempts, lastAttempt, dateCreated) SELECT eventData, attempts, lastAttempt, dateCreated FROM 'events' WHERE id IN (%@) ORDER BY id";
+static NSString * const _queryTrimDeadLetters = @"DELETE FROM 'deadLetterEvents' WHERE id <= (SELECT id FROM 'deadLetterEvents' ORDER BY id DESC LIMIT 1 OFFSET ?)";
+static NSString * const _querySelectDeadLetters = @"SELECT id, eventData FROM 'deadLetterEvents' ORDER BY id LIMIT ?";
+static NSString * const _queryDeleteDeadLetters = @"DELETE FROM 'deadLetterEvents'";
+
+/// Values of the `encoding` column.
+typedef NS_ENUM(NSInteger, SPStoredEventFormat) {
+    SPStoredEventFormatJSON = 0,
+    SPStoredEventFormatCompact = 1,
+};
+
+static NSString *SPSQLiteFilenameForNamespace(NSString *namespace) {
+    static NSRegularExpression *regex;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        regex = [NSRegularExpression regularExpressionWithPattern:@"[^a-zA-Z0-9_]+" options:0 error:nil];
+    });
+    NSString *sqliteSuffix = [regex stringByReplacingMatchesInString:namespace options:0 range:NSMakeRange(0, namespace.length) withTemplate:@"-"];
+    return [NSString stringWithFormat:@"snowplowEvents-%@.sqlite", sqliteSuffix];
+}
+
+/// Schema migrations indexed by the `user_version` they migrate from.
+static NSArray<NSString *> *SPSQLiteEventStoreMigrations(void) {
+    return @[
+        // v0 -> v1: priority and size of the events, indices used by the eviction.
+        @"ALTER TABLE 'events' ADD COLUMN priority INTEGER DEFAULT 0;"
+        @"ALTER TABLE 'events' ADD COLUMN byteSize INTEGER DEFAULT 0;"
+        @"UPDATE 'events' SET byteSize = length(eventData);"
+        @"CREATE INDEX IF NOT EXISTS events_priority ON 'events' (priority);"
+        @"CREATE INDEX IF NOT EXISTS events_date ON 'events' (dateCreated);",
+        // v1 -> v2: format of the stored events, the existing ones are JSON.
+        @"ALTER TABLE 'events' ADD COLUMN encoding INTEGER DEFAULT 0;",
+        // v2 -> v3: attempts to send the events and the events given up after too many attempts.
+        @"ALTER TABLE 'events' ADD COLUMN attempts INTEGER DEFAULT 0;"
+        @"ALTER TABLE 'events' ADD COLUMN lastAttempt TIMESTAMP;"
+        @"CREATE TABLE IF NOT EXISTS 'deadLetterEvents' (id INTEGER PRIMARY KEY, eventData BLOB, attempts INTEGER, lastAttempt TIMESTAMP, dateCreated TIMESTAMP);",
+    ];
+}
 
 + (NSArray<NSString *> *)removeUnsentEventsExceptForNamespaces:(NSArray<NSString *> *)allowedNamespaces {
 #if SNOWPLOW_TARGET_TV
@@ -63,14 +150,13 @@ static NSString * const _queryDeleteAll   = @"DELETE FROM 'events'";
     NSArray<NSString *> *files = [NSFileManager.defaultManager contentsOfDirectoryAtPath:snowplowDirPath error:nil];
     NSMutableArray<NSString *> *allowedFiles = [NSMutableArray new];
     for (NSString *namespace in allowedNamespaces) {
-        NSRegularExpression *regex = [NSRegularExpression regularExpressionWithPattern:@"[^a-zA-Z0-9_]+" options:0 error:nil];
-        NSString *sqliteSuffix = [regex stringByReplacingMatchesInString:namespace options:0 range:NSMakeRange(0, namespace.length) withTemplate:@"-"];
-        NSString *sqliteFilename = [NSString stringWithFormat:@"snowplowEvents-%@.sqlite", sqliteSuffix];
-        [allowedFiles addObject:sqliteFilename];
+        [allowedFiles addObject:SPSQLiteFilenameForNamespace(namespace)];
     }
     NSMutableArray<NSString *> *removedFiles = [NSMutableArray new];
     for (NSString *file in files) {
-        if (![allowedFiles containsObject:file]) {
+        // The WAL and shared memory files (`<database>-wal`, `<database>-shm`) belong to their database.
+        NSString *databaseFile = [file stringByReplacingOccurrencesOfString:@"-(wal|shm)$" withString:@"" options:NSRegularExpressionSearch range:NSMakeRange(0, file.length)];
+        if (![allowedFiles containsObject:databaseFile]) {
             NSString *pathToRemove = [snowplowDirPath stringByAppendingPathComponent:file];
             [NSFileManager.defaultManager removeItemAtPath:pathToRemove error:nil];
             [removedFiles addObject:file];
@@ -93,45 +179,112 @@ static NSString * const _queryDeleteAll   = @"DELETE FROM 'events'";
 #else
         NSString *libraryPath = [NSSearchPathForDirectoriesInDomains(NSLibraryDirectory, NSUserDomainMask, YES) objectAtIndex:0];
 #endif
-        // Create snowplow subdirectory if it doesn't exist
         NSString *snowplowDirPath = [libraryPath stringByAppendingPathComponent:@"snowplow"];
-        [[NSFileManager defaultManager] createDirectoryAtPath:snowplowDirPath withIntermediateDirectories:YES attributes:nil error:nil];
-        
-        // Create path for the database
-        NSRegularExpression *regex = [NSRegularExpression regularExpressionWithPattern:@"[^a-zA-Z0-9_]+" options:0 error:nil];
-        NSString *sqliteSuffix = [regex stringByReplacingMatchesInString:namespace options:0 range:NSMakeRange(0, namespace.length) withTemplate:@"-"];
-        self.sqliteFilename = [NSString stringWithFormat:@"snowplowEvents-%@.sqlite", sqliteSuffix];
+        self.sqliteFilename = SPSQLiteFilenameForNamespace(namespace);
         self.dbPath = [snowplowDirPath stringByAppendingPathComponent:self.sqliteFilename];
 
-        // Migrate old database if it exists
-        NSString *oldDbPath = [libraryPath stringByAppendingPathComponent:@"snowplowEvents.sqlite"];
-        if ([[NSFileManager defaultManager] fileExistsAtPath:oldDbPath]) {
-            [[NSFileManager defaultManager] moveItemAtPath:oldDbPath toPath:self.dbPath error:nil];
-        }
+        _pendingEventData = [NSMutableArray new];
+        _pendingEventPriorities = [NSMutableArray new];
+        _isCommitScheduled = NO;
+        _leases = [NSMutableDictionary new];
 
-        // Create database
-        self.queue = [FMDatabaseQueue databaseQueueWithPath:self.dbPath];
-        [self createTable];
+        // Opening the database touches the file system, so it's done in background to keep it out of the app launch.
+        // `queue` waits for it, while the events added in the meantime are buffered for the group commit.
+        _openGroup = dispatch_group_create();
+        dispatch_group_async(_openGroup, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_HIGH, 0), ^{
+            [self openDatabaseWithLibraryPath:libraryPath];
+        });
     }
     return self;
 }
 
+- (void)openDatabaseWithLibraryPath:(NSString *)libraryPath {
+    // Create snowplow subdirectory if it doesn't exist
+    NSString *snowplowDirPath = [self.dbPath stringByDeletingLastPathComponent];
+    [[NSFileManager defaultManager] createDirectoryAtPath:snowplowDirPath withIntermediateDirectories:YES attributes:nil error:nil];
+
+    // Migrate old database if it exists
+    NSString *oldDbPath = [libraryPath stringByAppendingPathComponent:@"snowplowEvents.sqlite"];
+    if ([[NSFileManager defaultManager] fileExistsAtPath:oldDbPath]) {
+        [[NSFileManager defaultManager] moveItemAtPath:oldDbPath toPath:self.dbPath error:nil];
+        for (NSString *suffix in @[@"-wal", @"-shm"]) {
+            [[NSFileManager defaultManager] moveItemAtPath:[oldDbPath stringByAppendingString:suffix] toPath:[self.dbPath stringByAppendingString:suffix] error:nil];
+        }
+    }
+
+    // Create database
+    _queue = [FMDatabaseQueue databaseQueueWithPath:self.dbPath];
+    [self configureDatabase];
+    [self createTable];
+}
+
+- (FMDatabaseQueue *)queue {
+    dispatch_group_wait(_openGroup, DISPATCH_TIME_FOREVER);
+    return _queue;
+}
+
 - (void) dealloc {
+    // Write the events still waiting for the group commit.
+    NSArray<NSData *> *pendingEventData = _pendingEventData;
+    NSArray<NSNumber *> *pendingEventPriorities = _pendingEventPriorities;
+    [self.queue inDatabase:^(FMDatabase *db) {
+        if (pendingEventData.count && [db open]) {
+            [db beginTransaction];
+            for (NSUInteger i = 0; i < pendingEventData.count; i++) {
+                NSData *data = pendingEventData[i];
+                [db executeUpdate:_queryInsertEvent, data, pendingEventPriorities[i], @(data.length), @([SPSQLiteEventStore formatOfData:data])];
+            }
+            [db commit];
+        }
+    }];
     [self.queue close];
 }
 
 // MARK: SPEventStore implementation methods
 
 - (void)addEvent:(SPPayload *)payload {
-    [self insertDictionaryData:[payload getAsDictionary]];
+    [self addEvents:@[payload]];
+}
+
+- (void)addEvents:(NSArray<SPPayload *> *)payloads {
+    NSMutableArray<NSData *> *dataArray = [NSMutableArray arrayWithCapacity:payloads.count];
+    NSMutableArray<NSNumber *> *priorities = [NSMutableArray arrayWithCapacity:payloads.count];
+    for (SPPayload *payload in payloads) {
+        NSData *data = [self dataWithPayload:payload];
+        if (data) {
+            [dataArray addObject:data];
+            [priorities addObject:@(payload.priority)];
+        }
+    }
+    if (!dataArray.count) {
+        return;
+    }
+    BOOL scheduleCommit = NO;
+    // Added together, the events are written by the same group commit transaction.
+    @synchronized (self) {
+        [_pendingEventData addObjectsFromArray:dataArray];
+        [_pendingEventPriorities addObjectsFromArray:priorities];
+        scheduleCommit = !_isCommitScheduled;
+        _isCommitScheduled = YES;
+    }
+    if (scheduleCommit) {
+        __weak __typeof__(self) weakSelf = self;
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(kSPGroupCommitWindow * NSEC_PER_SEC)), dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+            [weakSelf commitPendingEvents];
+        });
+    }
 }
 
 - (BOOL)removeEventWithId:(long long)storeId {
     __block BOOL res = NO;
     [self.queue inDatabase:^(FMDatabase *db) {
         if ([db open]) {
+            [self commitPendingEventsInDatabase:db];
             SPLogDebug(@"Removing %@ from database now.", [@(storeId) stringValue]);
+            NSUInteger byteSize = self->_isCapped ? [self byteSizeOfEventsWithIds:@[@(storeId)] database:db] : 0;
             res = [db executeUpdate:_queryDeleteId, [NSNumber numberWithLongLong:storeId]];
+            [self->_leases removeObjectForKey:@(storeId)];
+            [self didRemoveEventCount:(res ? db.changes : 0) byteSize:byteSize];
         }
     }];
     return res;
@@ -141,10 +294,14 @@ static NSString * const _queryDeleteAll   = @"DELETE FROM 'events'";
     __block BOOL res = NO;
     [self.queue inDatabase:^(FMDatabase *db) {
         if ([db open] && storeIds.count) {
+            [self commitPendingEventsInDatabase:db];
             NSString *ids = [storeIds componentsJoinedByString:@","];
             SPLogDebug(@"Removing [%@] from database now.", ids);
             NSString *query = [NSString stringWithFormat:_queryDeleteIds, ids];
+            NSUInteger byteSize = self->_isCapped ? [self byteSizeOfEventsWithIds:storeIds database:db] : 0;
             res = [db executeUpdate:query];
+            [self->_leases removeObjectsForKeys:storeIds];
+            [self didRemoveEventCount:(res ? db.changes : 0) byteSize:byteSize];
         }
     }];
     return res;
@@ -154,77 +311,462 @@ static NSString * const _queryDeleteAll   = @"DELETE FROM 'events'";
     __block BOOL res = NO;
     [self.queue inDatabase:^(FMDatabase *db) {
         if ([db open]) {
+            [self commitPendingEventsInDatabase:db];
             SPLogDebug(@"Removing all events from database now.");
             res = [db executeUpdate:_queryDeleteAll];
+            [self->_leases removeAllObjects];
+            if (res) {
+                [self setStoredCount:0];
+                self->_storedBytes = 0;
+            }
         }
     }];
     return res;
 }
 
 - (NSUInteger)count {
-    __block NSUInteger num = 0;
+    // The stored count is known once the database is open.
+    dispatch_group_wait(_openGroup, DISPATCH_TIME_FOREVER);
+    // Counted without committing the pending events, so that counting on the tracking path doesn't bypass the
+    // group commit. The reads through the database queue commit the pending events first.
+    @synchronized (self) {
+        return _storedCount + _committingCount + _pendingEventData.count;
+    }
+}
+
+- (NSArray<SPEmitterEvent *> *)emittableEventsWithQueryLimit:(NSUInteger)queryLimit {
+    return [self getAllEventsLimited:self.sendLimit];
+}
+
+- (NSArray<SPEmitterEvent *> *)leaseEmittableEventsWithQueryLimit:(NSUInteger)queryLimit leaseDuration:(NSTimeInterval)leaseDuration {
+    NSMutableArray<SPEmitterEvent *> *res = [NSMutableArray new];
     [self.queue inDatabase:^(FMDatabase *db) {
-        if ([db open]) {
-            FMResultSet *s = [db executeQuery:_querySelectCount];
+        if (![db open] || !queryLimit) {
+            return;
+        }
+        [self commitPendingEventsInDatabase:db];
+        [self expireLeases];
+        NSDate *expiryDate = [NSDate dateWithTimeIntervalSinceNow:leaseDuration];
+        // Pages through the table by id, skipping the events already leased.
+        long long int cursor = 0;
+        BOOL hasMorePages = YES;
+        while (hasMorePages && res.count < queryLimit) {
+            FMResultSet *s = [db executeQuery:_querySelectPage, @(cursor), @(queryLimit)];
+            NSUInteger rowCount = 0;
+            while (res.count < queryLimit && [s next]) {
+                rowCount++;
+                long long int index = [s longLongIntForColumnIndex:0];
+                cursor = index;
+                if (self->_leases[@(index)]) {
+                    continue;
+                }
+                SPPayload *payload = [self payloadWithData:[s dataForColumnIndex:1]];
+                if (!payload) {
+                    continue;
+                }
+                [res addObject:[[SPEmitterEvent alloc] initWithPayload:payload storeId:index]];
+                self->_leases[@(index)] = expiryDate;
+            }
+            [s close];
+            hasMorePages = rowCount == queryLimit;
+        }
+    }];
+    return res;
+}
+
+- (void)releaseEventsWithIds:(NSArray<NSNumber *> *)storeIds {
+    [self.queue inDatabase:^(FMDatabase *db) {
+        [self->_leases removeObjectsForKeys:storeIds];
+    }];
+}
+
+- (NSArray<NSNumber *> *)recordFailedAttemptForEventsWithIds:(NSArray<NSNumber *> *)storeIds maxAttempts:(NSUInteger)maxAttempts {
+    NSMutableArray<NSNumber *> *deadLetterIds = [NSMutableArray new];
+    if (!storeIds.count) {
+        return deadLetterIds;
+    }
+    [self.queue inDatabase:^(FMDatabase *db) {
+        if (![db open]) {
+            return;
+        }
+        NSString *ids = [storeIds componentsJoinedByString:@","];
+        BOOL isTransaction = [db beginTransaction];
+        BOOL res = [db executeUpdate:[NSString stringWithFormat:_queryRecordAttempt, ids]];
+        NSUInteger byteSize = 0;
+        if (res && maxAttempts) {
+            FMResultSet *s = [db executeQuery:[NSString stringWithFormat:_querySelectExhausted, ids], @(maxAttempts)];
             while ([s next]) {
-                num = [[NSNumber numberWithInt:[s intForColumnIndex:0]] integerValue];
+                [deadLetterIds addObject:@([s longLongIntForColumnIndex:0])];
+                byteSize += (NSUInteger)[s longLongIntForColumnIndex:1];
             }
             [s close];
         }
+        if (res && deadLetterIds.count) {
+            NSString *deadLetterIdList = [deadLetterIds componentsJoinedByString:@","];
+            res = [db executeUpdate:[NSString stringWithFormat:_queryInsertDeadLetters, deadLetterIdList]]
+                && [db executeUpdate:[NSString stringWithFormat:_queryDeleteIds, deadLetterIdList]]
+                && [db executeUpdate:_queryTrimDeadLetters, @(kSPMaxDeadLetterEvents)];
+        }
+        if (!res || (isTransaction && ![db commit])) {
+            SPLogError(@"Failed to record the attempt to send %@ events: %@", @(storeIds.count), db.lastErrorMessage);
+            if (isTransaction) {
+                [db rollback];
+            }
+            [deadLetterIds removeAllObjects];
+            return;
+        }
+        [self->_leases removeObjectsForKeys:deadLetterIds];
+        [self didRemoveEventCount:deadLetterIds.count byteSize:byteSize];
     }];
-    return num;
+    return deadLetterIds;
 }
 
-- (NSArray<SPEmitterEvent *> *)emittableEventsWithQueryLimit:(NSUInteger)queryLimit {
-    return [self getAllEventsLimited:self.sendLimit];
+- (NSArray<SPEmitterEvent *> *)deadLetterEventsWithQueryLimit:(NSUInteger)queryLimit {
+    NSMutableArray<SPEmitterEvent *> *res = [NSMutableArray new];
+    [self.queue inDatabase:^(FMDatabase *db) {
+        if (![db open]) {
+            return;
+        }
+        FMResultSet *s = [db executeQuery:_querySelectDeadLetters, @(queryLimit)];
+        while ([s next]) {
+            SPPayload *payload = [self payloadWithData:[s dataForColumnIndex:1]];
+            if (payload) {
+                [res addObject:[[SPEmitterEvent alloc] initWithPayload:payload storeId:[s longLongIntForColumnIndex:0]]];
+            }
+        }
+        [s close];
+    }];
+    return res;
+}
+
+- (BOOL)removeAllDeadLetterEvents {
+    __block BOOL res = NO;
+    [self.queue inDatabase:^(FMDatabase *db) {
+        if ([db open]) {
+            res = [db executeUpdate:_queryDeleteDeadLetters];
+        }
+    }];
+    return res;
+}
+
+/// Must be called on the database queue.
+- (void)expireLeases {
+    if (!_leases.count) {
+        return;
+    }
+    NSDate *now = [NSDate date];
+    NSArray<NSNumber *> *expired = [_leases keysOfEntriesPassingTest:^BOOL(NSNumber *key, NSDate *expiryDate, BOOL *stop) {
+        return [expiryDate compare:now] != NSOrderedDescending;
+    }].allObjects;
+    [_leases removeObjectsForKeys:expired];
+}
+
+- (void)setCapacityWithMaxEventCount:(NSUInteger)maxEventCount maxByteSize:(NSUInteger)maxByteSize maxEventAge:(NSTimeInterval)maxEventAge {
+    @synchronized (self) {
+        _requestedMaxEventCount = maxEventCount;
+        _requestedMaxByteSize = maxByteSize;
+        _requestedMaxEventAge = maxEventAge;
+    }
+    if (dispatch_group_wait(_openGroup, DISPATCH_TIME_NOW) == 0) {
+        [self applyRequestedCapacity];
+    } else {
+        // The capacity is usually set while the tracker is created: it's applied once the database is open.
+        dispatch_group_notify(_openGroup, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+            [self applyRequestedCapacity];
+        });
+    }
+}
+
+- (void)applyRequestedCapacity {
+    [self.queue inDatabase:^(FMDatabase *db) {
+        @synchronized (self) {
+            self->_maxEventCount = self->_requestedMaxEventCount;
+            self->_maxByteSize = self->_requestedMaxByteSize;
+            self->_maxEventAge = self->_requestedMaxEventAge;
+        }
+        self->_isCapped = self->_maxEventCount || self->_maxByteSize || self->_maxEventAge > 0;
+        self->_lastAgeEvictionDate = nil;
+        if (![db open]) {
+            return;
+        }
+        [self commitPendingEventsInDatabase:db];
+        if (!self->_isCapped) {
+            return;
+        }
+        FMResultSet *s = [db executeQuery:_querySelectTotals];
+        if ([s next]) {
+            [self setStoredCount:(NSUInteger)[s longLongIntForColumnIndex:0]];
+            self->_storedBytes = (NSUInteger)[s doubleForColumnIndex:1];
+        }
+        [s close];
+        [self evictEventsInDatabase:db];
+    }];
 }
 
 // MARK: SPSQLiteEventStore methods
 
 - (BOOL) createTable {
     __block BOOL res = NO;
-    [self.queue inDatabase:^(FMDatabase *db) {
+    [_queue inDatabase:^(FMDatabase *db) {
         if ([db open]) {
-            res = [db executeStatements:_queryCreateTable];
+            res = [db executeStatements:_queryCreateTable] && [self migrateDatabase:db];
+            FMResultSet *s = [db executeQuery:_querySelectCount];
+            if ([s next]) {
+                [self setStoredCount:(NSUInteger)[s longLongIntForColumnIndex:0]];
+            }
+            [s close];
         }
     }];
     return res;
 }
 
+- (void)configureDatabase {
+    [_queue inDatabase:^(FMDatabase *db) {
+        if ([db open]) {
+            // WAL lets reads run alongside the writes and, with synchronous=NORMAL, it syncs only on checkpoints.
+            FMResultSet *s = [db executeQuery:@"PRAGMA journal_mode=WAL"];
+            [s next];
+            [s close];
+            [db executeStatements:@"PRAGMA synchronous=NORMAL"];
+            db.shouldCacheStatements = YES;
+        }
+    }];
+}
+
+- (BOOL)migrateDatabase:(FMDatabase *)db {
+    NSArray<NSString *> *migrations = SPSQLiteEventStoreMigrations();
+    uint32_t version = db.userVersion;
+    while (version < migrations.count) {
+        [db beginTransaction];
+        if (![db executeStatements:migrations[version]]) {
+            SPLogError(@"Failed to migrate the event store from version %@: %@", @(version), db.lastErrorMessage);
+            [db rollback];
+            return NO;
+        }
+        version++;
+        db.userVersion = version;
+        [db commit];
+    }
+    return YES;
+}
+
 - (long long int) insertEvent:(SPPayload *)payload {
-    return [self insertDictionaryData:[payload getAsDictionary]];
+    return [self insertJsonData:[self dataWithPayload:payload] priority:payload.priority];
 }
 
-- (long long int) insertDictionaryData:(NSDictionary *)dict {
+- (long long int) insertJsonData:(NSData *)data priority:(NSInteger)priority {
     __block long long int res = -1;
-    if (!dict) {
-      return res;
+    if (!data) {
+        return res;
     }
     [self.queue inDatabase:^(FMDatabase *db) {
         if ([db open]) {
-            NSData *data = [SPJSONSerialization serializeDictionary:dict];
-            if (!data) {
-                return;
+            [self commitPendingEventsInDatabase:db];
+            if ([self insertJsonData:data priority:priority database:db]) {
+                res = (long long int) [db lastInsertRowId];
+                @synchronized (self) {
+                    self->_storedCount++;
+                }
+                if (self->_isCapped) {
+                    [self evictEventsInDatabase:db];
+                }
+            }
+        }
+    }];
+    return res;
+}
+
+- (NSArray<NSNumber *> *)insertEvents:(NSArray<SPPayload *> *)payloads {
+    NSMutableArray<NSData *> *dataArray = [NSMutableArray arrayWithCapacity:payloads.count];
+    for (SPPayload *payload in payloads) {
+        [dataArray addObject:[self dataWithPayload:payload] ?: [NSData data]];
+    }
+    __block NSMutableArray<NSNumber *> *res = [NSMutableArray arrayWithCapacity:payloads.count];
+    [self.queue inDatabase:^(FMDatabase *db) {
+        if (![db open]) {
+            return;
+        }
+        [self commitPendingEventsInDatabase:db];
+        NSUInteger insertedCount = 0;
+        NSUInteger insertedBytes = 0;
+        BOOL isTransaction = [db beginTransaction];
+        for (NSUInteger i = 0; i < dataArray.count; i++) {
+            NSData *data = dataArray[i];
+            if (data.length && [self insertJsonData:data priority:payloads[i].priority database:db]) {
+                [res addObject:@([db lastInsertRowId])];
+                insertedCount++;
+                insertedBytes += data.length;
+            } else {
+                [res addObject:@(-1)];
             }
-            [db executeUpdate:_queryInsertEvent, data];
-            res = (long long int) [db lastInsertRowId];
+        }
+        if (isTransaction && ![db commit]) {
+            SPLogError(@"Failed to write %@ events to the database: %@", @(dataArray.count), db.lastErrorMessage);
+            [db rollback];
+            self->_storedBytes -= MIN(insertedBytes, self->_storedBytes);
+            insertedCount = 0;
+            res = [NSMutableArray new];
+        }
+        @synchronized (self) {
+            self->_storedCount += insertedCount;
+        }
+        if (self->_isCapped) {
+            [self evictEventsInDatabase:db];
         }
     }];
+    // Failed inserts are reported as -1.
+    while (res.count < payloads.count) {
+        [res addObject:@(-1)];
+    }
     return res;
 }
 
+- (BOOL)insertJsonData:(NSData *)data priority:(NSInteger)priority database:(FMDatabase *)db {
+    if (![db executeUpdate:_queryInsertEvent, data, @(priority), @(data.length), @([SPSQLiteEventStore formatOfData:data])]) {
+        return NO;
+    }
+    _storedBytes += data.length;
+    return YES;
+}
+
+/// Must be called on the database queue.
+- (void)setStoredCount:(NSUInteger)storedCount {
+    @synchronized (self) {
+        _storedCount = storedCount;
+    }
+}
+
+// MARK: - Group commit
+
+- (void)commitPendingEvents {
+    [self.queue inDatabase:^(FMDatabase *db) {
+        if ([db open]) {
+            [self commitPendingEventsInDatabase:db];
+        }
+    }];
+}
+
+/// Writes the events added since the last commit in a single transaction.
+/// The pending events are taken on the database queue so they are written in the order they were added.
+- (void)commitPendingEventsInDatabase:(FMDatabase *)db {
+    NSArray<NSData *> *pendingEventData;
+    NSArray<NSNumber *> *pendingEventPriorities;
+    @synchronized (self) {
+        _isCommitScheduled = NO;
+        if (!_pendingEventData.count) {
+            return;
+        }
+        pendingEventData = _pendingEventData.copy;
+        pendingEventPriorities = _pendingEventPriorities.copy;
+        [_pendingEventData removeAllObjects];
+        [_pendingEventPriorities removeAllObjects];
+        // Still counted until they are in the table.
+        _committingCount = pendingEventData.count;
+    }
+    NSUInteger insertedCount = 0;
+    NSUInteger insertedBytes = 0;
+    BOOL isTransaction = pendingEventData.count > 1 && [db beginTransaction];
+    for (NSUInteger i = 0; i < pendingEventData.count; i++) {
+        if ([self insertJsonData:pendingEventData[i] priority:pendingEventPriorities[i].integerValue database:db]) {
+            insertedCount++;
+            insertedBytes += pendingEventData[i].length;
+        }
+    }
+    BOOL isRolledBack = NO;
+    if (isTransaction && ![db commit]) {
+        SPLogError(@"Failed to write %@ events to the database, they will be written with the next commit: %@", @(pendingEventData.count), db.lastErrorMessage);
+        [db rollback];
+        _storedBytes -= MIN(insertedBytes, _storedBytes);
+        insertedCount = 0;
+        isRolledBack = YES;
+    }
+    @synchronized (self) {
+        _storedCount += insertedCount;
+        _committingCount = 0;
+        if (isRolledBack) {
+            // Put back ahead of the events added in the meantime to keep the order.
+            [_pendingEventData insertObjects:pendingEventData atIndexes:[NSIndexSet indexSetWithIndexesInRange:NSMakeRange(0, pendingEventData.count)]];
+            [_pendingEventPriorities insertObjects:pendingEventPriorities atIndexes:[NSIndexSet indexSetWithIndexesInRange:NSMakeRange(0, pendingEventPriorities.count)]];
+        }
+    }
+    if (_isCapped) {
+        [self evictEventsInDatabase:db];
+    }
+}
+
+// MARK: - Eviction
+
+- (NSUInteger)byteSizeOfEventsWithIds:(NSArray<NSNumber *> *)storeIds database:(FMDatabase *)db {
+    NSString *query = [NSString stringWithFormat:_querySelectBytesForIds, [storeIds componentsJoinedByString:@","]];
+    FMResultSet *s = [db executeQuery:query];
+    NSUInteger byteSize = [s next] ? (NSUInteger)[s doubleForColumnIndex:0] : 0;
+    [s close];
+    return byteSize;
+}
+
+- (void)didRemoveEventCount:(NSUInteger)count byteSize:(NSUInteger)byteSize {
+    @synchronized (self) {
+        _storedCount -= MIN(count, _storedCount);
+    }
+    _storedBytes -= MIN(byteSize, _storedBytes);
+}
+
+/// Removes the expired events and, when the store is over capacity, the events with lowest priority
+/// (oldest first) down to the low water mark with a single delete.
+- (void)evictEventsInDatabase:(FMDatabase *)db {
+    if (_maxEventAge > 0 && (!_lastAgeEvictionDate || -[_lastAgeEvictionDate timeIntervalSinceNow] >= kSPAgeEvictionInterval)) {
+        _lastAgeEvictionDate = [NSDate date];
+        NSString *modifier = [NSString stringWithFormat:@"-%lld seconds", (long long)_maxEventAge];
+        FMResultSet *s = [db executeQuery:_querySelectExpiredTotals, modifier];
+        NSUInteger count = 0;
+        NSUInteger byteSize = 0;
+        if ([s next]) {
+            count = (NSUInteger)[s longLongIntForColumnIndex:0];
+            byteSize = (NSUInteger)[s doubleForColumnIndex:1];
+        }
+        [s close];
+        if (count && [db executeUpdate:_queryDeleteExpired, modifier]) {
+            SPLogDebug(@"Evicted %@ expired events from the database.", @(count));
+            [self didRemoveEventCount:count byteSize:byteSize];
+        }
+    }
+
+    BOOL isOverCount = _maxEventCount && _storedCount > _maxEventCount;
+    BOOL isOverBytes = _maxByteSize && _storedBytes > _maxByteSize;
+    if (!isOverCount && !isOverBytes) {
+        return;
+    }
+    NSUInteger targetCount = _maxEventCount ? (NSUInteger)(_maxEventCount * kSPEvictionLowWaterMark) : NSUIntegerMax;
+    NSUInteger targetBytes = _maxByteSize ? (NSUInteger)(_maxByteSize * kSPEvictionLowWaterMark) : NSUIntegerMax;
+    NSUInteger evictCount = 0;
+    NSUInteger evictBytes = 0;
+    FMResultSet *s = [db executeQuery:_querySelectEvictable];
+    while ((evictCount < _storedCount && _storedCount - evictCount > targetCount)
+           || (evictBytes < _storedBytes && _storedBytes - evictBytes > targetBytes)) {
+        if (![s next]) {
+            break;
+        }
+        evictCount++;
+        evictBytes += (NSUInteger)[s longLongIntForColumnIndex:0];
+    }
+    [s close];
+    if (evictCount && [db executeUpdate:_queryDeleteEvictable, @(evictCount)]) {
+        SPLogDebug(@"Evicted %@ events from the database over capacity.", @(evictCount));
+        [self didRemoveEventCount:evictCount byteSize:evictBytes];
+    }
+}
+
 - (SPEmitterEvent *) getEventWithId:(long long int)id_ {
     __block SPEmitterEvent *event = nil;
     [self.queue inDatabase:^(FMDatabase *db) {
         if ([db open]) {
+            [self commitPendingEventsInDatabase:db];
             FMResultSet *s = [db executeQuery:_querySelectId, [NSNumber numberWithLongLong:id_]];
             while ([s next]) {
-                NSData *data = [s dataForColumn:@"eventData"];
-                NSDictionary *dict = [SPJSONSerialization deserializeData:data];
-                if (!dict) {
+                SPPayload *payload = [self payloadWithData:[s dataForColumn:@"eventData"]];
+                if (!payload) {
                     continue;
                 }
-                SPPayload *payload = [[SPPayload alloc] initWithNSDictionary:dict];
                 event = [[SPEmitterEvent alloc] initWithPayload:payload storeId:id_];
             }
             [s close];
@@ -238,7 +780,7 @@ static NSString * const _queryDeleteAll   = @"DELETE FROM 'events'";
 }
 
 - (NSArray<SPEmitterEvent *> *)getAllEventsLimited:(NSUInteger)limit {
-    NSString *query = [NSString stringWithFormat:@"%@ LIMIT %@", _querySelectAll, [@(limit) stringValue]];
+    NSString *query = [NSString stringWithFormat:@"%@ ORDER BY id LIMIT %@", _querySelectAll, [@(limit) stringValue]];
     return [self getAllEventsWithQuery:query];
 }
 
@@ -246,15 +788,14 @@ static NSString * const _queryDeleteAll   = @"DELETE FROM 'events'";
     __block NSMutableArray *res = [[NSMutableArray alloc] init];
     [self.queue inDatabase:^(FMDatabase *db) {
         if ([db open]) {
+            [self commitPendingEventsInDatabase:db];
             FMResultSet *s = [db executeQuery:query];
             while ([s next]) {
                 long long int index = [s longLongIntForColumn:@"ID"];
-                NSData *data = [s dataForColumn:@"eventData"];
-                NSDictionary *dict = [SPJSONSerialization deserializeData:data];
-                if (!dict) {
+                SPPayload *payload = [self payloadWithData:[s dataForColumn:@"eventData"]];
+                if (!payload) {
                     continue;
                 }
-                SPPayload *payload = [[SPPayload alloc] initWithNSDictionary:dict];
                 SPEmitterEvent *event = [[SPEmitterEvent alloc] initWithPayload:payload storeId:index];
                 [res addObject:event];
             }
@@ -264,9 +805,110 @@ static NSString * const _queryDeleteAll   = @"DELETE FROM 'events'";
     return res;
 }
 
+// MARK: Encoding
+
+- (SPEventStoreEncoding)encoding {
+    @synchronized (self) {
+        return _encoding;
+    }
+}
+
+- (void)setEncoding:(SPEventStoreEncoding)encoding {
+    @synchronized (self) {
+        if (_encoding == encoding) {
+            return;
+        }
+        _encoding = encoding;
+    }
+    __weak __typeof__(self) weakSelf = self;
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_BACKGROUND, 0), ^{
+        [weakSelf convertStoredEventsToEncoding:encoding];
+    });
+}
+
+- (NSData *)dataWithPayload:(SPPayload *)payload {
+    SPEventStoreEncoding encoding = self.encoding;
+    if (encoding != SPEventStoreEncodingJSON) {
+        NSData *data = [SPCompactPayloadCodec dataWithPayload:payload compress:(encoding == SPEventStoreEncodingCompactCompressed)];
+        if (data) {
+            return data;
+        }
+    }
+    // Payloads with values the compact format can't hold are stored as JSON.
+    // It's checked before it's written so that the rows can be sent as they are.
+    NSData *data = [payload jsonData];
+    if (![SPPayload isJsonObjectData:data]) {
+        SPLogError(@"Event not stored: the payload isn't a valid JSON object.");
+        return nil;
+    }
+    return data;
+}
+
+- (SPPayload *)payloadWithData:(NSData *)data {
+    if ([SPCompactPayloadCodec isCompactData:data]) {
+        return [SPCompactPayloadCodec payloadWithData:data];
+    }
+    if (![SPPayload isJsonObjectData:data]) {
+        return nil;
+    }
+    // The stored bytes are passed as they are, the payload is parsed only if needed.
+    return [[SPPayload alloc] initWithJsonData:data];
+}
+
++ (SPStoredEventFormat)formatOfData:(NSData *)data {
+    return [SPCompactPayloadCodec isCompactData:data] ? SPStoredEventFormatCompact : SPStoredEventFormatJSON;
+}
+
+/// Rewrites the stored events in the encoding, one page per transaction so other operations can interleave.
+/// It stops if the encoding changes again in the meantime.
+- (void)convertStoredEventsToEncoding:(SPEventStoreEncoding)encoding {
+    SPStoredEventFormat format = encoding == SPEventStoreEncodingJSON ? SPStoredEventFormatJSON : SPStoredEventFormatCompact;
+    __block long long int cursor = 0;
+    __block BOOL hasMorePages = YES;
+    __block NSUInteger convertedCount = 0;
+    while (hasMorePages && self.encoding == encoding) {
+        [self.queue inDatabase:^(FMDatabase *db) {
+            if (![db open]) {
+                hasMorePages = NO;
+                return;
+            }
+            NSMutableArray<NSArray *> *rows = [NSMutableArray new];
+            FMResultSet *s = [db executeQuery:_querySelectToEncode, @(format), @(cursor), @(kSPEncodingMigrationPageSize)];
+            while ([s next]) {
+                [rows addObject:@[@([s longLongIntForColumnIndex:0]), [s dataForColumnIndex:1] ?: [NSData data], @([s longLongIntForColumnIndex:2])]];
+            }
+            [s close];
+            hasMorePages = rows.count == kSPEncodingMigrationPageSize;
+
+            [db beginTransaction];
+            long long int byteSizeDelta = 0;
+            for (NSArray *row in rows) {
+                cursor = [row[0] longLongValue];
+                SPPayload *payload = [self payloadWithData:row[1]];
+                NSData *data = payload ? [self dataWithPayload:payload] : nil;
+                if (!data || [SPSQLiteEventStore formatOfData:data] != format) {
+                    continue;
+                }
+                if ([db executeUpdate:_queryUpdateEventData, data, @(data.length), @(format), row[0]]) {
+                    byteSizeDelta += (long long int)data.length - [row[2] longLongValue];
+                    convertedCount++;
+                }
+            }
+            if ([db commit]) {
+                self->_storedBytes = (NSUInteger)MAX((long long int)self->_storedBytes + byteSizeDelta, 0);
+            } else {
+                [db rollback];
+                hasMorePages = NO;
+            }
+        }];
+    }
+    SPLogDebug(@"Converted %@ stored events to encoding %@.", @(convertedCount), @(encoding));
+}
+
 - (long long int) getLastInsertedRowId {
     __block long long int res = -1;
     [self.queue inDatabase:^(FMDatabase *db) {
+        [self commitPendingEventsInDatabase:db];
         res = [db lastInsertRowId];
     }];
     return res;
@@ -0,0 +1,57 @@
+//
+//  SPSegmentEventStore.h
+//  Snowplow
+//
+//  Copyright (c) 2013-2022 Snowplow Analytics Ltd. All rights reserved.
+//
+//  This program is licensed to you under the Apache License Version 2.0,
+//  and you may not use this file except in compliance with the Apache License
+//  Version 2.0. You may obtain a copy of the Apache License Version 2.0 at
+//  http://www.apache.org/licenses/LICENSE-2.0.
+//
+//  Unless required by applicable law or agreed to in writing,
+//  software distributed under the Apache License Version 2.0 is distributed on
+//  an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+//  express or implied. See the Apache License Version 2.0 for the specific
+//  language governing permissions and limitations there under.
+//
+//  License: Apache License Version 2.0
+//
+
+#import <Foundation/Foundation.h>
+#import "SPEventStore.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * EventStore persisting the events in an append-only log of memory-mapped segment files.
+ * Events are appended as length-prefixed records and read back sequentially. A small checkpoint file
+ * records which events have been removed, and segments are deleted whole once all their events are removed.
+ * It suits apps tracking a high volume of events as there is no per-event database maintenance.
+ *
+ * Each record keeps the priority and the insertion time of the event, used to evict the events when
+ * a capacity is set. Records written by previous versions are evicted with the default priority and
+ * expire based on the modification date of their segment. Segments written by this version can't be
+ * read by previous versions.
+ */
+NS_SWIFT_NAME(SegmentEventStore)
+@interface SPSegmentEventStore : NSObject <SPEventStore>
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ * Opens (or creates) the event log associated to the tracker namespace.
+ * @param namespace The namespace of the tracker.
+ */
+- (instancetype)initWithNamespace:(NSString *)namespace;
+
+/**
+ * Opens (or creates) the event log associated to the tracker namespace.
+ * @param namespace The namespace of the tracker.
+ * @param segmentSize The size in bytes of each segment file.
+ */
+- (instancetype)initWithNamespace:(NSString *)namespace segmentSize:(NSUInteger)segmentSize;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,583 @@
+//
+//  SPSegmentEventStore.m
+//  Snowplow
+//
+//  Copyright (c) 2013-2022 Snowplow Analytics Ltd. All rights reserved.
+//
+//  This program is licensed to you under the Apache License Version 2.0,
+//  and you may not use this file except in compliance with the Apache License
+//  Version 2.0. You may obtain a copy of the Apache License Version 2.0 at
+//  http://www.apache.org/licenses/LICENSE-2.0.
+//
+//  Unless required by applicable law or agreed to in writing,
+//  software distributed under the Apache License Version 2.0 is distributed on
+//  an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+//  express or implied. See the Apache License Version 2.0 for the specific
+//  language governing permissions and limitations there under.
+//
+//  License: Apache License Version 2.0
+//
+
+#import "SPTrackerConstants.h"
+#import "SPSegmentEventStore.h"
+#import "SPLogger.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/// Size of the record header: the length of the serialized payload.
+static const NSUInteger kSPRecordHeaderSize = sizeof(uint32_t);
+/// Set in the length of the records followed by their metadata: the priority and the insertion time.
+/// Records written by previous versions have no metadata.
+static const uint32_t kSPRecordMetadataFlag = 0x80000000;
+static const NSUInteger kSPRecordMetadataSize = sizeof(int32_t) + sizeof(double);
+static const NSUInteger kSPDefaultSegmentSize = 1024 * 1024;
+static NSString * const kSPSegmentExtension = @"segment";
+static NSString * const kSPCheckpointFilename = @"checkpoint";
+/// Fraction of the capacity kept when the store evicts events, so that eviction runs in bulk rather than on every insert.
+static const double kSPEvictionLowWaterMark = 0.9;
+
+// MARK: - SPEventSegment
+
+/**
+ * A segment file mapped in memory. Records are appended as a 4 bytes length, the metadata (priority and
+ * insertion time) and the payload JSON.
+ * The file is zero filled when created, so a zero length marks the end of the records.
+ * The length is written after the payload, so a record interrupted by a crash is never read back.
+ * Records without metadata get the default priority and the modification date of the file as insertion time.
+ */
+@interface SPEventSegment : NSObject
+
+@property (nonatomic, readonly) long long baseId;
+@property (nonatomic, readonly) NSString *path;
+@property (nonatomic, readonly) NSUInteger capacity;
+@property (nonatomic, readonly) NSUInteger writeOffset;
+
+- (instancetype)init NS_UNAVAILABLE;
+- (nullable instancetype)initWithPath:(NSString *)path baseId:(long long)baseId capacity:(NSUInteger)capacity;
+- (NSUInteger)recordCount;
+- (BOOL)appendData:(NSData *)data priority:(NSInteger)priority insertionTime:(NSTimeInterval)insertionTime;
+- (NSData *)dataForRecordAtIndex:(NSUInteger)index;
+- (NSUInteger)lengthOfRecordAtIndex:(NSUInteger)index;
+- (NSInteger)priorityOfRecordAtIndex:(NSUInteger)index;
+- (NSTimeInterval)insertionTimeOfRecordAtIndex:(NSUInteger)index;
+- (void)sync;
+- (void)remove;
+
+@end
+
+@implementation SPEventSegment {
+    int _fd;
+    uint8_t *_bytes;
+    NSMutableData *_recordOffsets;
+    /// Insertion time of the records without metadata.
+    NSTimeInterval _modificationTime;
+}
+
+- (instancetype)initWithPath:(NSString *)path baseId:(long long)baseId capacity:(NSUInteger)capacity {
+    if (self = [super init]) {
+        _path = path;
+        _baseId = baseId;
+        _bytes = NULL;
+        _fd = open(path.fileSystemRepresentation, O_RDWR | O_CREAT, 0600);
+        if (_fd < 0) {
+            SPLogError(@"Unable to open the event segment %@ (errno %d).", path, errno);
+            return nil;
+        }
+        struct stat fileStat;
+        if (fstat(_fd, &fileStat) != 0) {
+            [self close];
+            return nil;
+        }
+        NSUInteger size = (NSUInteger)fileStat.st_size;
+        _modificationTime = fileStat.st_mtimespec.tv_sec + fileStat.st_mtimespec.tv_nsec / 1e9;
+        if (size < capacity) {
+            // New segment: the file is extended with zeros.
+            if (ftruncate(_fd, (off_t)capacity) != 0) {
+                SPLogError(@"Unable to allocate the event segment %@ (errno %d).", path, errno);
+                [self close];
+                return nil;
+            }
+            size = capacity;
+        }
+        void *bytes = size ? mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0) : MAP_FAILED;
+        if (bytes == MAP_FAILED) {
+            SPLogError(@"Unable to map the event segment %@ (errno %d).", path, errno);
+            [self close];
+            return nil;
+        }
+        _bytes = bytes;
+        _capacity = size;
+        _recordOffsets = [NSMutableData new];
+        [self scanRecords];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [self close];
+}
+
+- (void)scanRecords {
+    NSUInteger offset = 0;
+    while (offset + kSPRecordHeaderSize <= _capacity) {
+        uint32_t header;
+        memcpy(&header, _bytes + offset, sizeof(header));
+        NSUInteger recordSize = [self sizeOfRecordWithHeader:header];
+        if (!header || offset + recordSize > _capacity) {
+            break;
+        }
+        uint32_t recordOffset = (uint32_t)offset;
+        [_recordOffsets appendBytes:&recordOffset length:sizeof(recordOffset)];
+        offset += recordSize;
+    }
+    _writeOffset = offset;
+}
+
+- (NSUInteger)sizeOfRecordWithHeader:(uint32_t)header {
+    if (header & kSPRecordMetadataFlag) {
+        return kSPRecordHeaderSize + kSPRecordMetadataSize + (header & ~kSPRecordMetadataFlag);
+    }
+    return kSPRecordHeaderSize + header;
+}
+
+- (uint32_t)headerOfRecordAtIndex:(NSUInteger)index offset:(NSUInteger *)offset {
+    *offset = ((const uint32_t *)_recordOffsets.bytes)[index];
+    uint32_t header;
+    memcpy(&header, _bytes + *offset, sizeof(header));
+    return header;
+}
+
+- (NSUInteger)recordCount {
+    return _recordOffsets.length / sizeof(uint32_t);
+}
+
+- (BOOL)appendData:(NSData *)data priority:(NSInteger)priority insertionTime:(NSTimeInterval)insertionTime {
+    NSUInteger length = data.length;
+    NSUInteger recordSize = kSPRecordHeaderSize + kSPRecordMetadataSize + length;
+    if (!_bytes || !length || length >= kSPRecordMetadataFlag || _writeOffset + recordSize > _capacity) {
+        return NO;
+    }
+    uint8_t *record = _bytes + _writeOffset;
+    int32_t recordPriority = (int32_t)MAX(MIN(priority, INT32_MAX), INT32_MIN);
+    memcpy(record + kSPRecordHeaderSize, &recordPriority, sizeof(recordPriority));
+    memcpy(record + kSPRecordHeaderSize + sizeof(recordPriority), &insertionTime, sizeof(insertionTime));
+    memcpy(record + kSPRecordHeaderSize + kSPRecordMetadataSize, data.bytes, length);
+    uint32_t header = (uint32_t)length | kSPRecordMetadataFlag;
+    memcpy(record, &header, sizeof(header));
+    uint32_t recordOffset = (uint32_t)_writeOffset;
+    [_recordOffsets appendBytes:&recordOffset length:sizeof(recordOffset)];
+    _writeOffset += recordSize;
+    return YES;
+}
+
+- (NSData *)dataForRecordAtIndex:(NSUInteger)index {
+    NSUInteger offset;
+    uint32_t header = [self headerOfRecordAtIndex:index offset:&offset];
+    NSUInteger payloadOffset = offset + kSPRecordHeaderSize + ((header & kSPRecordMetadataFlag) ? kSPRecordMetadataSize : 0);
+    return [NSData dataWithBytes:_bytes + payloadOffset length:(header & ~kSPRecordMetadataFlag)];
+}
+
+- (NSUInteger)lengthOfRecordAtIndex:(NSUInteger)index {
+    NSUInteger offset;
+    return [self headerOfRecordAtIndex:index offset:&offset] & ~kSPRecordMetadataFlag;
+}
+
+- (NSInteger)priorityOfRecordAtIndex:(NSUInteger)index {
+    NSUInteger offset;
+    if (!([self headerOfRecordAtIndex:index offset:&offset] & kSPRecordMetadataFlag)) {
+        return 0;
+    }
+    int32_t priority;
+    memcpy(&priority, _bytes + offset + kSPRecordHeaderSize, sizeof(priority));
+    return priority;
+}
+
+- (NSTimeInterval)insertionTimeOfRecordAtIndex:(NSUInteger)index {
+    NSUInteger offset;
+    if (!([self headerOfRecordAtIndex:index offset:&offset] & kSPRecordMetadataFlag)) {
+        return _modificationTime;
+    }
+    double insertionTime;
+    memcpy(&insertionTime, _bytes + offset + kSPRecordHeaderSize + sizeof(int32_t), sizeof(insertionTime));
+    return insertionTime;
+}
+
+- (void)sync {
+    if (_bytes) {
+        msync(_bytes, _capacity, MS_ASYNC);
+    }
+}
+
+- (void)close {
+    if (_bytes) {
+        munmap(_bytes, _capacity);
+        _bytes = NULL;
+    }
+    if (_fd >= 0) {
+        close(_fd);
+        _fd = -1;
+    }
+}
+
+- (void)remove {
+    [self close];
+    unlink(_path.fileSystemRepresentation);
+}
+
+@end
+
+// MARK: - SPSegmentEventStore
+
+typedef struct {
+    NSInteger priority;
+    long long storeId;
+} SPEvictionCandidate;
+
+/// Orders by priority, then from the oldest.
+static int SPCompareEvictionCandidates(const void *a, const void *b) {
+    const SPEvictionCandidate *candidateA = a;
+    const SPEvictionCandidate *candidateB = b;
+    if (candidateA->priority != candidateB->priority) {
+        return candidateA->priority < candidateB->priority ? -1 : 1;
+    }
+    return candidateA->storeId < candidateB->storeId ? -1 : (candidateA->storeId > candidateB->storeId ? 1 : 0);
+}
+
+@interface SPSegmentEventStore ()
+
+@property (nonatomic) NSString *directoryPath;
+@property (nonatomic) NSUInteger segmentSize;
+
+@end
+
+@implementation SPSegmentEventStore {
+    NSMutableArray<SPEventSegment *> *_segments;
+    // Every event with a lower id has been removed.
+    long long _acknowledgedId;
+    long long _nextId;
+    // Events removed with an id above _acknowledgedId.
+    NSMutableIndexSet *_removedIds;
+    NSUInteger _storedBytes;
+    NSUInteger _maxEventCount;
+    NSUInteger _maxByteSize;
+    NSTimeInterval _maxEventAge;
+}
+
+- (instancetype)initWithNamespace:(NSString *)namespace {
+    return [self initWithNamespace:namespace segmentSize:kSPDefaultSegmentSize];
+}
+
+- (instancetype)initWithNamespace:(NSString *)namespace segmentSize:(NSUInteger)segmentSize {
+    if (self = [super init]) {
+        self.segmentSize = MAX(segmentSize, 1024);
+#if SNOWPLOW_TARGET_TV
+        NSString *libraryPath = [NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES) objectAtIndex:0];
+#else
+        NSString *libraryPath = [NSSearchPathForDirectoriesInDomains(NSLibraryDirectory, NSUserDomainMask, YES) objectAtIndex:0];
+#endif
+        // Kept outside the `snowplow` directory, which is cleaned up by the SQLite event store.
+        NSRegularExpression *regex = [NSRegularExpression regularExpressionWithPattern:@"[^a-zA-Z0-9_]+" options:0 error:nil];
+        NSString *suffix = [regex stringByReplacingMatchesInString:namespace options:0 range:NSMakeRange(0, namespace.length) withTemplate:@"-"];
+        self.directoryPath = [[libraryPath stringByAppendingPathComponent:@"snowplow-segments"] stringByAppendingPathComponent:suffix];
+        [[NSFileManager defaultManager] createDirectoryAtPath:self.directoryPath withIntermediateDirectories:YES attributes:nil error:nil];
+
+        _segments = [NSMutableArray new];
+        _removedIds = [NSMutableIndexSet new];
+        [self loadCheckpoint];
+        [self loadSegments];
+    }
+    return self;
+}
+
+// MARK: SPEventStore implementation methods
+
+- (void)addEvent:(SPPayload *)payload {
+    NSData *data = [payload jsonData];
+    // It's checked before it's written so that the records can be sent as they are.
+    if (![SPPayload isJsonObjectData:data]) {
+        SPLogError(@"Event not stored: the payload isn't a valid JSON object.");
+        return;
+    }
+    NSInteger priority = payload.priority;
+    @synchronized (self) {
+        NSTimeInterval insertionTime = [NSDate date].timeIntervalSince1970;
+        SPEventSegment *segment = _segments.lastObject;
+        if (!segment || ![segment appendData:data priority:priority insertionTime:insertionTime]) {
+            [segment sync];
+            NSUInteger capacity = MAX(self.segmentSize, kSPRecordHeaderSize + kSPRecordMetadataSize + data.length);
+            segment = [self createSegmentWithBaseId:_nextId capacity:capacity];
+            if (!segment || ![segment appendData:data priority:priority insertionTime:insertionTime]) {
+                SPLogError(@"Unable to append the event to the event log.");
+                return;
+            }
+            [_segments addObject:segment];
+        }
+        _nextId++;
+        _storedBytes += data.length;
+        [self evictEventsIfNeeded];
+    }
+}
+
+- (BOOL)removeEventWithId:(long long)storeId {
+    return [self removeEventsWithIds:@[@(storeId)]];
+}
+
+- (BOOL)removeEventsWithIds:(NSArray<NSNumber *> *)storeIds {
+    @synchronized (self) {
+        for (NSNumber *storeId in storeIds) {
+            [self markEventRemovedWithId:storeId.longLongValue];
+        }
+        [self acknowledgeRemovedEvents];
+        return YES;
+    }
+}
+
+- (BOOL)removeAllEvents {
+    @synchronized (self) {
+        for (SPEventSegment *segment in _segments) {
+            [segment remove];
+        }
+        [_segments removeAllObjects];
+        [_removedIds removeAllIndexes];
+        _acknowledgedId = _nextId;
+        _storedBytes = 0;
+        return [self saveCheckpoint];
+    }
+}
+
+- (NSUInteger)count {
+    @synchronized (self) {
+        return (NSUInteger)(_nextId - _acknowledgedId) - _removedIds.count;
+    }
+}
+
+- (NSArray<SPEmitterEvent *> *)emittableEventsWithQueryLimit:(NSUInteger)queryLimit {
+    @synchronized (self) {
+        NSMutableArray<SPEmitterEvent *> *result = [NSMutableArray new];
+        NSMutableIndexSet *corruptIds = [NSMutableIndexSet new];
+        for (SPEventSegment *segment in _segments) {
+            long long endId = segment.baseId + segment.recordCount;
+            for (long long storeId = MAX(segment.baseId, _acknowledgedId); storeId < endId && result.count < queryLimit; storeId++) {
+                if ([_removedIds containsIndex:(NSUInteger)storeId]) {
+                    continue;
+                }
+                NSData *data = [segment dataForRecordAtIndex:(NSUInteger)(storeId - segment.baseId)];
+                if (![SPPayload isJsonObjectData:data]) {
+                    // E.g. the payload of the record wasn't written before a power loss.
+                    [corruptIds addIndex:(NSUInteger)storeId];
+                    continue;
+                }
+                SPPayload *payload = [[SPPayload alloc] initWithJsonData:data];
+                [result addObject:[[SPEmitterEvent alloc] initWithPayload:payload storeId:storeId]];
+            }
+            if (result.count >= queryLimit) {
+                break;
+            }
+        }
+        if (corruptIds.count) {
+            SPLogError(@"Removed %@ corrupt events from the event store.", @(corruptIds.count));
+            [corruptIds enumerateIndexesUsingBlock:^(NSUInteger storeId, BOOL *stop) {
+                [self markEventRemovedWithId:(long long)storeId];
+            }];
+            [self acknowledgeRemovedEvents];
+        }
+        return result;
+    }
+}
+
+- (void)setCapacityWithMaxEventCount:(NSUInteger)maxEventCount maxByteSize:(NSUInteger)maxByteSize maxEventAge:(NSTimeInterval)maxEventAge {
+    @synchronized (self) {
+        _maxEventCount = maxEventCount;
+        _maxByteSize = maxByteSize;
+        _maxEventAge = maxEventAge;
+        [self evictEventsIfNeeded];
+    }
+}
+
+// MARK: - Private methods (called within @synchronized)
+
+- (void)markEventRemovedWithId:(long long)storeId {
+    if (storeId < _acknowledgedId || storeId >= _nextId || [_removedIds containsIndex:(NSUInteger)storeId]) {
+        return;
+    }
+    SPEventSegment *segment = [self segmentForId:storeId];
+    if (segment) {
+        NSUInteger length = [segment lengthOfRecordAtIndex:(NSUInteger)(storeId - segment.baseId)];
+        _storedBytes -= MIN(length, _storedBytes);
+    }
+    [_removedIds addIndex:(NSUInteger)storeId];
+}
+
+/// Moves the acknowledged id past the removed events, deletes the segments with all the events removed
+/// and saves the checkpoint.
+- (void)acknowledgeRemovedEvents {
+    long long acknowledgedId = _acknowledgedId;
+    while (acknowledgedId < _nextId && [_removedIds containsIndex:(NSUInteger)acknowledgedId]) {
+        acknowledgedId++;
+    }
+    if (acknowledgedId != _acknowledgedId) {
+        [_removedIds removeIndexesInRange:NSMakeRange(0, (NSUInteger)acknowledgedId)];
+        _acknowledgedId = acknowledgedId;
+        while (_segments.count && _segments.firstObject.baseId + (long long)_segments.firstObject.recordCount <= _acknowledgedId) {
+            [_segments.firstObject remove];
+            [_segments removeObjectAtIndex:0];
+        }
+    }
+    [self saveCheckpoint];
+}
+
+/// Removes the expired events and, when the store is over capacity, the events with lowest priority
+/// (oldest first) down to the low water mark.
+- (void)evictEventsIfNeeded {
+    NSUInteger expiredCount = 0;
+    if (_maxEventAge > 0) {
+        // Records are appended in insertion order, so the expired ones are at the beginning.
+        NSTimeInterval expiryTime = [NSDate date].timeIntervalSince1970 - _maxEventAge;
+        for (long long storeId = _acknowledgedId; storeId < _nextId; storeId++) {
+            if ([_removedIds containsIndex:(NSUInteger)storeId]) {
+                continue;
+            }
+            SPEventSegment *segment = [self segmentForId:storeId];
+            if (segment && [segment insertionTimeOfRecordAtIndex:(NSUInteger)(storeId - segment.baseId)] >= expiryTime) {
+                break;
+            }
+            [self markEventRemovedWithId:storeId];
+            expiredCount++;
+        }
+    }
+
+    BOOL isOverCount = _maxEventCount && self.count > _maxEventCount;
+    BOOL isOverBytes = _maxByteSize && _storedBytes > _maxByteSize;
+    if (!isOverCount && !isOverBytes) {
+        if (expiredCount) {
+            SPLogDebug(@"Removed %@ expired events from the event log.", @(expiredCount));
+            [self acknowledgeRemovedEvents];
+        }
+        return;
+    }
+    NSUInteger targetCount = _maxEventCount ? (NSUInteger)(_maxEventCount * kSPEvictionLowWaterMark) : NSUIntegerMax;
+    NSUInteger targetBytes = _maxByteSize ? (NSUInteger)(_maxByteSize * kSPEvictionLowWaterMark) : NSUIntegerMax;
+    NSUInteger candidateCount = 0;
+    SPEvictionCandidate *candidates = malloc(sizeof(SPEvictionCandidate) * MAX(self.count, 1));
+    for (SPEventSegment *segment in _segments) {
+        long long endId = segment.baseId + (long long)segment.recordCount;
+        for (long long storeId = MAX(segment.baseId, _acknowledgedId); storeId < endId; storeId++) {
+            if (![_removedIds containsIndex:(NSUInteger)storeId]) {
+                candidates[candidateCount++] = (SPEvictionCandidate){
+                    .priority = [segment priorityOfRecordAtIndex:(NSUInteger)(storeId - segment.baseId)],
+                    .storeId = storeId,
+                };
+            }
+        }
+    }
+    qsort(candidates, candidateCount, sizeof(SPEvictionCandidate), SPCompareEvictionCandidates);
+    NSUInteger evictedCount = 0;
+    while (evictedCount < candidateCount && (self.count > targetCount || _storedBytes > targetBytes)) {
+        [self markEventRemovedWithId:candidates[evictedCount].storeId];
+        evictedCount++;
+    }
+    free(candidates);
+    SPLogDebug(@"Evicted %@ expired events and %@ events over capacity from the event log.", @(expiredCount), @(evictedCount));
+    [self acknowledgeRemovedEvents];
+}
+
+- (SPEventSegment *)segmentForId:(long long)storeId {
+    NSUInteger low = 0;
+    NSUInteger high = _segments.count;
+    while (low < high) {
+        NSUInteger mid = (low + high) / 2;
+        SPEventSegment *segment = _segments[mid];
+        if (storeId < segment.baseId) {
+            high = mid;
+        } else if (storeId >= segment.baseId + (long long)segment.recordCount) {
+            low = mid + 1;
+        } else {
+            return segment;
+        }
+    }
+    return nil;
+}
+
+- (SPEventSegment *)createSegmentWithBaseId:(long long)baseId capacity:(NSUInteger)capacity {
+    NSString *filename = [NSString stringWithFormat:@"%020lld.%@", baseId, kSPSegmentExtension];
+    return [[SPEventSegment alloc] initWithPath:[self.directoryPath stringByAppendingPathComponent:filename] baseId:baseId capacity:capacity];
+}
+
+- (void)loadSegments {
+    NSArray<NSString *> *files = [[NSFileManager defaultManager] contentsOfDirectoryAtPath:self.directoryPath error:nil];
+    NSMutableArray<NSString *> *segmentFiles = [NSMutableArray new];
+    for (NSString *file in files) {
+        if ([file.pathExtension isEqualToString:kSPSegmentExtension]) {
+            [segmentFiles addObject:file];
+        }
+    }
+    // Zero padded base ids sort numerically.
+    [segmentFiles sortUsingSelector:@selector(compare:)];
+    _nextId = _acknowledgedId;
+    for (NSString *file in segmentFiles) {
+        long long baseId = [file stringByDeletingPathExtension].longLongValue;
+        NSString *path = [self.directoryPath stringByAppendingPathComponent:file];
+        SPEventSegment *segment = [[SPEventSegment alloc] initWithPath:path baseId:baseId capacity:0];
+        if (!segment) {
+            // Empty or unreadable segment, e.g. interrupted while being created.
+            [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+            continue;
+        }
+        long long endId = baseId + (long long)segment.recordCount;
+        if (endId <= _acknowledgedId) {
+            [segment remove];
+            continue;
+        }
+        for (long long storeId = MAX(baseId, _acknowledgedId); storeId < endId; storeId++) {
+            if (![_removedIds containsIndex:(NSUInteger)storeId]) {
+                _storedBytes += [segment lengthOfRecordAtIndex:(NSUInteger)(storeId - baseId)];
+            }
+        }
+        [_segments addObject:segment];
+        _nextId = MAX(_nextId, endId);
+    }
+    // The ids of the deleted segments are removed, otherwise they would be counted forever.
+    long long expectedId = _acknowledgedId;
+    for (SPEventSegment *segment in _segments) {
+        if (segment.baseId > expectedId) {
+            [_removedIds addIndexesInRange:NSMakeRange((NSUInteger)expectedId, (NSUInteger)(segment.baseId - expectedId))];
+        }
+        expectedId = MAX(expectedId, segment.baseId + (long long)segment.recordCount);
+    }
+    [self acknowledgeRemovedEvents];
+}
+
+/// The checkpoint contains the acknowledged id followed by the ranges of the events removed above it,
+/// all as 64 bit integers.
+- (void)loadCheckpoint {
+    NSData *data = [NSData dataWithContentsOfFile:[self.directoryPath stringByAppendingPathComponent:kSPCheckpointFilename]];
+    if (data.length < sizeof(int64_t)) {
+        return;
+    }
+    const int64_t *values = data.bytes;
+    NSUInteger valueCount = data.length / sizeof(int64_t);
+    _acknowledgedId = values[0];
+    for (NSUInteger i = 1; i + 1 < valueCount; i += 2) {
+        if (values[i] >= _acknowledgedId && values[i + 1] > 0) {
+            [_removedIds addIndexesInRange:NSMakeRange((NSUInteger)values[i], (NSUInteger)values[i + 1])];
+        }
+    }
+}
+
+- (BOOL)saveCheckpoint {
+    NSMutableData *data = [NSMutableData new];
+    int64_t acknowledgedId = _acknowledgedId;
+    [data appendBytes:&acknowledgedId length:sizeof(acknowledgedId)];
+    [_removedIds enumerateRangesUsingBlock:^(NSRange range, BOOL *stop) {
+        int64_t location = range.location;
+        int64_t length = range.length;
+        [data appendBytes:&location length:sizeof(location)];
+        [data appendBytes:&length length:sizeof(length)];
+    }];
+    return [data writeToFile:[self.directoryPath stringByAppendingPathComponent:kSPCheckpointFilename] atomically:YES];
+}
+
+@end
@@ -0,0 +1,50 @@
+//
+//  SPSharedEventStore.h
+//  Snowplow
+//
+//  Copyright (c) 2013-2022 Snowplow Analytics Ltd. All rights reserved.
+//
+//  This program is licensed to you under the Apache License Version 2.0,
+//  and you may not use this file except in compliance with the Apache License
+//  Version 2.0. You may obtain a copy of the Apache License Version 2.0 at
+//  http://www.apache.org/licenses/LICENSE-2.0.
+//
+//  Unless required by applicable law or agreed to in writing,
+//  software distributed under the Apache License Version 2.0 is distributed on
+//  an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+//  express or implied. See the Apache License Version 2.0 for the specific
+//  language governing permissions and limitations there under.
+//
+//  License: Apache License Version 2.0
+//
+
+#import <Foundation/Foundation.h>
+#import "SPEventStore.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * EventStore keeping the events of all the trackers in a single SQLite database.
+ * Each event is stored with the namespace of its tracker, so every instance only sees the events of its namespace,
+ * while all instances share one file, one database connection and one writer that commits the events
+ * added by all the trackers together.
+ * It suits apps running several trackers. Use it for all of them, instead of the default SPSQLiteEventStore,
+ * by setting it as `eventStore` of each tracker's EmitterConfiguration.
+ */
+NS_SWIFT_NAME(SharedEventStore)
+@interface SPSharedEventStore : NSObject <SPEventStore>
+
+/// The namespace of the tracker whose events are accessed by this instance.
+@property (nonatomic, readonly) NSString *namespace;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ * Creates a store accessing the events of a tracker in the shared database.
+ * @param namespace The namespace of the tracker.
+ */
+- (instancetype)initWithNamespace:(NSString *)namespace;
+
+@end
+
+NS_ASSUME_NONNULL_END
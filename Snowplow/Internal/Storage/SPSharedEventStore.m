@@ -0,0 +1,484 @@
+//
+//  SPSharedEventStore.m
+//  Snowplow
+//
+//  Copyright (c) 2013-2022 Snowplow Analytics Ltd. All rights reserved.
+//
+//  This program is licensed to you under the Apache License Version 2.0,
+//  and you may not use this file except in compliance with the Apache License
+//  Version 2.0. You may obtain a copy of the Apache License Version 2.0 at
+//  http://www.apache.org/licenses/LICENSE-2.0.
+//
+//  Unless required by applicable law or agreed to in writing,
+//  software distributed under the Apache License Version 2.0 is distributed on
+//  an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+//  express or implied. See the Apache License Version 2.0 for the specific
+//  language governing permissions and limitations there under.
+//
+//  License: Apache License Version 2.0
+//
+
+#import "SPSharedEventStore.h"
+#import "SPPayload.h"
+#import "SPLogger.h"
+
+#if SWIFT_PACKAGE
+    #import <FMDB.h>
+#else
+    #import <fmdb/FMDB.h>
+#endif
+
+/// Fraction of the capacity kept when the store evicts events, so that eviction runs in bulk rather than on every insert.
+static const double kSPEvictionLowWaterMark = 0.9;
+/// Minimum interval between two checks of the events exceeding the maximum age.
+static const NSTimeInterval kSPAgeEvictionInterval = 60;
+/// Time the writer waits for other events, from any tracker, to commit them together.
+static const NSTimeInterval kSPGroupCommitWindow = 0.01;
+
+static NSString * const _queryCreateTable = @"CREATE TABLE IF NOT EXISTS 'events' (id INTEGER PRIMARY KEY, namespace TEXT NOT NULL, eventData BLOB, priority INTEGER DEFAULT 0, byteSize INTEGER DEFAULT 0, dateCreated TIMESTAMP DEFAULT CURRENT_TIMESTAMP);"
+                                            @"CREATE INDEX IF NOT EXISTS events_namespace ON 'events' (namespace, id);"
+                                            @"CREATE INDEX IF NOT EXISTS events_namespace_priority ON 'events' (namespace, priority, id);";
+static NSString * const _queryInsertEvent = @"INSERT INTO 'events' (namespace, eventData, priority, byteSize) VALUES (?, ?, ?, ?)";
+static NSString * const _querySelectPage = @"SELECT id, eventData FROM 'events' WHERE namespace = ? ORDER BY id LIMIT ?";
+static NSString * const _querySelectAllTotals = @"SELECT namespace, Count(*), Total(byteSize) FROM 'events' GROUP BY namespace";
+static NSString * const _querySelectTotals = @"SELECT Count(*), Total(byteSize) FROM 'events' WHERE namespace = ?";
+static NSString * const _queryDeleteIds = @"DELETE FROM 'events' WHERE namespace = ? AND id IN (%@)";
+static NSString * const _querySelectBytesForIds = @"SELECT Total(byteSize) FROM 'events' WHERE namespace = ? AND id IN (%@)";
+static NSString * const _queryDeleteAll = @"DELETE FROM 'events' WHERE namespace = ?";
+static NSString * const _querySelectEvictable = @"SELECT byteSize FROM 'events' WHERE namespace = ? ORDER BY priority, id";
+static NSString * const _queryDeleteEvictable = @"DELETE FROM 'events' WHERE id IN (SELECT id FROM 'events' WHERE namespace = ? ORDER BY priority, id LIMIT ?)";
+static NSString * const _queryDeleteExpired = @"DELETE FROM 'events' WHERE namespace = ? AND dateCreated < datetime('now', ?)";
+
+// MARK: - SPSharedNamespaceState
+
+/// Running totals and capacity of the events of a namespace.
+@interface SPSharedNamespaceState : NSObject
+
+@property (nonatomic) NSUInteger storedCount;
+@property (nonatomic) NSUInteger storedBytes;
+@property (nonatomic) NSUInteger pendingCount;
+@property (nonatomic) NSUInteger maxEventCount;
+@property (nonatomic) NSUInteger maxByteSize;
+@property (nonatomic) NSTimeInterval maxEventAge;
+@property (nonatomic, nullable) NSDate *lastAgeEvictionDate;
+@property (nonatomic, readonly) BOOL isCapped;
+
+@end
+
+@implementation SPSharedNamespaceState
+
+- (BOOL)isCapped {
+    return self.maxEventCount || self.maxByteSize || self.maxEventAge > 0;
+}
+
+@end
+
+// MARK: - SPSharedEventDatabase
+
+/// The database shared by all the SPSharedEventStore instances, with a single connection and writer.
+@interface SPSharedEventDatabase : NSObject
+
++ (instancetype)sharedDatabase;
+
+- (void)addEventData:(NSArray<NSData *> *)dataArray priorities:(NSArray<NSNumber *> *)priorities namespace:(NSString *)namespace;
+- (NSUInteger)countForNamespace:(NSString *)namespace;
+- (NSArray<SPEmitterEvent *> *)eventsForNamespace:(NSString *)namespace limit:(NSUInteger)limit;
+- (BOOL)removeEventsWithIds:(NSArray<NSNumber *> *)storeIds namespace:(NSString *)namespace;
+- (BOOL)removeAllEventsForNamespace:(NSString *)namespace;
+- (void)setCapacityWithMaxEventCount:(NSUInteger)maxEventCount maxByteSize:(NSUInteger)maxByteSize maxEventAge:(NSTimeInterval)maxEventAge namespace:(NSString *)namespace;
+
+@end
+
+@implementation SPSharedEventDatabase {
+    NSString *_dbPath;
+    FMDatabaseQueue *_queue;
+    // Completed once the database is open.
+    dispatch_group_t _openGroup;
+    // The following are guarded by @synchronized (self).
+    NSMutableDictionary<NSString *, SPSharedNamespaceState *> *_namespaces;
+    NSMutableArray<NSArray *> *_pendingEvents; // [namespace, data, priority]
+    BOOL _isCommitScheduled;
+}
+
++ (instancetype)sharedDatabase {
+    static SPSharedEventDatabase *sharedDatabase;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sharedDatabase = [SPSharedEventDatabase new];
+    });
+    return sharedDatabase;
+}
+
+- (instancetype)init {
+    if (self = [super init]) {
+#if SNOWPLOW_TARGET_TV
+        NSString *libraryPath = [NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES) objectAtIndex:0];
+#else
+        NSString *libraryPath = [NSSearchPathForDirectoriesInDomains(NSLibraryDirectory, NSUserDomainMask, YES) objectAtIndex:0];
+#endif
+        // Stored apart from the per-namespace databases, which are cleared by `removeUnsentEventsExceptForNamespaces:`.
+        NSString *dirPath = [libraryPath stringByAppendingPathComponent:@"snowplow-shared"];
+        _dbPath = [dirPath stringByAppendingPathComponent:@"snowplowEvents.sqlite"];
+        _namespaces = [NSMutableDictionary new];
+        _pendingEvents = [NSMutableArray new];
+        _openGroup = dispatch_group_create();
+        dispatch_group_async(_openGroup, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_HIGH, 0), ^{
+            [[NSFileManager defaultManager] createDirectoryAtPath:dirPath withIntermediateDirectories:YES attributes:nil error:nil];
+            [self openDatabase];
+        });
+    }
+    return self;
+}
+
+- (void)openDatabase {
+    _queue = [FMDatabaseQueue databaseQueueWithPath:_dbPath];
+    [_queue inDatabase:^(FMDatabase *db) {
+        if (![db open]) {
+            SPLogError(@"Failed to open the shared event database: %@", db.lastErrorMessage);
+            return;
+        }
+        FMResultSet *s = [db executeQuery:@"PRAGMA journal_mode=WAL"];
+        [s next];
+        [s close];
+        [db executeStatements:@"PRAGMA synchronous=NORMAL"];
+        db.shouldCacheStatements = YES;
+        [db executeStatements:_queryCreateTable];
+        s = [db executeQuery:_querySelectAllTotals];
+        while ([s next]) {
+            SPSharedNamespaceState *state = [self stateForNamespace:[s stringForColumnIndex:0]];
+            @synchronized (self) {
+                state.storedCount = (NSUInteger)[s longLongIntForColumnIndex:1];
+                state.storedBytes = (NSUInteger)[s doubleForColumnIndex:2];
+            }
+        }
+        [s close];
+    }];
+}
+
+- (FMDatabaseQueue *)queue {
+    dispatch_group_wait(_openGroup, DISPATCH_TIME_FOREVER);
+    return _queue;
+}
+
+- (SPSharedNamespaceState *)stateForNamespace:(NSString *)namespace {
+    @synchronized (self) {
+        SPSharedNamespaceState *state = _namespaces[namespace];
+        if (!state) {
+            state = [SPSharedNamespaceState new];
+            _namespaces[namespace] = state;
+        }
+        return state;
+    }
+}
+
+// MARK: Events
+
+- (void)addEventData:(NSArray<NSData *> *)dataArray priorities:(NSArray<NSNumber *> *)priorities namespace:(NSString *)namespace {
+    SPSharedNamespaceState *state = [self stateForNamespace:namespace];
+    BOOL scheduleCommit = NO;
+    @synchronized (self) {
+        for (NSUInteger i = 0; i < dataArray.count; i++) {
+            [_pendingEvents addObject:@[namespace, dataArray[i], priorities[i]]];
+        }
+        state.pendingCount += dataArray.count;
+        scheduleCommit = !_isCommitScheduled;
+        _isCommitScheduled = YES;
+    }
+    if (scheduleCommit) {
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(kSPGroupCommitWindow * NSEC_PER_SEC)), dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+            [self.queue inDatabase:^(FMDatabase *db) {
+                [self commitPendingEventsInDatabase:db];
+            }];
+        });
+    }
+}
+
+- (NSUInteger)countForNamespace:(NSString *)namespace {
+    // The stored counts are known once the database is open.
+    dispatch_group_wait(_openGroup, DISPATCH_TIME_FOREVER);
+    SPSharedNamespaceState *state = [self stateForNamespace:namespace];
+    @synchronized (self) {
+        return state.storedCount + state.pendingCount;
+    }
+}
+
+- (NSArray<SPEmitterEvent *> *)eventsForNamespace:(NSString *)namespace limit:(NSUInteger)limit {
+    NSMutableArray<SPEmitterEvent *> *res = [NSMutableArray new];
+    [self.queue inDatabase:^(FMDatabase *db) {
+        if (![db open]) {
+            return;
+        }
+        [self commitPendingEventsInDatabase:db];
+        NSMutableArray<NSNumber *> *corruptIds = [NSMutableArray new];
+        NSUInteger corruptByteSize = 0;
+        FMResultSet *s = [db executeQuery:_querySelectPage, namespace, @(limit)];
+        while ([s next]) {
+            NSData *data = [s dataForColumnIndex:1];
+            if (![SPPayload isJsonObjectData:data]) {
+                [corruptIds addObject:@([s longLongIntForColumnIndex:0])];
+                corruptByteSize += data.length;
+                continue;
+            }
+            SPPayload *payload = [[SPPayload alloc] initWithJsonData:data];
+            [res addObject:[[SPEmitterEvent alloc] initWithPayload:payload storeId:[s longLongIntForColumnIndex:0]]];
+        }
+        [s close];
+        // The corrupt rows would be counted forever otherwise.
+        if (corruptIds.count && [db executeUpdate:[NSString stringWithFormat:_queryDeleteIds, [corruptIds componentsJoinedByString:@","]], namespace]) {
+            SPLogError(@"Removed %@ corrupt events from the event store.", @(db.changes));
+            [self didRemoveEventCount:db.changes byteSize:corruptByteSize state:[self stateForNamespace:namespace]];
+        }
+    }];
+    return res;
+}
+
+- (BOOL)removeEventsWithIds:(NSArray<NSNumber *> *)storeIds namespace:(NSString *)namespace {
+    if (!storeIds.count) {
+        return NO;
+    }
+    SPSharedNamespaceState *state = [self stateForNamespace:namespace];
+    NSString *ids = [storeIds componentsJoinedByString:@","];
+    __block BOOL res = NO;
+    [self.queue inDatabase:^(FMDatabase *db) {
+        if (![db open]) {
+            return;
+        }
+        [self commitPendingEventsInDatabase:db];
+        NSUInteger byteSize = 0;
+        FMResultSet *s = [db executeQuery:[NSString stringWithFormat:_querySelectBytesForIds, ids], namespace];
+        if ([s next]) {
+            byteSize = (NSUInteger)[s doubleForColumnIndex:0];
+        }
+        [s close];
+        res = [db executeUpdate:[NSString stringWithFormat:_queryDeleteIds, ids], namespace];
+        if (res) {
+            [self didRemoveEventCount:db.changes byteSize:byteSize state:state];
+        }
+    }];
+    return res;
+}
+
+- (BOOL)removeAllEventsForNamespace:(NSString *)namespace {
+    SPSharedNamespaceState *state = [self stateForNamespace:namespace];
+    __block BOOL res = NO;
+    [self.queue inDatabase:^(FMDatabase *db) {
+        if (![db open]) {
+            return;
+        }
+        [self commitPendingEventsInDatabase:db];
+        res = [db executeUpdate:_queryDeleteAll, namespace];
+        if (res) {
+            @synchronized (self) {
+                state.storedCount = 0;
+                state.storedBytes = 0;
+            }
+        }
+    }];
+    return res;
+}
+
+- (void)setCapacityWithMaxEventCount:(NSUInteger)maxEventCount maxByteSize:(NSUInteger)maxByteSize maxEventAge:(NSTimeInterval)maxEventAge namespace:(NSString *)namespace {
+    SPSharedNamespaceState *state = [self stateForNamespace:namespace];
+    @synchronized (self) {
+        state.maxEventCount = maxEventCount;
+        state.maxByteSize = maxByteSize;
+        state.maxEventAge = maxEventAge;
+        state.lastAgeEvictionDate = nil;
+    }
+    // Applied by the writer, without blocking the caller while the database opens.
+    dispatch_group_notify(_openGroup, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        [self.queue inDatabase:^(FMDatabase *db) {
+            if ([db open]) {
+                [self commitPendingEventsInDatabase:db];
+                [self evictEventsOfNamespace:namespace inDatabase:db];
+            }
+        }];
+    });
+}
+
+// MARK: Writer
+
+/// Writes the events added by all the trackers in a single transaction.
+/// Must be called on the database queue.
+- (void)commitPendingEventsInDatabase:(FMDatabase *)db {
+    NSArray<NSArray *> *pendingEvents;
+    @synchronized (self) {
+        _isCommitScheduled = NO;
+        if (!_pendingEvents.count) {
+            return;
+        }
+        pendingEvents = _pendingEvents;
+        _pendingEvents = [NSMutableArray new];
+    }
+    NSMutableDictionary<NSString *, NSNumber *> *insertedCounts = [NSMutableDictionary new];
+    NSMutableDictionary<NSString *, NSNumber *> *insertedBytes = [NSMutableDictionary new];
+    NSCountedSet<NSString *> *pendingCounts = [NSCountedSet new];
+    BOOL isTransaction = [db beginTransaction];
+    for (NSArray *event in pendingEvents) {
+        NSString *namespace = event[0];
+        NSData *data = event[1];
+        [pendingCounts addObject:namespace];
+        if ([db executeUpdate:_queryInsertEvent, namespace, data, event[2], @(data.length)]) {
+            insertedCounts[namespace] = @(insertedCounts[namespace].unsignedIntegerValue + 1);
+            insertedBytes[namespace] = @(insertedBytes[namespace].unsignedIntegerValue + data.length);
+        }
+    }
+    if (isTransaction && ![db commit]) {
+        SPLogError(@"Failed to write %@ events to the shared database: %@", @(pendingEvents.count), db.lastErrorMessage);
+        [db rollback];
+        [insertedCounts removeAllObjects];
+        [insertedBytes removeAllObjects];
+    }
+    NSMutableArray<NSString *> *cappedNamespaces = [NSMutableArray new];
+    @synchronized (self) {
+        for (NSString *namespace in pendingCounts) {
+            SPSharedNamespaceState *state = _namespaces[namespace];
+            state.pendingCount -= MIN([pendingCounts countForObject:namespace], state.pendingCount);
+            state.storedCount += insertedCounts[namespace].unsignedIntegerValue;
+            state.storedBytes += insertedBytes[namespace].unsignedIntegerValue;
+            if (state.isCapped) {
+                [cappedNamespaces addObject:namespace];
+            }
+        }
+    }
+    for (NSString *namespace in cappedNamespaces) {
+        [self evictEventsOfNamespace:namespace inDatabase:db];
+    }
+}
+
+/// Must be called on the database queue.
+- (void)didRemoveEventCount:(NSUInteger)count byteSize:(NSUInteger)byteSize state:(SPSharedNamespaceState *)state {
+    @synchronized (self) {
+        state.storedCount -= MIN(count, state.storedCount);
+        state.storedBytes -= MIN(byteSize, state.storedBytes);
+    }
+}
+
+/// Removes the expired events of the namespace and, when it's over capacity, the events with lowest priority
+/// (oldest first) down to the low water mark.
+/// Must be called on the database queue.
+- (void)evictEventsOfNamespace:(NSString *)namespace inDatabase:(FMDatabase *)db {
+    SPSharedNamespaceState *state = [self stateForNamespace:namespace];
+    NSUInteger maxEventCount, maxByteSize, storedCount, storedBytes;
+    NSTimeInterval maxEventAge;
+    BOOL checkAge;
+    @synchronized (self) {
+        maxEventCount = state.maxEventCount;
+        maxByteSize = state.maxByteSize;
+        maxEventAge = state.maxEventAge;
+        checkAge = maxEventAge > 0 && (!state.lastAgeEvictionDate || -[state.lastAgeEvictionDate timeIntervalSinceNow] >= kSPAgeEvictionInterval);
+        if (checkAge) {
+            state.lastAgeEvictionDate = [NSDate date];
+        }
+    }
+    if (checkAge) {
+        NSString *modifier = [NSString stringWithFormat:@"-%@ seconds", @((long long)maxEventAge)];
+        if ([db executeUpdate:_queryDeleteExpired, namespace, modifier] && db.changes) {
+            [self reloadTotalsOfNamespace:namespace inDatabase:db];
+        }
+    }
+    @synchronized (self) {
+        storedCount = state.storedCount;
+        storedBytes = state.storedBytes;
+    }
+    BOOL isOverCount = maxEventCount && storedCount > maxEventCount;
+    BOOL isOverBytes = maxByteSize && storedBytes > maxByteSize;
+    if (!isOverCount && !isOverBytes) {
+        return;
+    }
+    NSUInteger targetCount = maxEventCount ? (NSUInteger)(maxEventCount * kSPEvictionLowWaterMark) : NSUIntegerMax;
+    NSUInteger targetBytes = maxByteSize ? (NSUInteger)(maxByteSize * kSPEvictionLowWaterMark) : NSUIntegerMax;
+    NSUInteger evictCount = 0;
+    NSUInteger evictBytes = 0;
+    FMResultSet *s = [db executeQuery:_querySelectEvictable, namespace];
+    while ((evictCount < storedCount && storedCount - evictCount > targetCount)
+           || (evictBytes < storedBytes && storedBytes - evictBytes > targetBytes)) {
+        if (![s next]) {
+            break;
+        }
+        evictBytes += (NSUInteger)[s longLongIntForColumnIndex:0];
+        evictCount++;
+    }
+    [s close];
+    if (evictCount && [db executeUpdate:_queryDeleteEvictable, namespace, @(evictCount)]) {
+        SPLogDebug(@"Evicted %@ events of %@ from the shared database over capacity.", @(evictCount), namespace);
+        [self didRemoveEventCount:evictCount byteSize:evictBytes state:state];
+    }
+}
+
+/// Must be called on the database queue.
+- (void)reloadTotalsOfNamespace:(NSString *)namespace inDatabase:(FMDatabase *)db {
+    FMResultSet *s = [db executeQuery:_querySelectTotals, namespace];
+    if ([s next]) {
+        SPSharedNamespaceState *state = [self stateForNamespace:namespace];
+        @synchronized (self) {
+            state.storedCount = (NSUInteger)[s longLongIntForColumnIndex:0];
+            state.storedBytes = (NSUInteger)[s doubleForColumnIndex:1];
+        }
+    }
+    [s close];
+}
+
+@end
+
+// MARK: - SPSharedEventStore
+
+@implementation SPSharedEventStore {
+    SPSharedEventDatabase *_database;
+}
+
+- (instancetype)initWithNamespace:(NSString *)namespace {
+    if (self = [super init]) {
+        _namespace = [namespace copy];
+        _database = [SPSharedEventDatabase sharedDatabase];
+    }
+    return self;
+}
+
+- (void)addEvent:(SPPayload *)payload {
+    [self addEvents:@[payload]];
+}
+
+- (void)addEvents:(NSArray<SPPayload *> *)payloads {
+    NSMutableArray<NSData *> *dataArray = [NSMutableArray arrayWithCapacity:payloads.count];
+    NSMutableArray<NSNumber *> *priorities = [NSMutableArray arrayWithCapacity:payloads.count];
+    for (SPPayload *payload in payloads) {
+        NSData *data = [payload jsonData];
+        // It's checked before it's written so that the rows can be sent as they are.
+        if ([SPPayload isJsonObjectData:data]) {
+            [dataArray addObject:data];
+            [priorities addObject:@(payload.priority)];
+        } else {
+            SPLogError(@"Event not stored: the payload isn't a valid JSON object.");
+        }
+    }
+    if (dataArray.count) {
+        [_database addEventData:dataArray priorities:priorities namespace:_namespace];
+    }
+}
+
+- (BOOL)removeEventWithId:(long long)storeId {
+    return [_database removeEventsWithIds:@[@(storeId)] namespace:_namespace];
+}
+
+- (BOOL)removeEventsWithIds:(NSArray<NSNumber *> *)storeIds {
+    return [_database removeEventsWithIds:storeIds namespace:_namespace];
+}
+
+- (BOOL)removeAllEvents {
+    return [_database removeAllEventsForNamespace:_namespace];
+}
+
+- (NSUInteger)count {
+    return [_database countForNamespace:_namespace];
+}
+
+- (NSArray<SPEmitterEvent *> *)emittableEventsWithQueryLimit:(NSUInteger)queryLimit {
+    return [_database eventsForNamespace:_namespace limit:queryLimit];
+}
+
+- (void)setCapacityWithMaxEventCount:(NSUInteger)maxEventCount maxByteSize:(NSUInteger)maxByteSize maxEventAge:(NSTimeInterval)maxEventAge {
+    [_database setCapacityWithMaxEventCount:maxEventCount maxByteSize:maxByteSize maxEventAge:maxEventAge namespace:_namespace];
+}
+
+@end
@@ -65,6 +65,12 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (nonnull SPPayload *) fetchPlatformDictWithUserAnonymisation:(BOOL)userAnonymisation;
 
+/**
+ * Updates the device context information and returns a number that changes every time the information is refreshed.
+ * It lets the caller reuse what it derived from the dictionary as long as the version doesn't change.
+ */
+- (NSUInteger) fetchPlatformDictVersion;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -32,6 +32,7 @@
 @property (nonatomic, readonly) NSTimeInterval networkDictUpdateFrequency;
 @property (nonatomic) NSTimeInterval lastUpdatedEphemeralMobileDict;
 @property (nonatomic) NSTimeInterval lastUpdatedEphemeralNetworkDict;
+@property (nonatomic) NSUInteger version;
 
 @end
 
@@ -59,17 +60,7 @@
 }
 
 - (SPPayload *) fetchPlatformDictWithUserAnonymisation:(BOOL)userAnonymisation {
-#if SNOWPLOW_TARGET_IOS
-    @synchronized (self) {
-        NSTimeInterval now = [[NSDate date] timeIntervalSince1970];
-        if (now - self.lastUpdatedEphemeralMobileDict >= self.mobileDictUpdateFrequency) {
-            [self setEphemeralMobileDict];
-        }
-        if (now - self.lastUpdatedEphemeralNetworkDict >= self.networkDictUpdateFrequency) {
-            [self setEphemeralNetworkDict];
-        }
-    }
-#endif
+    [self updateEphemeralDictsIfNeeded];
     if (userAnonymisation) { // mask user identifiers
         SPPayload *copy = [[SPPayload alloc] initWithNSDictionary:[self.platformDict getAsDictionary]];
         [copy addValueToPayload:nil forKey:kSPMobileAppleIdfa];
@@ -80,8 +71,37 @@
     }
 }
 
+- (NSUInteger) fetchPlatformDictVersion {
+    [self updateEphemeralDictsIfNeeded];
+    @synchronized (self) {
+        return self.version;
+    }
+}
+
 // MARK: - Private methods
 
+- (void) updateEphemeralDictsIfNeeded {
+#if SNOWPLOW_TARGET_IOS
+    @synchronized (self) {
+        NSTimeInterval now = [[NSDate date] timeIntervalSince1970];
+        BOOL updateMobileDict = now - self.lastUpdatedEphemeralMobileDict >= self.mobileDictUpdateFrequency;
+        BOOL updateNetworkDict = now - self.lastUpdatedEphemeralNetworkDict >= self.networkDictUpdateFrequency;
+        if (!updateMobileDict && !updateNetworkDict) {
+            return;
+        }
+        if (updateMobileDict) {
+            [self setEphemeralMobileDict];
+        }
+        if (updateNetworkDict) {
+            [self setEphemeralNetworkDict];
+        }
+        // Memory and storage change on almost every refresh, so the version changes
+        // only once per refresh interval rather than after comparing the values.
+        self.version++;
+    }
+#endif
+}
+
 - (void) setPlatformDict {
     self.platformDict = [[SPPayload alloc] init];
     [self.platformDict addValueToPayload:[self.deviceInfoMonitor osType]       forKey:kSPPlatformOsType];
@@ -45,6 +45,12 @@ NS_SWIFT_NAME(Subject)
 @property (nonatomic) SPSize *screenViewPort;
 @property (nonatomic) NSInteger colorDepth;
 
+/*!
+ @brief A number that changes every time the platform or geolocation context may have changed.
+ @warning Internal property - do not use in production
+ */
+@property (nonatomic, readonly) NSUInteger contextVersion;
+
 
 /*!
  @brief Initializes a newly allocated SPSubject object.
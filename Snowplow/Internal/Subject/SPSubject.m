@@ -31,6 +31,8 @@
     SPPayload *           _standardDict;
     SPPlatformContext *   _platformContextManager;
     NSMutableDictionary * _geoLocationDict;
+    NSUInteger            _contextVersion;
+    NSUInteger            _platformDictVersion;
 }
 
 #pragma clang diagnostic push
@@ -138,6 +140,35 @@
     }
 }
 
+- (void) setPlatformContext:(BOOL)platformContext {
+    _platformContext = platformContext;
+    [self contextDidChange];
+}
+
+- (void) setGeoLocationContext:(BOOL)geoLocationContext {
+    _geoLocationContext = geoLocationContext;
+    [self contextDidChange];
+}
+
+- (NSUInteger) contextVersion {
+    @synchronized (self) {
+        if (self.platformContext) {
+            NSUInteger platformDictVersion = [_platformContextManager fetchPlatformDictVersion];
+            if (platformDictVersion != _platformDictVersion) {
+                _platformDictVersion = platformDictVersion;
+                _contextVersion++;
+            }
+        }
+        return _contextVersion;
+    }
+}
+
+- (void) contextDidChange {
+    @synchronized (self) {
+        _contextVersion++;
+    }
+}
+
 // MARK: - Standard Dictionary
 
 - (void) setStandardDict {
@@ -207,10 +238,12 @@
 
 - (void) setGeoDict {
     _geoLocationDict = [[NSMutableDictionary alloc] init];
+    [self contextDidChange];
 }
 
 - (void) setGeoLatitude:(float)latitude {
     [_geoLocationDict setObject:[NSNumber numberWithFloat:latitude] forKey:kSPGeoLatitude];
+    [self contextDidChange];
 }
 
 - (NSNumber *)geoLatitude {
@@ -219,6 +252,7 @@
 
 - (void) setGeoLongitude:(float)longitude {
     [_geoLocationDict setObject:[NSNumber numberWithFloat:longitude] forKey:kSPGeoLongitude];
+    [self contextDidChange];
 }
 
 - (NSNumber *)geoLongitude {
@@ -227,6 +261,7 @@
 
 - (void) setGeoLatitudeLongitudeAccuracy:(float)latitudeLongitudeAccuracy {
     [_geoLocationDict setObject:[NSNumber numberWithFloat:latitudeLongitudeAccuracy] forKey:kSPGeoLatLongAccuracy];
+    [self contextDidChange];
 }
 
 - (NSNumber *)geoLatitudeLongitudeAccuracy {
@@ -235,6 +270,7 @@
 
 - (void) setGeoAltitude:(float)altitude {
     [_geoLocationDict setObject:[NSNumber numberWithFloat:altitude] forKey:kSPGeoAltitude];
+    [self contextDidChange];
 }
 
 - (NSNumber *)geoAltitude {
@@ -243,6 +279,7 @@
 
 - (void) setGeoAltitudeAccuracy:(float)altitudeAccuracy {
     [_geoLocationDict setObject:[NSNumber numberWithFloat:altitudeAccuracy] forKey:kSPGeoAltitudeAccuracy];
+    [self contextDidChange];
 }
 
 - (NSNumber *)geoAltitudeAccuracy {
@@ -251,6 +288,7 @@
 
 - (void) setGeoBearing:(float)bearing {
     [_geoLocationDict setObject:[NSNumber numberWithFloat:bearing] forKey:kSPGeoBearing];
+    [self contextDidChange];
 }
 
 - (NSNumber *)geoBearing {
@@ -259,6 +297,7 @@
 
 - (void) setGeoSpeed:(float)speed {
     [_geoLocationDict setObject:[NSNumber numberWithFloat:speed] forKey:kSPGeoSpeed];
+    [self contextDidChange];
 }
 
 - (NSNumber *)geoSpeed {
@@ -267,6 +306,7 @@
 
 - (void) setGeoTimestamp:(NSNumber *)timestamp {
     [_geoLocationDict setObject:timestamp forKey:kSPGeoTimestamp];
+    [self contextDidChange];
 }
 
 - (NSNumber *)geoTimestamp {
@@ -0,0 +1,60 @@
+//
+//  SPContextFragmentCache.h
+//  Snowplow
+//
+//  Copyright (c) 2013-2022 Snowplow Analytics Ltd. All rights reserved.
+//
+//  This program is licensed to you under the Apache License Version 2.0,
+//  and you may not use this file except in compliance with the Apache License
+//  Version 2.0. You may obtain a copy of the Apache License Version 2.0 at
+//  http://www.apache.org/licenses/LICENSE-2.0.
+//
+//  Unless required by applicable law or agreed to in writing,
+//  software distributed under the Apache License Version 2.0 is distributed on
+//  an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+//  express or implied. See the Apache License Version 2.0 for the specific
+//  language governing permissions and limitations there under.
+//
+//  License: Apache License Version 2.0
+//
+
+#import <Foundation/Foundation.h>
+
+@class SPSelfDescribingJson;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ ContextFragmentCache keeps the serialized JSON of the entities that rarely change (e.g. platform,
+ application and GDPR contexts), so that they are built and serialized once rather than for every event.
+ Each fragment is stored with the version it has been built for: it is built again only when it's requested
+ with a different version.
+ */
+@interface SPContextFragmentCache : NSObject
+
+/**
+ Returns the serialized entity for the key, building it only if it has not been built for that version.
+ @param key The identifier of the entity.
+ @param version The version of the information the entity is built from.
+ @param builder The block building the entity, it can return nil if the entity isn't available.
+ @return The JSON of the entity or nil if the builder returned nil.
+ */
+- (nullable NSData *)fragmentWithKey:(NSString *)key version:(NSUInteger)version builder:(SPSelfDescribingJson * _Nullable (^)(void))builder;
+
+/**
+ Removes the fragments, so that they are built again on the next request.
+ Fragments whose build started before the removal are not stored.
+ */
+- (void)removeAllFragments;
+
+/**
+ Serializes the contexts entity listing the entries in order.
+ @param entries The entries, either serialized entities as returned by `fragmentWithKey:version:builder:`
+ or SPSelfDescribingJson entities to serialize.
+ @return The JSON of the contexts entity.
+ */
++ (NSData *)contextsJsonWithEntries:(NSArray *)entries;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,117 @@
+//
+//  SPContextFragmentCache.m
+//  Snowplow
+//
+//  Copyright (c) 2013-2022 Snowplow Analytics Ltd. All rights reserved.
+//
+//  This program is licensed to you under the Apache License Version 2.0,
+//  and you may not use this file except in compliance with the Apache License
+//  Version 2.0. You may obtain a copy of the Apache License Version 2.0 at
+//  http://www.apache.org/licenses/LICENSE-2.0.
+//
+//  Unless required by applicable law or agreed to in writing,
+//  software distributed under the Apache License Version 2.0 is distributed on
+//  an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+//  express or implied. See the Apache License Version 2.0 for the specific
+//  language governing permissions and limitations there under.
+//
+//  License: Apache License Version 2.0
+//
+
+#import "SPContextFragmentCache.h"
+#import "SPSelfDescribingJson.h"
+#import "SPJSONSerialization.h"
+#import "SPTrackerConstants.h"
+
+@interface SPContextFragment : NSObject
+
+@property (nonatomic, readonly) NSUInteger version;
+@property (nonatomic, readonly) NSData *data;
+
+- (instancetype)initWithVersion:(NSUInteger)version data:(NSData *)data;
+
+@end
+
+@implementation SPContextFragment
+
+- (instancetype)initWithVersion:(NSUInteger)version data:(NSData *)data {
+    if (self = [super init]) {
+        _version = version;
+        _data = data;
+    }
+    return self;
+}
+
+@end
+
+@implementation SPContextFragmentCache {
+    NSMutableDictionary<NSString *, SPContextFragment *> *_fragments;
+    /// Incremented when the fragments are removed, so that fragments built meanwhile aren't stored.
+    NSUInteger _generation;
+}
+
+- (instancetype)init {
+    if (self = [super init]) {
+        _fragments = [NSMutableDictionary new];
+    }
+    return self;
+}
+
+- (NSData *)fragmentWithKey:(NSString *)key version:(NSUInteger)version builder:(SPSelfDescribingJson * (^)(void))builder {
+    NSUInteger generation;
+    @synchronized (self) {
+        SPContextFragment *fragment = _fragments[key];
+        if (fragment && fragment.version == version) {
+            return fragment.data;
+        }
+        generation = _generation;
+    }
+    // Built outside the lock as the builder may take time.
+    SPSelfDescribingJson *entity = builder();
+    NSData *data = entity ? [SPJSONSerialization serializeDictionary:[entity getAsDictionary]] : nil;
+    @synchronized (self) {
+        // A fragment built before the cache was invalidated may be stale: it's not stored.
+        if (generation == _generation) {
+            _fragments[key] = [[SPContextFragment alloc] initWithVersion:version data:data];
+        }
+    }
+    return data;
+}
+
+- (void)removeAllFragments {
+    @synchronized (self) {
+        [_fragments removeAllObjects];
+        _generation++;
+    }
+}
+
++ (NSData *)contextsJsonWithEntries:(NSArray *)entries {
+    static NSData *prefix;
+    static NSData *separator;
+    static NSData *suffix;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        prefix = [[NSString stringWithFormat:@"{\"%@\":\"%@\",\"%@\":[", kSPSchema, kSPContextSchema, kSPData] dataUsingEncoding:NSUTF8StringEncoding];
+        separator = [@"," dataUsingEncoding:NSUTF8StringEncoding];
+        suffix = [@"]}" dataUsingEncoding:NSUTF8StringEncoding];
+    });
+    NSMutableData *json = [NSMutableData dataWithData:prefix];
+    BOOL isFirst = YES;
+    for (id entry in entries) {
+        NSData *data = [entry isKindOfClass:NSData.class]
+            ? (NSData *)entry
+            : [SPJSONSerialization serializeDictionary:[(SPSelfDescribingJson *)entry getAsDictionary]];
+        if (!data) {
+            continue;
+        }
+        if (!isFirst) {
+            [json appendData:separator];
+        }
+        [json appendData:data];
+        isFirst = NO;
+    }
+    [json appendData:suffix];
+    return json;
+}
+
+@end
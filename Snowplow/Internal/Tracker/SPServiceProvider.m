@@ -27,6 +27,7 @@
 #import "SPSubject.h"
 #import "SPTracker.h"
 #import "SPSession.h"
+#import "SPLogger.h"
 
 #import "SPTrackerControllerImpl.h"
 #import "SPEmitterControllerImpl.h"
@@ -46,6 +47,7 @@
 @interface SPServiceProvider ()
 
 @property (nonatomic, nonnull, readwrite) NSString *namespace;
+@property (nonatomic, readwrite) NSTimeInterval initializationDuration;
 
 // Internal services
 @property (nonatomic, nullable) SPTracker *tracker;
@@ -90,6 +92,7 @@
 
 - (instancetype)initWithNamespace:(NSString *)namespace network:(SPNetworkConfiguration *)networkConfiguration configurations:(NSArray<SPConfiguration *> *)configurations {
     if (self = [super init]) {
+        NSDate *startDate = [NSDate date];
         [self initializeConfigurationUpdates];
         self.namespace = namespace;
         self.networkConfigurationUpdate.sourceConfig = networkConfiguration;
@@ -98,16 +101,19 @@
             self.trackerConfigurationUpdate.sourceConfig = [SPTrackerConfiguration new];
         }
         [self tracker]; // Build tracker to initialize NotificationCenter receivers
+        [self didInitializeSinceDate:startDate];
     }
     return self;
 }
 
 - (void)resetWithConfigurations:(NSArray<SPConfiguration *> *)configurations {
+    NSDate *startDate = [NSDate date];
     [self stopServices];
     [self resetConfigurationUpdates];
     [self processConfigurations:configurations];
     [self resetServices];
     [self tracker];
+    [self didInitializeSinceDate:startDate];
 }
 
 - (void)shutdown {
@@ -153,6 +159,11 @@
     }
 }
 
+- (void)didInitializeSinceDate:(NSDate *)startDate {
+    self.initializationDuration = -[startDate timeIntervalSinceNow];
+    SPLogDebug(@"Tracker %@ initialized in %.1f ms", self.namespace, self.initializationDuration * 1000);
+}
+
 - (void)stopServices {
     [_emitter pauseTimer];
 }
@@ -292,6 +303,20 @@
             [builder setCallback:emitterConfig.requestCallback];
             [builder setCustomRetryForStatusCodes:emitterConfig.customRetryForStatusCodes];
             [builder setServerAnonymisation:emitterConfig.serverAnonymisation];
+            [builder setRequestCompression:emitterConfig.requestCompression];
+            [builder setCompressionThreshold:emitterConfig.compressionThreshold];
+            [builder setBatchingDelay:emitterConfig.batchingDelay];
+            [builder setBatchingEventCount:emitterConfig.batchingEventCount];
+            [builder setBatchingByteSize:emitterConfig.batchingByteSize];
+            [builder setImmediateFlushEvents:emitterConfig.immediateFlushEvents];
+            [builder setMaxStoredEvents:emitterConfig.maxStoredEvents];
+            [builder setMaxStoredBytes:emitterConfig.maxStoredBytes];
+            [builder setMaxEventAge:emitterConfig.maxEventAge];
+            [builder setEvictionPolicy:emitterConfig.evictionPolicy];
+            [builder setEventPriorities:emitterConfig.eventPriorities];
+            [builder setEvictableEvents:emitterConfig.evictableEvents];
+            [builder setMaxSendAttempts:emitterConfig.maxSendAttempts];
+            [builder setBisectFailedBatches:emitterConfig.bisectFailedBatches];
         }
     }];
     if (emitterConfig && emitterConfig.isPaused) {
@@ -326,6 +351,9 @@
         [builder setExceptionEvents:trackerConfig.exceptionAutotracking];
         [builder setTrackerDiagnostic:trackerConfig.diagnosticAutotracking];
         [builder setUserAnonymisation:trackerConfig.userAnonymisation];
+        [builder setAsynchronousTracking:trackerConfig.asynchronousTracking];
+        [builder setTrackingQueueCapacity:trackerConfig.trackingQueueCapacity];
+        [builder setTrackingQueueOverflowPolicy:trackerConfig.trackingQueueOverflowPolicy];
         if (sessionConfig) {
             [builder setBackgroundTimeout:sessionConfig.backgroundTimeoutInSeconds];
             [builder setForegroundTimeout:sessionConfig.foregroundTimeoutInSeconds];
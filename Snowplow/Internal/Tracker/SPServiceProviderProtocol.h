@@ -45,6 +45,9 @@ NS_ASSUME_NONNULL_BEGIN
 
 @property (nonatomic, nonnull, readonly) NSString *namespace;
 
+/// Time in seconds spent on the calling thread to create the tracker and its services.
+@property (nonatomic, readonly) NSTimeInterval initializationDuration;
+
 - (BOOL)isTrackerInitialized;
 
 - (SPTracker *)tracker;
@@ -24,12 +24,18 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+/// Maximum number of StateFutures with a pending computation in a chain.
+extern const NSUInteger kSPStateFutureMaxChainLength;
+
 /**
  StateFuture represents the placeholder of a future computation.
  The proper state value is computed when it's observed. Until that moment the StateFuture keeps the elements
  (event, previous StateFuture, StateMachine) needed to calculate the real state value.
  For this reason, the StateFuture can be the head of StateFuture chain which will collapse once the StateFuture
  head is asked to get the real state value.
+ The event is copied, so that changes made to it after tracking don't affect the transition. Events that can't be
+ copied are transitioned immediately. The chain is collapsed when it reaches `kSPStateFutureMaxChainLength` links,
+ so that the pending events don't keep growing when the state is never observed.
  */
 @interface SPStateFuture : NSObject
 
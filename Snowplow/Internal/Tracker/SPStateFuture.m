@@ -21,6 +21,7 @@
 
 #import "SPStateFuture.h"
 
+const NSUInteger kSPStateFutureMaxChainLength = 32;
 
 @interface SPStateFuture ()
 
@@ -29,6 +30,8 @@
 @property (nonatomic) id<SPStateMachineProtocol> stateMachine;
 
 @property (nonatomic) id<SPState> computedState;
+/// Number of StateFutures in the chain still to compute, including this one.
+@property (nonatomic) NSUInteger pendingChainLength;
 
 @end
 
@@ -36,13 +39,28 @@
 
 - (instancetype)initWithEvent:(SPEvent *)event previousState:(SPStateFuture *)previousState stateMachine:(id<SPStateMachineProtocol>)stateMachine {
     if (self = [super init]) {
-        self.event = event;
         self.previousState = previousState;
         self.stateMachine = stateMachine;
+        self.pendingChainLength = previousState.pendingChainLength + 1;
+        if ([event conformsToProtocol:@protocol(NSCopying)]) {
+            self.event = [(id<NSCopying>)event copyWithZone:nil];
+            if (self.pendingChainLength >= kSPStateFutureMaxChainLength) {
+                [self state];
+            }
+        } else {
+            self.event = event;
+            [self state];
+        }
     }
     return self;
 }
 
+- (NSUInteger)pendingChainLength {
+    @synchronized (self) {
+        return _pendingChainLength;
+    }
+}
+
 - (id<SPState>)state {
     @synchronized (self) {
         if (!self.computedState && self.stateMachine) {
@@ -50,6 +68,7 @@
             self.event = nil;
             self.previousState = nil;
             self.stateMachine = nil;
+            _pendingChainLength = 0;
         }
         return self.computedState;
     }
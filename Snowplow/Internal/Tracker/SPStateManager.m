@@ -100,18 +100,6 @@
                 SPStateFuture *previousStateFuture = [self.trackerState stateFutureWithIdentifier:stateIdentifier];
                 SPStateFuture *currentStateFuture = [[SPStateFuture alloc] initWithEvent:sdEvent previousState:previousStateFuture stateMachine:stateMachine];
                 [self.trackerState setStateFuture:currentStateFuture identifier:stateIdentifier];
-                // TODO: Remove early state computation.
-                /*
-                The early state-computation causes low performance as it's executed synchronously on
-                the track method thread. Ideally, the state computation should be executed only on
-                entities generation or payload updating (outputs). In that case there are two problems
-                to address:
-                 - long chains of StateFuture filling the memory (in case the outputs are not generated)
-                 - event object reuse by the user (the event object in the StateFuture could be modified
-                   externally)
-                 Remove the early state-computation only when these two problems are fixed.
-                 */
-                [currentStateFuture state]; // Early state-computation
             }
         }
         return self.trackerState.snapshot;
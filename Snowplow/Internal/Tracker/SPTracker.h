@@ -218,6 +218,26 @@ NS_SWIFT_NAME(TrackerBuilder)
  */
 - (void) setUserAnonymisation:(BOOL)userAnonymisation;
 
+/*!
+ @brief Tracker builder method to set whether the tracked events are processed in background.
+ When it's disabled, it blocks the calling thread until the events already queued are processed.
+ @param asynchronousTracking Whether `track` returns before the event is processed.
+ */
+- (void) setAsynchronousTracking:(BOOL)asynchronousTracking;
+
+/*!
+ @brief Tracker builder method to set the maximum number of events waiting to be processed in background.
+ @param trackingQueueCapacity Number of events.
+ */
+- (void) setTrackingQueueCapacity:(NSInteger)trackingQueueCapacity;
+
+/*!
+ @brief Tracker builder method to set what `track` does when the queue of the events waiting to be processed is full.
+ @note `SPTrackingQueueOverflowPolicyBlock` may stall the main thread when it tracks events faster than they are processed.
+ @param trackingQueueOverflowPolicy The overflow policy.
+ */
+- (void) setTrackingQueueOverflowPolicy:(SPTrackingQueueOverflowPolicy)trackingQueueOverflowPolicy;
+
 @end
 
 
@@ -248,6 +268,12 @@ NS_SWIFT_NAME(TrackerBuilder)
 @property (readonly, nonatomic, strong) SPScreenState * currentScreenState;
 /*! @brief List of tags associated to global contexts. */
 @property (readonly, nonatomic) NSArray<NSString *> *globalContextTags;
+/*! @brief Whether the tracked events are processed in background. */
+@property (readonly, nonatomic) BOOL asynchronousTracking;
+/*! @brief Maximum number of events waiting to be processed in background. */
+@property (readonly, nonatomic) NSInteger trackingQueueCapacity;
+/*! @brief What `track` does when the queue of the events waiting to be processed is full. */
+@property (readonly, nonatomic) SPTrackingQueueOverflowPolicy trackingQueueOverflowPolicy;
 /*! @brief Dictionary of global contexts generators. */
 @property (nonatomic) NSMutableDictionary<NSString *, SPGlobalContext *> *globalContextGenerators;
 
@@ -338,15 +364,29 @@ NS_SWIFT_NAME(TrackerBuilder)
 /// Return GDPR context
 - (nullable SPGdprContext *)gdprContext;
 
+/*!
+ @brief Blocks until the events tracked so far have been processed and added to the emitter.
+ It returns straight away if `asynchronousTracking` is disabled.
+ */
+- (void)waitForTrackedEvents;
+
 #pragma mark - Events tracking methods
 
 /*!
  @brief Tracks an event despite its specific type.
  @param event The event to track
- @return The event ID or nil in case tracking is paused
+ @return The event ID or nil in case tracking is paused or the event is dropped as the tracking queue is full
  */
 - (nullable NSUUID *)track:(SPEvent *)event;
 
+/*!
+ @brief Tracks several events at once, sharing the work of decorating and storing them.
+ @param events The events to track, in order.
+ @return The IDs of the tracked events in the same order. It is empty in case tracking is paused and
+ it only contains the first events of the batch in case the others are dropped as the tracking queue is full.
+ */
+- (NSArray<NSUUID *> *)trackEvents:(NSArray<SPEvent *> *)events;
+
 @end
 
 NS_ASSUME_NONNULL_END
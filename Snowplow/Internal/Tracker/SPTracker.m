@@ -29,6 +29,7 @@
 #import "SPSession.h"
 #import "SPInstallTracker.h"
 #import "SPGlobalContext.h"
+#import "SPContextFragmentCache.h"
 
 #import "SNOWError.h"
 #import "SPStructured.h"
@@ -101,6 +102,15 @@ void uncaughtExceptionHandler(NSException *exception) {
     });
 }
 
+/// Key set on the tracking queue to recognise when the code runs on it.
+static void *kSPTrackingQueueKey = &kSPTrackingQueueKey;
+
+/// Keys of the serialized contexts kept by the context fragment cache.
+static NSString * const kSPPlatformContextFragment = @"platform";
+static NSString * const kSPGeoLocationContextFragment = @"geolocation";
+static NSString * const kSPApplicationContextFragment = @"application";
+static NSString * const kSPGdprContextFragment = @"gdpr";
+
 #pragma mark - SPTracker implementation
 
 @implementation SPTracker {
@@ -122,6 +132,9 @@ void uncaughtExceptionHandler(NSException *exception) {
     BOOL                   _trackerDiagnostic;
     BOOL                   _userAnonymisation;
     NSString *             _trackerVersionSuffix;
+    dispatch_queue_t       _trackingQueue;
+    dispatch_semaphore_t   _trackingQueueSlots;
+    SPContextFragmentCache * _contextFragments;
 }
 
 // MARK: - Added property methods
@@ -197,6 +210,13 @@ void uncaughtExceptionHandler(NSException *exception) {
         _installEvent = NO;
         _trackerDiagnostic = NO;
         _userAnonymisation = NO;
+        _asynchronousTracking = NO;
+        _trackingQueueCapacity = 1000;
+        _trackingQueueOverflowPolicy = SPTrackingQueueOverflowPolicyDropNewest;
+        _trackingQueue = dispatch_queue_create("com.snowplowanalytics.snowplow.tracking", DISPATCH_QUEUE_SERIAL);
+        dispatch_queue_set_specific(_trackingQueue, kSPTrackingQueueKey, kSPTrackingQueueKey, NULL);
+        _trackingQueueSlots = dispatch_semaphore_create(_trackingQueueCapacity);
+        _contextFragments = [SPContextFragmentCache new];
 #if SNOWPLOW_TARGET_IOS
         _platformContextSchema = kSPMobileContextSchema;
 #else
@@ -281,6 +301,7 @@ void uncaughtExceptionHandler(NSException *exception) {
 
 - (void) setSubject:(SPSubject *)subject {
     _subject = subject;
+    [_contextFragments removeAllFragments];
 }
 
 - (void) setBase64Encoded:(BOOL)encoded {
@@ -356,6 +377,7 @@ void uncaughtExceptionHandler(NSException *exception) {
 
 - (void) setApplicationContext:(BOOL)applicationContext {
     _applicationContext = applicationContext;
+    [_contextFragments removeAllFragments];
 }
 
 - (void) setAutotrackScreenViews:(BOOL)autotrackScreenViews {
@@ -402,12 +424,38 @@ void uncaughtExceptionHandler(NSException *exception) {
 - (void)setUserAnonymisation:(BOOL)userAnonymisation {
     if (_userAnonymisation != userAnonymisation) {
         _userAnonymisation = userAnonymisation;
+        [_contextFragments removeAllFragments];
         if (_session != nil) {
             [_session startNewSession];
         }
     }
 }
 
+- (void)setAsynchronousTracking:(BOOL)asynchronousTracking {
+    _asynchronousTracking = asynchronousTracking;
+    if (!asynchronousTracking) {
+        // The events tracked from now on must not overtake the ones still queued.
+        [self waitForTrackedEvents];
+    }
+}
+
+- (void)setTrackingQueueCapacity:(NSInteger)trackingQueueCapacity {
+    if (trackingQueueCapacity <= 0) {
+        return;
+    }
+    @synchronized (self) {
+        _trackingQueueCapacity = trackingQueueCapacity;
+        // The events already queued release the slots of the previous semaphore.
+        _trackingQueueSlots = dispatch_semaphore_create(trackingQueueCapacity);
+    }
+}
+
+- (void)setTrackingQueueOverflowPolicy:(SPTrackingQueueOverflowPolicy)trackingQueueOverflowPolicy {
+    @synchronized (self) {
+        _trackingQueueOverflowPolicy = trackingQueueOverflowPolicy;
+    }
+}
+
 #pragma mark - Global Contexts methods
 
 - (void)setGlobalContextGenerators:(NSDictionary<NSString *, SPGlobalContext *> *)globalContexts {
@@ -432,6 +480,11 @@ void uncaughtExceptionHandler(NSException *exception) {
 
 #pragma mark - GDPR methods
 
+- (void)setGdpr:(SPGdprContext *)gdpr {
+    _gdpr = gdpr;
+    [_contextFragments removeAllFragments];
+}
+
 - (void)setGdprContextWithBasis:(SPGdprProcessingBasis)basisForProcessing
                      documentId:(NSString *)documentId
                 documentVersion:(NSString *)documentVersion
@@ -533,6 +586,8 @@ void uncaughtExceptionHandler(NSException *exception) {
     if (_exceptionEvents) {
         SNOWError *event = [[[SNOWError alloc] initWithMessage:message] stackTrace:stacktrace];
         [self track:event];
+        // The app is about to terminate.
+        [self waitForTrackedEvents];
     }
 }
 
@@ -540,23 +595,167 @@ void uncaughtExceptionHandler(NSException *exception) {
 
 - (NSUUID *)track:(SPEvent *)event {
     if (!event || !_dataCollection) return nil;
+    // Events tracked while processing another event (e.g. ecommerce items) are processed straight away.
+    if (_asynchronousTracking && !dispatch_get_specific(kSPTrackingQueueKey)) {
+        return [self enqueueEvent:event];
+    }
     [event beginProcessingWithTracker:self];
     NSUUID *eventId = [self processEvent:event];
     [event endProcessingWithTracker:self];
     return eventId;
 }
 
+- (NSArray<NSUUID *> *)trackEvents:(NSArray<SPEvent *> *)events {
+    if (!events.count || !_dataCollection) return @[];
+    if (_asynchronousTracking && !dispatch_get_specific(kSPTrackingQueueKey)) {
+        return [self enqueueEvents:events];
+    }
+    NSArray<NSUUID *> *eventIds = [self eventIdsForEventCount:events.count];
+    [self processEvents:events eventIds:eventIds timestamp:(long long)([[NSDate date] timeIntervalSince1970] * 1000)];
+    return eventIds;
+}
+
+/*!
+ @brief Assigns the identifier and timestamp of the event and processes it on the tracking queue.
+ @return The event ID or nil if the queue is full and the overflow policy drops the event.
+ */
+- (NSUUID *)enqueueEvent:(SPEvent *)event {
+    return [self enqueueEvents:@[event]].firstObject;
+}
+
+/*!
+ @brief Assigns the identifiers and timestamp of the events and processes them on the tracking queue.
+
+ Each event takes a slot of the queue. When the queue is full, the events enqueued so far are dispatched
+ and the overflow policy applies to the rest: they either wait for free slots or are dropped.
+ @return The IDs of the enqueued events, which are the first ones of the batch when the others have been dropped.
+ */
+- (NSArray<NSUUID *> *)enqueueEvents:(NSArray<SPEvent *> *)events {
+    dispatch_semaphore_t slots;
+    SPTrackingQueueOverflowPolicy overflowPolicy;
+    @synchronized (self) {
+        slots = _trackingQueueSlots;
+        overflowPolicy = _trackingQueueOverflowPolicy;
+    }
+    long long timestamp = (long long)([[NSDate date] timeIntervalSince1970] * 1000);
+    NSMutableArray<NSUUID *> *eventIds = [NSMutableArray arrayWithCapacity:events.count];
+    NSUInteger dispatchedCount = 0;
+    for (NSUInteger i = 0; i < events.count; i++) {
+        if (dispatch_semaphore_wait(slots, DISPATCH_TIME_NOW) != 0) {
+            // The slots taken so far are released only once their events are processed.
+            [self dispatchEvents:[events subarrayWithRange:NSMakeRange(dispatchedCount, i - dispatchedCount)]
+                        eventIds:[eventIds subarrayWithRange:NSMakeRange(dispatchedCount, i - dispatchedCount)]
+                       timestamp:timestamp
+                           slots:slots];
+            dispatchedCount = i;
+            if (overflowPolicy == SPTrackingQueueOverflowPolicyDropNewest) {
+                SPLogError(@"The tracking queue is full: %@ events have been dropped.", @(events.count - i));
+                return eventIds;
+            }
+            dispatch_semaphore_wait(slots, DISPATCH_TIME_FOREVER);
+        }
+        [eventIds addObject:[NSUUID UUID]];
+    }
+    [self dispatchEvents:[events subarrayWithRange:NSMakeRange(dispatchedCount, events.count - dispatchedCount)]
+                eventIds:[eventIds subarrayWithRange:NSMakeRange(dispatchedCount, events.count - dispatchedCount)]
+               timestamp:timestamp
+                   slots:slots];
+    return eventIds;
+}
+
+- (void)dispatchEvents:(NSArray<SPEvent *> *)events eventIds:(NSArray<NSUUID *> *)eventIds timestamp:(long long)timestamp slots:(dispatch_semaphore_t)slots {
+    if (!events.count) {
+        return;
+    }
+    // The events are copied so that the caller can modify or reuse them while they wait on the queue.
+    NSMutableArray<SPEvent *> *snapshots = [NSMutableArray arrayWithCapacity:events.count];
+    for (SPEvent *event in events) {
+        [snapshots addObject:[event conformsToProtocol:@protocol(NSCopying)] ? [event copy] : event];
+    }
+    dispatch_async(_trackingQueue, ^{
+        @try {
+            [self processEvents:snapshots eventIds:eventIds timestamp:timestamp];
+        } @catch (NSException *exception) {
+            SPLogError(@"Received exception while processing the event: %@", exception);
+        }
+        for (NSUInteger i = 0; i < events.count; i++) {
+            dispatch_semaphore_signal(slots);
+        }
+    });
+}
+
+- (void)waitForTrackedEvents {
+    if (!dispatch_get_specific(kSPTrackingQueueKey)) {
+        dispatch_sync(_trackingQueue, ^{});
+    }
+}
+
 #pragma mark - Event Decoration
 
 - (NSUUID *)processEvent:(SPEvent *)event {
+    return [self processEvent:event eventId:[NSUUID UUID] timestamp:(long long)([[NSDate date] timeIntervalSince1970] * 1000)];
+}
+
+- (NSArray<NSUUID *> *)eventIdsForEventCount:(NSUInteger)count {
+    NSMutableArray<NSUUID *> *eventIds = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger i = 0; i < count; i++) {
+        [eventIds addObject:[NSUUID UUID]];
+    }
+    return eventIds;
+}
+
+/*!
+ @brief Processes a batch of events sharing the work that doesn't depend on the single event.
+
+ The tracker state is taken with a single lock, the contexts that don't depend on the event are looked up once,
+ and the payloads are added to the emitter in one go. Events tracked by the events of the batch
+ (e.g. ecommerce items) are tracked after the batch.
+ */
+- (void)processEvents:(NSArray<SPEvent *> *)events eventIds:(NSArray<NSUUID *> *)eventIds timestamp:(long long)timestamp {
+    if (events.count == 1) {
+        SPEvent *event = events.firstObject;
+        [event beginProcessingWithTracker:self];
+        [self processEvent:event eventId:eventIds.firstObject timestamp:timestamp];
+        [event endProcessingWithTracker:self];
+        return;
+    }
+    for (SPEvent *event in events) {
+        [event beginProcessingWithTracker:self];
+    }
+    NSMutableArray<SPTrackerState *> *stateSnapshots = [NSMutableArray arrayWithCapacity:events.count];
+    @synchronized (self) {
+        for (SPEvent *event in events) {
+            [stateSnapshots addObject:[self.stateManager trackerStateForProcessedEvent:event]];
+        }
+    }
+    NSArray<NSData *> *staticContextFragments = [self staticContextFragments];
+    NSMutableArray<SPPayload *> *payloads = [NSMutableArray arrayWithCapacity:events.count];
+    BOOL flushImmediately = NO;
+    for (NSUInteger i = 0; i < events.count; i++) {
+        SPTrackerEvent *trackerEvent = [[SPTrackerEvent alloc] initWithEvent:events[i] state:stateSnapshots[i] eventId:eventIds[i] timestamp:timestamp];
+        [self transformEvent:trackerEvent];
+        SPPayload *payload = [self payloadWithEvent:trackerEvent staticContextFragments:staticContextFragments];
+        payload.priority = [_emitter evictionPriorityForEventWithSchema:trackerEvent.schema eventName:trackerEvent.eventName];
+        flushImmediately = flushImmediately || [_emitter isImmediateFlushEventWithSchema:trackerEvent.schema eventName:trackerEvent.eventName];
+        [payloads addObject:payload];
+    }
+    [_emitter addPayloadsToBuffer:payloads flushImmediately:flushImmediately];
+    for (SPEvent *event in events) {
+        [event endProcessingWithTracker:self];
+    }
+}
+
+- (NSUUID *)processEvent:(SPEvent *)event eventId:(NSUUID *)eventId timestamp:(long long)timestamp {
     SPTrackerState *stateSnapshot;
     @synchronized (self) {
         stateSnapshot = [self.stateManager trackerStateForProcessedEvent:event];
     }
-    SPTrackerEvent *trackerEvent = [[SPTrackerEvent alloc] initWithEvent:event state:stateSnapshot];
+    SPTrackerEvent *trackerEvent = [[SPTrackerEvent alloc] initWithEvent:event state:stateSnapshot eventId:eventId timestamp:timestamp];
     [self transformEvent:trackerEvent];
     SPPayload *payload = [self payloadWithEvent:trackerEvent];
-    [_emitter addPayloadToBuffer:payload];
+    payload.priority = [_emitter evictionPriorityForEventWithSchema:trackerEvent.schema eventName:trackerEvent.eventName];
+    BOOL flushImmediately = [_emitter isImmediateFlushEventWithSchema:trackerEvent.schema eventName:trackerEvent.eventName];
+    [_emitter addPayloadToBuffer:payload flushImmediately:flushImmediately];
     return [trackerEvent eventId];
 }
 
@@ -571,6 +770,10 @@ void uncaughtExceptionHandler(NSException *exception) {
 }
 
 - (SPPayload *)payloadWithEvent:(SPTrackerEvent *)event {
+    return [self payloadWithEvent:event staticContextFragments:[self staticContextFragments]];
+}
+
+- (SPPayload *)payloadWithEvent:(SPTrackerEvent *)event staticContextFragments:(NSArray<NSData *> *)staticContextFragments {
     SPPayload *payload = [SPPayload new];
     payload.allowDiagnostic = !event.isService;
 
@@ -581,10 +784,26 @@ void uncaughtExceptionHandler(NSException *exception) {
         [self addSelfDescribingPropertiesToPayload:payload event:event];
     }
     NSMutableArray<SPSelfDescribingJson *> *contexts = event.contexts;
+    NSUInteger eventContextsCount = contexts.count;
     [self addBasicContextsToContexts:contexts event:event];
+    NSUInteger basicContextsEnd = contexts.count;
     [self addGlobalContextsToContexts:contexts event:event];
     [self addStateMachineEntitiesToContexts:contexts event:event];
-    [self wrapContexts:contexts toPayload:payload];
+
+    // The entities that rarely change are added as serialized fragments, in the same position as the other entities:
+    // event contexts, platform/geolocation/application, session, GDPR, global contexts and state machine entities.
+    NSMutableArray *contextEntries = [NSMutableArray arrayWithCapacity:contexts.count + staticContextFragments.count + 1];
+    [contextEntries addObjectsFromArray:[contexts subarrayWithRange:NSMakeRange(0, eventContextsCount)]];
+    [contextEntries addObjectsFromArray:staticContextFragments];
+    [contextEntries addObjectsFromArray:[contexts subarrayWithRange:NSMakeRange(eventContextsCount, basicContextsEnd - eventContextsCount)]];
+    if (!event.isService) {
+        NSData *gdprContextFragment = [self gdprContextFragment];
+        if (gdprContextFragment) {
+            [contextEntries addObject:gdprContextFragment];
+        }
+    }
+    [contextEntries addObjectsFromArray:[contexts subarrayWithRange:NSMakeRange(basicContextsEnd, contexts.count - basicContextsEnd)]];
+    [self wrapContextEntries:contextEntries toPayload:payload];
     if (!event.isPrimitive) {
         // TODO: To remove when Atomic table refactoring is finished
         [self workaroundForCampaignAttributionEnrichment:payload event:event contexts:contexts];
@@ -664,25 +883,58 @@ void uncaughtExceptionHandler(NSException *exception) {
     [self addBasicContextsToContexts:contexts eventId:event.eventId.UUIDString eventTimestamp:event.timestamp isService:event.isService];
 }
 
-- (void)addBasicContextsToContexts:(NSMutableArray<SPSelfDescribingJson *> *)contexts eventId:(NSString *)eventId eventTimestamp:(long long)eventTimestamp isService:(BOOL)isService {
-    if (_subject) {
-        NSDictionary * platformDict = [[_subject getPlatformDictWithUserAnonymisation:self.userAnonymisation] getAsDictionary];
-        if (platformDict != nil) {
-            [contexts addObject:[[SPSelfDescribingJson alloc] initWithSchema:_platformContextSchema andData:platformDict]];
+/*!
+ @brief The serialized contexts that don't depend on the event: platform, geolocation and application contexts.
+
+ They are serialized again only when the subject reports a change or the tracker settings change.
+ */
+- (NSArray<NSData *> *)staticContextFragments {
+    NSMutableArray<NSData *> *fragments = [NSMutableArray new];
+    SPSubject *subject = _subject;
+    if (subject) {
+        NSUInteger subjectVersion = subject.contextVersion;
+        BOOL userAnonymisation = self.userAnonymisation;
+        // The platform context depends on the anonymisation as well.
+        NSUInteger platformVersion = subjectVersion * 2 + (userAnonymisation ? 1 : 0);
+        NSString *platformContextSchema = _platformContextSchema;
+        NSData *platformFragment = [_contextFragments fragmentWithKey:kSPPlatformContextFragment version:platformVersion builder:^SPSelfDescribingJson *{
+            NSDictionary * platformDict = [[subject getPlatformDictWithUserAnonymisation:userAnonymisation] getAsDictionary];
+            return platformDict ? [[SPSelfDescribingJson alloc] initWithSchema:platformContextSchema andData:platformDict] : nil;
+        }];
+        if (platformFragment) {
+            [fragments addObject:platformFragment];
         }
-        NSDictionary * geoLocationDict = [_subject getGeoLocationDict];
-        if (geoLocationDict != nil) {
-            [contexts addObject:[[SPSelfDescribingJson alloc] initWithSchema:kSPGeoContextSchema andData:geoLocationDict]];
+        NSData *geoLocationFragment = [_contextFragments fragmentWithKey:kSPGeoLocationContextFragment version:subjectVersion builder:^SPSelfDescribingJson *{
+            NSDictionary * geoLocationDict = [subject getGeoLocationDict];
+            return geoLocationDict ? [[SPSelfDescribingJson alloc] initWithSchema:kSPGeoContextSchema andData:geoLocationDict] : nil;
+        }];
+        if (geoLocationFragment) {
+            [fragments addObject:geoLocationFragment];
         }
     }
 
     if (_applicationContext) {
-        SPSelfDescribingJson * contextJson = [SPUtilities getApplicationContext];
-        if (contextJson != nil) {
-            [contexts addObject:contextJson];
+        NSData *applicationFragment = [_contextFragments fragmentWithKey:kSPApplicationContextFragment version:0 builder:^SPSelfDescribingJson *{
+            return [SPUtilities getApplicationContext];
+        }];
+        if (applicationFragment) {
+            [fragments addObject:applicationFragment];
         }
     }
-    
+    return fragments;
+}
+
+- (NSData *)gdprContextFragment {
+    SPGdprContext *gdpr = self.gdpr;
+    if (!gdpr) {
+        return nil;
+    }
+    return [_contextFragments fragmentWithKey:kSPGdprContextFragment version:0 builder:^SPSelfDescribingJson *{
+        return gdpr.context;
+    }];
+}
+
+- (void)addBasicContextsToContexts:(NSMutableArray<SPSelfDescribingJson *> *)contexts eventId:(NSString *)eventId eventTimestamp:(long long)eventTimestamp isService:(BOOL)isService {
     if (isService) {
         return;
     }
@@ -697,13 +949,6 @@ void uncaughtExceptionHandler(NSException *exception) {
         }
     }
     
-    // Add GDPR context
-    if (self.gdpr) {
-        SPSelfDescribingJson *gdprContext = self.gdpr.context;
-        if (gdprContext) {
-            [contexts addObject:gdprContext];
-        }
-    }
 }
 
 - (void)addGlobalContextsToContexts:(NSMutableArray<SPSelfDescribingJson *> *)contexts event:(id<SPInspectableEvent>)event {
@@ -717,23 +962,15 @@ void uncaughtExceptionHandler(NSException *exception) {
     [contexts addObjectsFromArray:stateManagerEntities];
 }
 
-- (void)wrapContexts:(NSArray<SPSelfDescribingJson *> *)contexts toPayload:(SPPayload *)payload {
-    if (contexts.count == 0) {
+- (void)wrapContextEntries:(NSArray *)contextEntries toPayload:(SPPayload *)payload {
+    if (contextEntries.count == 0) {
         return;
     }
-    NSMutableArray<NSDictionary *> *data = [NSMutableArray new];
-    for (SPSelfDescribingJson *context in contexts) {
-        [data addObject:[context getAsDictionary]];
-    }
-
-    SPSelfDescribingJson *finalContext = [[SPSelfDescribingJson alloc] initWithSchema:kSPContextSchema andData:data];
-    if (finalContext == nil) {
-        return;
-    }
-    [payload addDictionaryToPayload:[finalContext getAsDictionary]
-                      base64Encoded:_base64Encoded
-                    typeWhenEncoded:kSPContextEncoded
-                 typeWhenNotEncoded:kSPContext];
+    NSData *finalContext = [SPContextFragmentCache contextsJsonWithEntries:contextEntries];
+    [payload addTrustedJsonToPayload:finalContext
+                       base64Encoded:_base64Encoded
+                     typeWhenEncoded:kSPContextEncoded
+                  typeWhenNotEncoded:kSPContext];
 }
 
 - (void)dealloc {
@@ -46,6 +46,9 @@ SP_DIRTYFLAG(installAutotracking)
 SP_DIRTYFLAG(exceptionAutotracking)
 SP_DIRTYFLAG(diagnosticAutotracking)
 SP_DIRTYFLAG(userAnonymisation)
+SP_DIRTYFLAG(asynchronousTracking)
+SP_DIRTYFLAG(trackingQueueCapacity)
+SP_DIRTYFLAG(trackingQueueOverflowPolicy)
 SP_DIRTYFLAG(trackerVersionSuffix)
 
 @end
@@ -40,6 +40,9 @@ SP_DIRTY_GETTER(BOOL, installAutotracking)
 SP_DIRTY_GETTER(BOOL, exceptionAutotracking)
 SP_DIRTY_GETTER(BOOL, diagnosticAutotracking)
 SP_DIRTY_GETTER(BOOL, userAnonymisation)
+SP_DIRTY_GETTER(BOOL, asynchronousTracking)
+SP_DIRTY_GETTER(NSInteger, trackingQueueCapacity)
+SP_DIRTY_GETTER(SPTrackingQueueOverflowPolicy, trackingQueueOverflowPolicy)
 SP_DIRTY_GETTER(NSString *, trackerVersionSuffix)
 
 @end
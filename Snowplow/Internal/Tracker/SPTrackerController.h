@@ -49,6 +49,11 @@ NS_SWIFT_NAME(TrackerController)
  * It is used to identify the tracker among multiple trackers running in the same app.
  */
 @property (readonly, nonatomic) NSString *namespace;
+/**
+ * Time in seconds spent creating the tracker on the calling thread, usually the main thread during app launch.
+ * The event store is opened in background so it isn't part of it.
+ */
+@property (readonly, nonatomic) NSTimeInterval initializationDuration;
 
 /**
  * SubjectController.
@@ -88,6 +93,15 @@ NS_SWIFT_NAME(TrackerController)
  * @return The event ID or nil in case tracking is paused
  */
 - (nullable NSUUID *)track:(SPEvent *)event;
+/**
+ * Track several events at once.
+ * It is cheaper than tracking the events one by one: the tracker state is read once,
+ * the events are stored in a single write and they trigger a single flush.
+ * Events tracked by the events of the batch (e.g. ecommerce items) are tracked after the batch.
+ * @param events The events to track, in order.
+ * @return The event IDs in the same order as the events, or an empty array in case tracking is paused
+ */
+- (NSArray<NSUUID *> *)trackEvents:(NSArray<SPEvent *> *)events;
 /**
  * Pause the tracker.
  * The tracker will stop any new activity tracking but it will continue to send remaining events
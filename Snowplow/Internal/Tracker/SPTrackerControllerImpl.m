@@ -86,6 +86,10 @@
     return [self.tracker track:event];
 }
 
+- (NSArray<NSUUID *> *)trackEvents:(NSArray<SPEvent *> *)events {
+    return [self.tracker trackEvents:events];
+}
+
 // MARK: - Properties' setters and getters
 
 - (void)setAppId:(NSString *)appId {
@@ -274,6 +278,36 @@
     return self.tracker.userAnonymisation;
 }
 
+- (void)setAsynchronousTracking:(BOOL)asynchronousTracking {
+    self.dirtyConfig.asynchronousTracking = asynchronousTracking;
+    self.dirtyConfig.asynchronousTrackingUpdated = YES;
+    [self.tracker setAsynchronousTracking:asynchronousTracking];
+}
+
+- (BOOL)asynchronousTracking {
+    return self.tracker.asynchronousTracking;
+}
+
+- (void)setTrackingQueueCapacity:(NSInteger)trackingQueueCapacity {
+    self.dirtyConfig.trackingQueueCapacity = trackingQueueCapacity;
+    self.dirtyConfig.trackingQueueCapacityUpdated = YES;
+    [self.tracker setTrackingQueueCapacity:trackingQueueCapacity];
+}
+
+- (NSInteger)trackingQueueCapacity {
+    return self.tracker.trackingQueueCapacity;
+}
+
+- (void)setTrackingQueueOverflowPolicy:(SPTrackingQueueOverflowPolicy)trackingQueueOverflowPolicy {
+    self.dirtyConfig.trackingQueueOverflowPolicy = trackingQueueOverflowPolicy;
+    self.dirtyConfig.trackingQueueOverflowPolicyUpdated = YES;
+    [self.tracker setTrackingQueueOverflowPolicy:trackingQueueOverflowPolicy];
+}
+
+- (SPTrackingQueueOverflowPolicy)trackingQueueOverflowPolicy {
+    return self.tracker.trackingQueueOverflowPolicy;
+}
+
 - (BOOL)isTracking {
     return [self.tracker getIsTracking];
 }
@@ -282,6 +316,10 @@
     return kSPVersion;
 }
 
+- (NSTimeInterval)initializationDuration {
+    return self.serviceProvider.initializationDuration;
+}
+
 // MARK: - Private methods
 
 - (SPTracker *)tracker {
@@ -45,6 +45,7 @@ NS_ASSUME_NONNULL_BEGIN
 
 - (instancetype)initWithEvent:(SPEvent *)event;
 - (instancetype)initWithEvent:(SPEvent *)event state:(nullable id<SPTrackerStateSnapshot>)state;
+- (instancetype)initWithEvent:(SPEvent *)event state:(nullable id<SPTrackerStateSnapshot>)state eventId:(NSUUID *)eventId timestamp:(long long)timestamp;
 
 @end
 
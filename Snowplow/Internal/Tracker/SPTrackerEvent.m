@@ -33,9 +33,13 @@
 }
 
 - (instancetype)initWithEvent:(SPEvent *)event state:(id<SPTrackerStateSnapshot>)state {
+    return [self initWithEvent:event state:state eventId:[NSUUID UUID] timestamp:(long long)([[[NSDate alloc] init] timeIntervalSince1970] * 1000)];
+}
+
+- (instancetype)initWithEvent:(SPEvent *)event state:(id<SPTrackerStateSnapshot>)state eventId:(NSUUID *)eventId timestamp:(long long)timestamp {
     if (self = [super init]) {
-        self.eventId = [NSUUID UUID];
-        self.timestamp = (long long)([[[NSDate alloc] init] timeIntervalSince1970] * 1000);
+        self.eventId = eventId;
+        self.timestamp = timestamp;
         self.trueTimestamp = event.trueTimestamp;
         self.contexts = [event.contexts mutableCopy];
         self.payload = [event.payload mutableCopy];
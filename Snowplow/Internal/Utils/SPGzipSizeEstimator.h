@@ -0,0 +1,49 @@
+//
+//  SPGzipSizeEstimator.h
+//  Snowplow
+//
+//  Copyright (c) 2013-2022 Snowplow Analytics Ltd. All rights reserved.
+//
+//  This program is licensed to you under the Apache License Version 2.0,
+//  and you may not use this file except in compliance with the Apache License
+//  Version 2.0. You may obtain a copy of the Apache License Version 2.0 at
+//  http://www.apache.org/licenses/LICENSE-2.0.
+//
+//  Unless required by applicable law or agreed to in writing,
+//  software distributed under the Apache License Version 2.0 is distributed on
+//  an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+//  express or implied. See the Apache License Version 2.0 for the specific
+//  language governing permissions and limitations there under.
+//
+//  License: Apache License Version 2.0
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Keeps a running gzip stream to know the compressed size of data appended piece by piece,
+ * without compressing all the data again every time a piece is added.
+ *
+ * Every piece is flushed so the size is known straight away, which makes the estimate slightly
+ * larger than the size of the same data compressed in one go by SPUtilities gzipCompressData:.
+ */
+@interface SPGzipSizeEstimator : NSObject
+
+/// The estimated size of the gzip data including the data appended so far and the gzip trailer.
+@property (nonatomic, readonly) NSUInteger compressedSize;
+
+/// The size of the data appended so far.
+@property (nonatomic, readonly) NSUInteger uncompressedSize;
+
+/**
+ * Compresses the data into the stream.
+ * @param data The data to append.
+ * @return Whether the data has been compressed, otherwise the estimator can't be used any further.
+ */
+- (BOOL)appendData:(NSData *)data;
+
+@end
+
+NS_ASSUME_NONNULL_END
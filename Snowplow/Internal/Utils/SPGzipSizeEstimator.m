@@ -0,0 +1,81 @@
+//
+//  SPGzipSizeEstimator.m
+//  Snowplow
+//
+//  Copyright (c) 2013-2022 Snowplow Analytics Ltd. All rights reserved.
+//
+//  This program is licensed to you under the Apache License Version 2.0,
+//  and you may not use this file except in compliance with the Apache License
+//  Version 2.0. You may obtain a copy of the Apache License Version 2.0 at
+//  http://www.apache.org/licenses/LICENSE-2.0.
+//
+//  Unless required by applicable law or agreed to in writing,
+//  software distributed under the Apache License Version 2.0 is distributed on
+//  an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+//  express or implied. See the Apache License Version 2.0 for the specific
+//  language governing permissions and limitations there under.
+//
+//  License: Apache License Version 2.0
+//
+
+#import "SPGzipSizeEstimator.h"
+#import "SPLogger.h"
+#import <zlib.h>
+
+/// The gzip trailer (CRC32 and size) and the empty final block written when the stream is finished.
+static const NSUInteger kSPGzipFinishBytes = 8 + 2;
+
+@implementation SPGzipSizeEstimator {
+    z_stream _stream;
+    BOOL _isValid;
+    NSMutableData *_scratch;
+    NSUInteger _uncompressedSize;
+}
+
+- (instancetype)init {
+    if (self = [super init]) {
+        memset(&_stream, 0, sizeof(_stream));
+        // Same parameters as SPUtilities gzipCompressData:.
+        _isValid = deflateInit2(&_stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+        _scratch = [NSMutableData dataWithLength:16384];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    if (_isValid) {
+        deflateEnd(&_stream);
+    }
+}
+
+- (NSUInteger)compressedSize {
+    return (NSUInteger)_stream.total_out + kSPGzipFinishBytes;
+}
+
+- (NSUInteger)uncompressedSize {
+    return _uncompressedSize;
+}
+
+- (BOOL)appendData:(NSData *)data {
+    if (!_isValid) {
+        return NO;
+    }
+    _stream.next_in = (Bytef *)data.bytes;
+    _stream.avail_in = (uInt)data.length;
+    // The compressed bytes are only counted, the scratch buffer is overwritten.
+    do {
+        _stream.next_out = (Bytef *)_scratch.mutableBytes;
+        _stream.avail_out = (uInt)_scratch.length;
+        int status = deflate(&_stream, Z_SYNC_FLUSH);
+        if (status != Z_OK && status != Z_BUF_ERROR) {
+            SPLogError(@"Unable to estimate the compressed size: %d", status);
+            deflateEnd(&_stream);
+            _isValid = NO;
+            return NO;
+        }
+    } while (_stream.avail_out == 0);
+    _uncompressedSize += data.length;
+    return YES;
+}
+
+@end
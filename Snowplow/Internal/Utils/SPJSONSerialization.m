@@ -20,13 +20,18 @@
 //
 
 #import "SPJSONSerialization.h"
+#import "SPJSONWriter.h"
 #import "SPLogger.h"
 
 @implementation SPJSONSerialization
 
 + (NSData *)serializeDictionary:(NSDictionary *)dictionary {
+    NSData *data = [SPJSONWriter dataWithDictionary:dictionary];
+    if (data) {
+        return data;
+    }
+    // Unsupported or invalid values: NSJSONSerialization reports the error.
     NSError *error = nil;
-    NSData *data;
     @try {
         data = [NSJSONSerialization dataWithJSONObject:dictionary options:0 error:&error];
     }
@@ -0,0 +1,53 @@
+//
+//  SPJSONWriter.h
+//  Snowplow
+//
+//  Copyright (c) 2013-2022 Snowplow Analytics Ltd. All rights reserved.
+//
+//  This program is licensed to you under the Apache License Version 2.0,
+//  and you may not use this file except in compliance with the Apache License
+//  Version 2.0. You may obtain a copy of the Apache License Version 2.0 at
+//  http://www.apache.org/licenses/LICENSE-2.0.
+//
+//  Unless required by applicable law or agreed to in writing,
+//  software distributed under the Apache License Version 2.0 is distributed on
+//  an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+//  express or implied. See the Apache License Version 2.0 for the specific
+//  language governing permissions and limitations there under.
+//
+//  License: Apache License Version 2.0
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Streaming JSON writer specialised for the tracker payloads.
+ *
+ * It appends the JSON straight into a growable byte buffer reused across calls (one writer per thread),
+ * and the common payload keys from SPTrackerConstants are written from pre-escaped bytes.
+ * The output is byte for byte the one of NSJSONSerialization with no writing options: floating point
+ * numbers are formatted by NSJSONSerialization itself to keep the exact same representation.
+ */
+@interface SPJSONWriter : NSObject
+
+/**
+ * Serializes the dictionary with the writer of the current thread.
+ * @param dictionary The dictionary to serialize.
+ * @return The JSON data, or nil if the dictionary contains values the writer doesn't support
+ * (anything other than strings, numbers, NSNull, arrays and dictionaries with string keys) or that
+ * can't be represented in JSON.
+ */
++ (nullable NSData *)dataWithDictionary:(NSDictionary *)dictionary;
+
+/**
+ * Serializes the dictionary reusing the buffer of the writer.
+ * @param dictionary The dictionary to serialize.
+ * @return The JSON data, or nil if the dictionary can't be serialized by the writer.
+ */
+- (nullable NSData *)dataWithDictionary:(NSDictionary *)dictionary;
+
+@end
+
+NS_ASSUME_NONNULL_END
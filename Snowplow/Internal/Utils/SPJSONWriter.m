@@ -0,0 +1,336 @@
+//
+//  SPJSONWriter.m
+//  Snowplow
+//
+//  Copyright (c) 2013-2022 Snowplow Analytics Ltd. All rights reserved.
+//
+//  This program is licensed to you under the Apache License Version 2.0,
+//  and you may not use this file except in compliance with the Apache License
+//  Version 2.0. You may obtain a copy of the Apache License Version 2.0 at
+//  http://www.apache.org/licenses/LICENSE-2.0.
+//
+//  Unless required by applicable law or agreed to in writing,
+//  software distributed under the Apache License Version 2.0 is distributed on
+//  an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+//  express or implied. See the Apache License Version 2.0 for the specific
+//  language governing permissions and limitations there under.
+//
+//  License: Apache License Version 2.0
+//
+
+#import "SPJSONWriter.h"
+#import "SPTrackerConstants.h"
+
+static NSString * const kSPJSONWriterThreadKey = @"SPJSONWriter";
+
+/// Initial capacity of the buffer, enough for most events.
+static const size_t kSPJSONWriterInitialCapacity = 2048;
+/// Buffers grown beyond this size are released after use, so that a single large payload doesn't keep the memory.
+static const size_t kSPJSONWriterMaxRetainedCapacity = 256 * 1024;
+
+typedef struct {
+    uint8_t *bytes;
+    size_t length;
+    size_t capacity;
+} SPJSONBuffer;
+
+/// Pre-escaped `"key":` of the common payload keys.
+/// The payloads are built with the constants, so the keys are looked up by pointer rather than by hashing them.
+static NSMapTable<NSString *, NSData *> *SPEscapedKeys(void) {
+    static NSMapTable<NSString *, NSData *> *escapedKeys;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        NSArray<NSString *> *keys = @[
+            kSPSchema, kSPData, kSPEvent, kSPEid, kSPTimestamp, kSPTrueTimestamp, kSPSentTimestamp,
+            kSPTrackerVersion, kSPAppId, kSPNamespace, kSPUid, kSPContext, kSPContextEncoded,
+            kSPUnstructured, kSPUnstructuredEncoded, kSPPlatform, kSPResolution, kSPViewPort, kSPColorDepth,
+            kSPTimezone, kSPLanguage, kSPIpAddress, kSPUseragent, kSPNetworkUid, kSPDomainUid,
+            kSPPlatformOsType, kSPPlatformOsVersion, kSPPlatformDeviceManu, kSPPlatformDeviceModel,
+            kSPMobileCarrier, kSPMobileAppleIdfa, kSPMobileAppleIdfv, kSPMobileNetworkType, kSPMobileNetworkTech,
+            kSPMobilePhysicalMemory, kSPMobileAppAvailableMemory, kSPMobileBatteryLevel, kSPMobileBatteryState,
+            kSPMobileLowPowerMode, kSPMobileAvailableStorage, kSPMobileTotalStorage,
+            kSPApplicationVersion, kSPApplicationBuild,
+            kSPSessionUserId, kSPSessionId, kSPSessionPreviousId, kSPSessionIndex, kSPSessionStorage,
+            kSPSessionFirstEventId, kSPSessionFirstEventTimestamp, kSPSessionEventIndex,
+            kSPGeoLatitude, kSPGeoLongitude, kSPGeoLatLongAccuracy, kSPGeoAltitude, kSPGeoAltitudeAccuracy,
+            kSPGeoBearing, kSPGeoSpeed, kSPGeoTimestamp,
+            kSPScreenName, kSPScreenType, kSPScreenId, kSPScreenViewController, kSPScreenTopViewController,
+            kSPPageUrl, kSPPageTitle, kSPPageRefr,
+            kSPStuctCategory, kSPStuctAction, kSPStuctLabel, kSPStuctProperty, kSPStuctValue,
+        ];
+        escapedKeys = [[NSMapTable alloc] initWithKeyOptions:NSPointerFunctionsOpaqueMemory | NSPointerFunctionsOpaquePersonality
+                                                valueOptions:NSPointerFunctionsStrongMemory
+                                                    capacity:keys.count];
+        for (NSString *key in keys) {
+            // Escaped by NSJSONSerialization itself, so that they can't diverge from its output.
+            NSData *data = [NSJSONSerialization dataWithJSONObject:@[key] options:0 error:nil];
+            NSMutableData *escapedKey = [[data subdataWithRange:NSMakeRange(1, data.length - 2)] mutableCopy];
+            [escapedKey appendBytes:":" length:1];
+            [escapedKeys setObject:escapedKey forKey:key];
+        }
+    });
+    return escapedKeys;
+}
+
+// MARK: - Buffer
+
+static BOOL SPReserve(SPJSONBuffer *buffer, size_t count) {
+    if (buffer->length + count <= buffer->capacity) {
+        return YES;
+    }
+    size_t capacity = MAX(buffer->capacity, kSPJSONWriterInitialCapacity);
+    while (capacity < buffer->length + count) {
+        capacity *= 2;
+    }
+    uint8_t *bytes = realloc(buffer->bytes, capacity);
+    if (!bytes) {
+        return NO;
+    }
+    buffer->bytes = bytes;
+    buffer->capacity = capacity;
+    return YES;
+}
+
+static inline BOOL SPAppend(SPJSONBuffer *buffer, const void *bytes, size_t count) {
+    if (!SPReserve(buffer, count)) {
+        return NO;
+    }
+    memcpy(buffer->bytes + buffer->length, bytes, count);
+    buffer->length += count;
+    return YES;
+}
+
+static inline BOOL SPAppendByte(SPJSONBuffer *buffer, uint8_t byte) {
+    if (!SPReserve(buffer, 1)) {
+        return NO;
+    }
+    buffer->bytes[buffer->length++] = byte;
+    return YES;
+}
+
+// MARK: - Values
+
+static inline BOOL SPNeedsEscape(uint8_t byte) {
+    return byte < 0x20 || byte == '"' || byte == '\\' || byte == '/';
+}
+
+/// Escapes the UTF-8 bytes the same way as NSJSONSerialization: the buffer must have room for 6 bytes per input byte.
+static void SPAppendEscaped(SPJSONBuffer *buffer, const uint8_t *bytes, size_t count) {
+    static const char hexDigits[] = "0123456789abcdef";
+    uint8_t *output = buffer->bytes + buffer->length;
+    for (size_t i = 0; i < count; i++) {
+        uint8_t byte = bytes[i];
+        if (!SPNeedsEscape(byte)) {
+            *output++ = byte;
+            continue;
+        }
+        *output++ = '\\';
+        switch (byte) {
+            case '"': *output++ = '"'; break;
+            case '\\': *output++ = '\\'; break;
+            case '/': *output++ = '/'; break;
+            case '\b': *output++ = 'b'; break;
+            case '\f': *output++ = 'f'; break;
+            case '\n': *output++ = 'n'; break;
+            case '\r': *output++ = 'r'; break;
+            case '\t': *output++ = 't'; break;
+            default:
+                *output++ = 'u';
+                *output++ = '0';
+                *output++ = '0';
+                *output++ = hexDigits[byte >> 4];
+                *output++ = hexDigits[byte & 0xF];
+                break;
+        }
+    }
+    buffer->length = output - buffer->bytes;
+}
+
+static BOOL SPWriteString(SPJSONBuffer *buffer, SPJSONBuffer *scratch, NSString *string) {
+    NSUInteger length = string.length;
+    // A UTF-16 unit is at most 3 bytes in UTF-8 (a surrogate pair is 4 bytes for 2 units).
+    size_t maxLength = length * 3;
+    if (!SPReserve(buffer, maxLength + 2)) {
+        return NO;
+    }
+    buffer->bytes[buffer->length++] = '"';
+    // The string is converted in place, then escaped only if it has characters to escape.
+    uint8_t *start = buffer->bytes + buffer->length;
+    NSUInteger usedLength = 0;
+    NSRange remainingRange = NSMakeRange(0, 0);
+    if (length) {
+        BOOL converted = [string getBytes:start maxLength:maxLength usedLength:&usedLength
+                                 encoding:NSUTF8StringEncoding options:0
+                                    range:NSMakeRange(0, length) remainingRange:&remainingRange];
+        // Strings that can't be converted losslessly (e.g. unpaired surrogates) are left to NSJSONSerialization.
+        if (!converted || remainingRange.length) {
+            return NO;
+        }
+    }
+    size_t escapeIndex = 0;
+    while (escapeIndex < usedLength && !SPNeedsEscape(start[escapeIndex])) {
+        escapeIndex++;
+    }
+    buffer->length += escapeIndex;
+    if (escapeIndex < usedLength) {
+        size_t tailLength = usedLength - escapeIndex;
+        scratch->length = 0;
+        if (!SPAppend(scratch, start + escapeIndex, tailLength) || !SPReserve(buffer, tailLength * 6 + 1)) {
+            return NO;
+        }
+        SPAppendEscaped(buffer, scratch->bytes, tailLength);
+    }
+    return SPAppendByte(buffer, '"');
+}
+
+static BOOL SPWriteFloatingPointNumber(SPJSONBuffer *buffer, NSNumber *number) {
+    // The shortest representation of doubles isn't worth reimplementing as they are rare in the payloads.
+    NSData *data;
+    @try {
+        data = [NSJSONSerialization dataWithJSONObject:@[number] options:0 error:nil];
+    }
+    @catch (NSException *exception) {
+        // Not a valid JSON number (NaN or infinity).
+        return NO;
+    }
+    if (data.length < 2) {
+        return NO;
+    }
+    return SPAppend(buffer, (const uint8_t *)data.bytes + 1, data.length - 2);
+}
+
+static BOOL SPWriteNumber(SPJSONBuffer *buffer, NSNumber *number) {
+    if ((__bridge CFBooleanRef)number == kCFBooleanTrue) {
+        return SPAppend(buffer, "true", 4);
+    }
+    if ((__bridge CFBooleanRef)number == kCFBooleanFalse) {
+        return SPAppend(buffer, "false", 5);
+    }
+    char digits[24];
+    int count;
+    switch (number.objCType[0]) {
+        case 'c': case 's': case 'i': case 'l': case 'q':
+            count = snprintf(digits, sizeof(digits), "%lld", number.longLongValue);
+            break;
+        case 'C': case 'S': case 'I': case 'L': case 'Q':
+            count = snprintf(digits, sizeof(digits), "%llu", number.unsignedLongLongValue);
+            break;
+        default:
+            return SPWriteFloatingPointNumber(buffer, number);
+    }
+    return count > 0 && SPAppend(buffer, digits, count);
+}
+
+static BOOL SPWriteValue(SPJSONBuffer *buffer, SPJSONBuffer *scratch, id value);
+
+static BOOL SPWriteDictionary(SPJSONBuffer *buffer, SPJSONBuffer *scratch, NSDictionary *dictionary) {
+    if (!SPAppendByte(buffer, '{')) {
+        return NO;
+    }
+    NSMapTable<NSString *, NSData *> *escapedKeys = SPEscapedKeys();
+    __block BOOL first = YES;
+    __block BOOL success = YES;
+    // Same enumeration order as NSJSONSerialization.
+    [dictionary enumerateKeysAndObjectsUsingBlock:^(id key, id value, BOOL *stop) {
+        if (!first && !SPAppendByte(buffer, ',')) {
+            success = NO;
+            *stop = YES;
+            return;
+        }
+        first = NO;
+        NSData *escapedKey = [escapedKeys objectForKey:key];
+        if (escapedKey) {
+            success = SPAppend(buffer, escapedKey.bytes, escapedKey.length);
+        } else {
+            success = [key isKindOfClass:NSString.class]
+                && SPWriteString(buffer, scratch, key)
+                && SPAppendByte(buffer, ':');
+        }
+        success = success && SPWriteValue(buffer, scratch, value);
+        *stop = !success;
+    }];
+    return success && SPAppendByte(buffer, '}');
+}
+
+static BOOL SPWriteArray(SPJSONBuffer *buffer, SPJSONBuffer *scratch, NSArray *array) {
+    if (!SPAppendByte(buffer, '[')) {
+        return NO;
+    }
+    BOOL first = YES;
+    for (id value in array) {
+        if (!first && !SPAppendByte(buffer, ',')) {
+            return NO;
+        }
+        first = NO;
+        if (!SPWriteValue(buffer, scratch, value)) {
+            return NO;
+        }
+    }
+    return SPAppendByte(buffer, ']');
+}
+
+static BOOL SPWriteValue(SPJSONBuffer *buffer, SPJSONBuffer *scratch, id value) {
+    if ([value isKindOfClass:NSString.class]) {
+        return SPWriteString(buffer, scratch, value);
+    }
+    if ([value isKindOfClass:NSNumber.class]) {
+        return SPWriteNumber(buffer, value);
+    }
+    if ([value isKindOfClass:NSDictionary.class]) {
+        return SPWriteDictionary(buffer, scratch, value);
+    }
+    if ([value isKindOfClass:NSArray.class]) {
+        return SPWriteArray(buffer, scratch, value);
+    }
+    if ([value isKindOfClass:NSNull.class]) {
+        return SPAppend(buffer, "null", 4);
+    }
+    return NO;
+}
+
+static void SPTrimBuffer(SPJSONBuffer *buffer) {
+    buffer->length = 0;
+    if (buffer->capacity > kSPJSONWriterMaxRetainedCapacity) {
+        free(buffer->bytes);
+        buffer->bytes = NULL;
+        buffer->capacity = 0;
+    }
+}
+
+// MARK: - SPJSONWriter
+
+@implementation SPJSONWriter {
+    SPJSONBuffer _buffer;
+    /// Holds the part of a string being escaped.
+    SPJSONBuffer _scratch;
+}
+
++ (NSData *)dataWithDictionary:(NSDictionary *)dictionary {
+    NSMutableDictionary *threadDictionary = [NSThread currentThread].threadDictionary;
+    SPJSONWriter *writer = threadDictionary[kSPJSONWriterThreadKey];
+    if (!writer) {
+        writer = [SPJSONWriter new];
+        threadDictionary[kSPJSONWriterThreadKey] = writer;
+    }
+    return [writer dataWithDictionary:dictionary];
+}
+
+- (void)dealloc {
+    free(_buffer.bytes);
+    free(_scratch.bytes);
+}
+
+- (NSData *)dataWithDictionary:(NSDictionary *)dictionary {
+    @synchronized (self) {
+        _buffer.length = 0;
+        NSData *data = nil;
+        if (SPWriteDictionary(&_buffer, &_scratch, dictionary)) {
+            data = [NSData dataWithBytes:_buffer.bytes length:_buffer.length];
+        }
+        SPTrimBuffer(&_buffer);
+        SPTrimBuffer(&_scratch);
+        return data;
+    }
+}
+
+@end
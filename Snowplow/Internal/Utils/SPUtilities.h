@@ -107,6 +107,21 @@
  */
 + (NSString *)urlEncodeDictionary:(NSDictionary *)d;
 
+/*!
+ @brief Compresses data with deflate and wraps it in a gzip container, so that it can be sent with `Content-Encoding: gzip`.
+ @param data The data to compress.
+ @return The gzip compressed data or nil if the compression failed.
+ */
++ (NSData *)gzipCompressData:(NSData *)data;
+
+/*!
+ @brief Encodes data in base64url without padding (RFC 4648 section 5), as required by the encoded payload fields.
+ The characters are written in a single pass straight into the buffer of the returned string.
+ @param data The data to encode.
+ @return The encoded string, empty if the data is empty.
+ */
++ (NSString *)base64UrlEncodedStringWithData:(NSData *)data;
+
 /*!
  @brief Checks an expression and will log if it is false.
  This allows for rudimentary Preconditions for object setup.
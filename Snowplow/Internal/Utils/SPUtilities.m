@@ -27,6 +27,7 @@
 #import "SPScreenState.h"
 #import "SPLogger.h"
 #import "SPDeviceInfoMonitor.h"
+#import <zlib.h>
 
 #if SNOWPLOW_TARGET_IOS
 
@@ -132,6 +133,66 @@
     return [keyValuePairs componentsJoinedByString:@"&"];
 }
 
++ (NSData *)gzipCompressData:(NSData *)data {
+    if (!data.length) {
+        return nil;
+    }
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    // 15 window bits + 16 to get the gzip header and trailer instead of the zlib ones.
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return nil;
+    }
+    NSMutableData *compressed = [NSMutableData dataWithLength:deflateBound(&stream, (uLong)data.length)];
+    stream.next_in = (Bytef *)data.bytes;
+    stream.avail_in = (uInt)data.length;
+    stream.next_out = (Bytef *)compressed.mutableBytes;
+    stream.avail_out = (uInt)compressed.length;
+    int status = deflate(&stream, Z_FINISH);
+    deflateEnd(&stream);
+    if (status != Z_STREAM_END) {
+        SPLogError(@"Unable to compress data: %d", status);
+        return nil;
+    }
+    compressed.length = stream.total_out;
+    return compressed;
+}
+
++ (NSString *)base64UrlEncodedStringWithData:(NSData *)data {
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+    NSUInteger length = data.length;
+    if (!length) {
+        return @"";
+    }
+    // 4 characters every 3 bytes, the last 1 or 2 bytes take 2 or 3 characters as there is no padding.
+    NSUInteger encodedLength = length / 3 * 4 + (length % 3 ? length % 3 + 1 : 0);
+    char *encoded = malloc(encodedLength);
+    if (!encoded) {
+        return @"";
+    }
+    const uint8_t *bytes = data.bytes;
+    NSUInteger i = 0;
+    char *output = encoded;
+    for (; i + 2 < length; i += 3) {
+        uint32_t triple = (uint32_t)bytes[i] << 16 | (uint32_t)bytes[i + 1] << 8 | bytes[i + 2];
+        *output++ = alphabet[triple >> 18 & 0x3F];
+        *output++ = alphabet[triple >> 12 & 0x3F];
+        *output++ = alphabet[triple >> 6 & 0x3F];
+        *output++ = alphabet[triple & 0x3F];
+    }
+    if (length - i == 1) {
+        uint32_t triple = (uint32_t)bytes[i] << 16;
+        *output++ = alphabet[triple >> 18 & 0x3F];
+        *output++ = alphabet[triple >> 12 & 0x3F];
+    } else if (length - i == 2) {
+        uint32_t triple = (uint32_t)bytes[i] << 16 | (uint32_t)bytes[i + 1] << 8;
+        *output++ = alphabet[triple >> 18 & 0x3F];
+        *output++ = alphabet[triple >> 12 & 0x3F];
+        *output++ = alphabet[triple >> 6 & 0x3F];
+    }
+    return [[NSString alloc] initWithBytesNoCopy:encoded length:encodedLength encoding:NSASCIIStringEncoding freeWhenDone:YES];
+}
+
 + (void) checkArgument:(BOOL)argument withMessage:(NSString *)message {
     if (!argument) {
         SPLogDebug(@"Error occurred while checking argument: %@", message);
@@ -34,6 +34,9 @@
 #import "SPEventStore.h"
 #import "SPSQLiteEventStore.h"
 #import "SPMemoryEventStore.h"
+#import "SPSegmentEventStore.h"
+#import "SPHybridEventStore.h"
+#import "SPSharedEventStore.h"
 
 // Emitter
 #import "SPRequest.h"
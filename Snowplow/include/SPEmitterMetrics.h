@@ -0,0 +1 @@
+../Internal/Emitter/SPEmitterMetrics.h
\ No newline at end of file
@@ -0,0 +1 @@
+../Internal/Storage/SPHybridEventStore.h
\ No newline at end of file
@@ -0,0 +1 @@
+../Internal/Storage/SPSegmentEventStore.h
\ No newline at end of file
@@ -0,0 +1 @@
+../Internal/Storage/SPSharedEventStore.h
\ No newline at end of file